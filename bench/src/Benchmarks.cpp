@@ -0,0 +1,248 @@
+#include "Benchmarks.h"
+#include "core/DataManager.h"
+#include "geometry/CubeMesh.h"
+#include "geometry/MeshProcessing.h"
+#include "geometry/ModelLoader.h"
+#include "utils/TaskSystem.h"
+#include <atomic>
+#include <fstream>
+#include <future>
+#include <thread>
+
+namespace {
+
+// UV sphere with about targetVertices vertices; large enough meshes are
+// bandwidth-bound like real scans, which a cube grid is not
+void makeSphere(int targetVertices, vector<glm::vec3> & vertices, vector<unsigned int> & indices) {
+	int rings = std::max(2, (int)std::sqrt(targetVertices / 2.0));
+	int segments = rings * 2;
+	vertices.clear();
+	indices.clear();
+	vertices.reserve((size_t)(rings + 1) * (segments + 1));
+	indices.reserve((size_t)rings * segments * 6);
+
+	for (int r = 0; r <= rings; r++) {
+		float theta = PI * r / rings;
+		for (int s = 0; s <= segments; s++) {
+			float phi = TWO_PI * s / segments;
+			vertices.emplace_back(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+		}
+	}
+	for (int r = 0; r < rings; r++) {
+		for (int s = 0; s < segments; s++) {
+			unsigned int a = r * (segments + 1) + s;
+			unsigned int b = a + segments + 1;
+			indices.insert(indices.end(), { a, b, a + 1, a + 1, b, b + 1 });
+		}
+	}
+}
+
+void writeObj(const string & path, const vector<glm::vec3> & vertices, const vector<unsigned int> & indices) {
+	std::ofstream out(path);
+	for (const auto & v : vertices) {
+		out << "v " << v.x << " " << v.y << " " << v.z << "\n";
+	}
+	for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+		out << "f " << indices[i] + 1 << " " << indices[i + 1] + 1 << " " << indices[i + 2] + 1 << "\n";
+	}
+}
+
+}
+
+//--------------------------------------------------------------
+void Benchmarks::runCubeMesh(MicroBench & bench, bool quick) {
+	if (!bench.isSelected("cube_mesh.generate")) return;
+
+	vector<int> resolutions = { 10, 25, 50, 100, 150, 200 };
+	if (quick) resolutions = { 10, 50, 100 };
+
+	for (int resolution : resolutions) {
+		for (bool optimize : { false, true }) {
+			CubeMeshConfig config;
+			config.gridResolution = resolution;
+			config.optimizeVertexOrder = optimize;
+
+			CubeMesh cube;
+			cube.setup(config);
+			bench.run("cube_mesh.generate", { { "resolution", resolution }, { "optimizeVertexOrder", optimize } },
+				cube.getVertexCount(), "vertices", [&cube]() { cube.generateMesh(); });
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void Benchmarks::runModelLoader(MicroBench & bench, bool quick) {
+	if (!bench.isSelected("model_loader.obj_parse") && !bench.isSelected("model_loader.obj_load_full")) return;
+
+	vector<int> sizes = { 10000, 100000, 1000000 };
+	if (quick) sizes = { 10000, 100000 };
+
+	ofDirectory::createDirectory("microbench", true, true);
+	for (int size : sizes) {
+		vector<glm::vec3> vertices;
+		vector<unsigned int> indices;
+		makeSphere(size, vertices, indices);
+
+		string path = ofToDataPath("microbench/sphere_" + ofToString(size) + ".obj", true);
+		writeObj(path, vertices, indices);
+		double bytes = (double)ofFile(path).getSize();
+		ofJson params = { { "vertices", vertices.size() }, { "triangles", indices.size() / 3 }, { "fileBytes", bytes } };
+
+		// Parsing only: every post-processing stage off
+		ModelLoader parser;
+		ModelLoader::LoadOptions parseOnly;
+		parseOnly.generateNormals = false;
+		parseOnly.centerModel = false;
+		parseOnly.normalizeSize = false;
+		parseOnly.smoothNormals = false;
+		parseOnly.weldVertices = false;
+		parseOnly.optimizeVertexOrder = false;
+		parseOnly.buildLods = false;
+		parser.setLoadOptions(parseOnly);
+		ofVboMesh mesh;
+		bench.run("model_loader.obj_parse", params, bytes, "B", [&]() { parser.loadModel(path, mesh); });
+
+		// The app's default pipeline: weld, normals, vertex order, LODs
+		ModelLoader loader;
+		bench.run("model_loader.obj_load_full", params, bytes, "B", [&]() { loader.loadModel(path, mesh); });
+
+		ofFile::removeFile(path, false);
+	}
+}
+
+//--------------------------------------------------------------
+void Benchmarks::runMeshProcessing(MicroBench & bench, bool quick) {
+	if (!bench.isSelected("mesh_processing.normals") && !bench.isSelected("mesh_processing.bounds")) return;
+
+	vector<int> sizes = { 100000, 1000000, 4000000 };
+	if (quick) sizes = { 100000, 1000000 };
+	int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+
+	for (int size : sizes) {
+		vector<glm::vec3> vertices;
+		vector<unsigned int> indices;
+		makeSphere(size, vertices, indices);
+		vector<glm::vec3> normals;
+
+		for (int workers : { 1, hardwareThreads }) {
+			ofJson params = { { "vertices", vertices.size() }, { "triangles", indices.size() / 3 }, { "workers", workers } };
+			bench.run("mesh_processing.normals", params, vertices.size(), "vertices",
+				[&]() { MeshProcessing::computeVertexNormals(vertices, indices, normals, workers); });
+			bench.run("mesh_processing.bounds", params, vertices.size(), "vertices",
+				[&]() { MeshProcessing::computeBounds(vertices, workers); });
+			if (workers == hardwareThreads) break;
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void Benchmarks::runDataManager(MicroBench & bench, bool quick) {
+	vector<int> threadCounts = { 1, 2, 4, 8, 16 };
+	if (quick) threadCounts = { 1, 4, 16 };
+	DataManager & dataManager = DataManager::getInstance();
+
+	// writeEvery = 0: readers only; otherwise every n-th access is a set
+	for (int writeEvery : { 0, 8 }) {
+		string name = writeEvery == 0 ? "data_manager.get" : "data_manager.get_set";
+		if (!bench.isSelected(name)) continue;
+
+		for (int threadCount : threadCounts) {
+			std::atomic<bool> running { true };
+			vector<uint64_t> counts(threadCount, 0);
+			vector<std::thread> threads;
+
+			uint64_t start = ofGetElapsedTimeMicros();
+			for (int t = 0; t < threadCount; t++) {
+				threads.emplace_back([&, t]() {
+					FractureParams params = dataManager.getFractureParams();
+					uint64_t count = 0;
+					while (running.load(std::memory_order_relaxed)) {
+						if (writeEvery > 0 && count % writeEvery == 0) {
+							params.fractureAmount = (float)(count & 0xff) / 255.0f;
+							dataManager.setFractureParams(params);
+						} else {
+							params = dataManager.getFractureParams();
+						}
+						count++;
+					}
+					counts[t] = count;
+				});
+			}
+			std::this_thread::sleep_for(std::chrono::duration<double>(bench.getOptions().minSeconds));
+			running = false;
+			for (auto & thread : threads) {
+				thread.join();
+			}
+			double seconds = (ofGetElapsedTimeMicros() - start) / 1e6;
+
+			uint64_t total = 0;
+			uint64_t slowest = UINT64_MAX;
+			for (uint64_t count : counts) {
+				total += count;
+				slowest = std::min(slowest, count);
+			}
+
+			ofJson metrics;
+			metrics["seconds"] = seconds;
+			metrics["operations"] = total;
+			metrics["unit"] = "Mops/s";
+			metrics["throughput"] = total / 1e6 / seconds;
+			// Lowest share of a fair split; well below 1 means a thread was starved
+			metrics["fairness"] = (double)slowest * threadCount / std::max<uint64_t>(total, 1);
+			bench.record(name, { { "threads", threadCount }, { "writeEvery", writeEvery } }, metrics);
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void Benchmarks::runTaskSystem(MicroBench & bench, bool quick) {
+	vector<int> chunkCounts = { 1, 2, 4, 8, 16, 64 };
+	if (quick) chunkCounts = { 1, 4, 16 };
+	TaskSystem & tasks = TaskSystem::get();
+
+	// The naive baseline: one std::async thread per chunk, joined in order
+	auto asyncFor = [](size_t count, int chunks, const std::function<void(size_t, size_t, int)> & fn) {
+		size_t chunkSize = (count + chunks - 1) / chunks;
+		vector<std::future<void>> futures;
+		for (int c = 0; c < chunks; c++) {
+			size_t begin = std::min(count, c * chunkSize);
+			futures.push_back(std::async(std::launch::async, fn, begin, std::min(count, begin + chunkSize), c));
+		}
+		for (auto & future : futures) {
+			future.get();
+		}
+	};
+
+	// Compute-bound: scaling with the chunk count
+	vector<float> values(quick ? 1000000 : 4000000);
+	for (size_t i = 0; i < values.size(); i++) {
+		values[i] = (float)i;
+	}
+	vector<double> sums(64);
+	auto work = [&](size_t begin, size_t end, int chunk) {
+		double sum = 0.0;
+		for (size_t i = begin; i < end; i++) {
+			sum += std::sqrt(values[i]) * std::sin(values[i]);
+		}
+		sums[chunk] = sum;
+	};
+	for (int chunks : chunkCounts) {
+		ofJson params = { { "elements", values.size() }, { "chunks", chunks }, { "poolWorkers", tasks.getWorkerCount() } };
+		bench.run("task_system.parallel_for", params, values.size(), "elements", [&]() { tasks.parallelFor(values.size(), chunks, work); });
+		bench.run("std_async.parallel_for", params, values.size(), "elements", [&]() { asyncFor(values.size(), chunks, work); });
+	}
+
+	// Nearly empty chunks: the fixed cost per call, i.e. what small meshes pay
+	auto empty = [](size_t, size_t, int) { };
+	bench.run("task_system.overhead", { { "chunks", 8 } }, 1, "calls", [&]() { tasks.parallelFor(64, 8, empty); });
+	bench.run("std_async.overhead", { { "chunks", 8 } }, 1, "calls", [&]() { asyncFor(64, 8, empty); });
+
+	// A small task graph: 16 independent tasks feeding one join task
+	bench.run("task_system.graph", { { "width", 16 } }, 17, "tasks", [&]() {
+		vector<TaskSystem::Handle> layer;
+		for (int i = 0; i < 16; i++) {
+			layer.push_back(tasks.submit([&work, i]() { work(i * 1000, (i + 1) * 1000, i); }));
+		}
+		tasks.wait(tasks.submit([]() { }, layer));
+	});
+}
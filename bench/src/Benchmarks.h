@@ -0,0 +1,13 @@
+#pragma once
+#include "MicroBench.h"
+
+// One suite per core subsystem; `quick` trims the largest sizes
+namespace Benchmarks {
+
+void runCubeMesh(MicroBench & bench, bool quick);
+void runModelLoader(MicroBench & bench, bool quick);
+void runMeshProcessing(MicroBench & bench, bool quick);
+void runDataManager(MicroBench & bench, bool quick);
+void runTaskSystem(MicroBench & bench, bool quick);
+
+}
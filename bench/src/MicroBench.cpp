@@ -0,0 +1,77 @@
+#include "MicroBench.h"
+
+//--------------------------------------------------------------
+MicroBench::MicroBench(const Options & options)
+	: options(options) {
+}
+
+//--------------------------------------------------------------
+bool MicroBench::isSelected(const string & name) const {
+	return options.filter.empty() || ofIsStringInString(name, options.filter);
+}
+
+//--------------------------------------------------------------
+void MicroBench::run(const string & name, const ofJson & params, double work, const string & workUnit, std::function<void()> fn) {
+	if (!isSelected(name)) return;
+
+	// One untimed run to fault in memory and warm caches
+	fn();
+
+	vector<double> times;
+	uint64_t start = ofGetElapsedTimeMicros();
+	while ((int)times.size() < options.minIterations || (ofGetElapsedTimeMicros() - start) < options.minSeconds * 1e6) {
+		uint64_t iterationStart = ofGetElapsedTimeMicros();
+		fn();
+		times.push_back((ofGetElapsedTimeMicros() - iterationStart) / 1000.0);
+	}
+
+	std::sort(times.begin(), times.end());
+	double median = times[times.size() / 2];
+	double sum = 0.0;
+	for (double t : times) {
+		sum += t;
+	}
+
+	ofJson metrics;
+	metrics["iterations"] = times.size();
+	metrics["medianMs"] = median;
+	metrics["minMs"] = times.front();
+	metrics["meanMs"] = sum / times.size();
+	metrics["maxMs"] = times.back();
+	metrics["work"] = work;
+	metrics["unit"] = "M" + workUnit + "/s";
+	metrics["throughput"] = median > 0.0 ? work / 1e6 / (median / 1000.0) : 0.0;
+	record(name, params, metrics);
+}
+
+//--------------------------------------------------------------
+void MicroBench::record(const string & name, const ofJson & params, const ofJson & metrics) {
+	ofJson entry;
+	entry["name"] = name;
+	entry["params"] = params;
+	entry["metrics"] = metrics;
+	results.push_back(entry);
+
+	string line = name + " " + params.dump();
+	if (metrics.count("throughput")) {
+		line += ": " + ofToString(metrics["throughput"].get<double>(), 2) + " " + metrics["unit"].get<string>();
+	}
+	if (metrics.count("medianMs")) {
+		line += " (" + ofToString(metrics["medianMs"].get<double>(), 3) + " ms)";
+	}
+	ofLogNotice("MicroBench") << line;
+}
+
+//--------------------------------------------------------------
+ofJson MicroBench::getResults() const {
+	ofJson document;
+	document["hardwareThreads"] = std::thread::hardware_concurrency();
+	document["minSeconds"] = options.minSeconds;
+	document["results"] = results;
+	return document;
+}
+
+//--------------------------------------------------------------
+bool MicroBench::save(const string & path) const {
+	return ofSavePrettyJson(path, getResults());
+}
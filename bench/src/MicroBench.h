@@ -0,0 +1,36 @@
+#pragma once
+#include "ofMain.h"
+#include <functional>
+
+// Minimal benchmark harness. run() repeats a function until both a minimum
+// time and a minimum iteration count are reached and records the median,
+// min, mean and max per-iteration time plus a throughput (work per
+// iteration / median time). All results go into one JSON document so two
+// runs can be diffed entry by entry.
+class MicroBench {
+public:
+	struct Options {
+		double minSeconds = 0.5;
+		int minIterations = 5;
+		string filter; // only run benchmarks whose name contains this
+	};
+
+	explicit MicroBench(const Options & options);
+
+	bool isSelected(const string & name) const;
+
+	// work / workUnit describe one iteration, e.g. 1.5e6 "vertices"; the
+	// throughput is reported per second in millions of workUnit
+	void run(const string & name, const ofJson & params, double work, const string & workUnit, std::function<void()> fn);
+
+	// For benchmarks that measure themselves (e.g. multi-threaded throughput)
+	void record(const string & name, const ofJson & params, const ofJson & metrics);
+
+	const Options & getOptions() const { return options; }
+	ofJson getResults() const;
+	bool save(const string & path) const;
+
+private:
+	Options options;
+	ofJson results = ofJson::array();
+};
@@ -0,0 +1,46 @@
+#include "Benchmarks.h"
+#include "ofMain.h"
+
+// Microbenchmarks for the app's CPU-side core (mesh generation, model
+// loading, mesh processing, DataManager, TaskSystem). No window or GL context is
+// created. Results are written as JSON (default data/microbench.json) so
+// runs on the same machine can be diffed.
+//
+//   microbench [--quick] [--filter=cube_mesh] [--seconds=0.5] [--out=path]
+int main(int argc, char * argv[]) {
+	MicroBench::Options options;
+	bool quick = false;
+	string outputPath = ofToDataPath("microbench.json", true);
+
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		string value = arg.substr(arg.find('=') + 1);
+		if (arg == "--quick") {
+			quick = true;
+		} else if (ofIsStringInString(arg, "--filter=")) {
+			options.filter = value;
+		} else if (ofIsStringInString(arg, "--seconds=")) {
+			options.minSeconds = std::max(0.01, ofToDouble(value));
+		} else if (ofIsStringInString(arg, "--out=")) {
+			outputPath = value;
+		}
+	}
+
+	// Only the benchmark's own progress lines
+	ofSetLogLevel(OF_LOG_WARNING);
+	ofSetLogLevel("MicroBench", OF_LOG_NOTICE);
+
+	MicroBench bench(options);
+	Benchmarks::runCubeMesh(bench, quick);
+	Benchmarks::runModelLoader(bench, quick);
+	Benchmarks::runMeshProcessing(bench, quick);
+	Benchmarks::runDataManager(bench, quick);
+	Benchmarks::runTaskSystem(bench, quick);
+
+	if (!bench.save(outputPath)) {
+		ofLogError("MicroBench") << "Could not write " << outputPath;
+		return 1;
+	}
+	ofLogNotice("MicroBench") << "Results written to " << outputPath;
+	return 0;
+}
@@ -0,0 +1,40 @@
+// Encode/decode helpers for the Screen1/Screen2 position targets.
+// Values must match PositionEncoding in src/shared/CommonStructs.h.
+
+#define POSITION_WORLD_RGBA32F 0
+#define POSITION_VIEW_RGBA16F 1
+#define POSITION_DEPTH_ONLY 2
+
+// Octahedral mapping of a unit vector to [0, 1]^2, fits an RG16 target
+vec2 encodeOctahedral(vec3 n) {
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 e = n.xy;
+    if (n.z < 0.0) {
+        e = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return e * 0.5 + 0.5;
+}
+
+vec3 decodeOctahedral(vec2 e) {
+    e = e * 2.0 - 1.0;
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = clamp(-n.z, 0.0, 1.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+// Color encodings flag covered pixels in alpha; depth-only relies on the
+// cleared depth of 1.0
+bool isPositionCovered(int encoding, vec4 texel, float depth) {
+    if (encoding == POSITION_DEPTH_ONLY) return depth < 1.0;
+    return texel.a > 0.5;
+}
+
+vec3 decodeWorldPosition(int encoding, vec4 texel, float depth, vec2 uv, mat4 inverseView, mat4 inverseViewProjection) {
+    if (encoding == POSITION_WORLD_RGBA32F) return texel.xyz;
+    if (encoding == POSITION_VIEW_RGBA16F) return (inverseView * vec4(texel.xyz, 1.0)).xyz;
+
+    vec4 world = inverseViewProjection * vec4(vec3(uv, depth) * 2.0 - 1.0, 1.0);
+    return world.xyz / world.w;
+}
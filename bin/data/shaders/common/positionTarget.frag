@@ -0,0 +1,28 @@
+#version 330
+
+// Writes the Screen1/Screen2 position target in the requested encoding.
+// Attachment 0 is the position, attachment 1 the octahedral normal
+// (POSITION_VIEW_RGBA16F only); POSITION_DEPTH_ONLY has no color targets.
+
+#pragma include "positionEncoding.glsl"
+
+uniform int positionEncoding;
+
+in vec3 worldPosition;
+in vec3 viewPosition;
+in vec3 viewNormal;
+
+layout(location = 0) out vec4 outputColor;
+layout(location = 1) out vec2 outputNormal;
+
+void main() {
+    // alpha marks covered pixels for the screen-space fusion
+    if (positionEncoding == POSITION_VIEW_RGBA16F) {
+        outputColor = vec4(viewPosition, 1.0);
+    } else {
+        outputColor = vec4(worldPosition, 1.0);
+    }
+
+    vec3 n = length(viewNormal) > 1e-8 ? normalize(viewNormal) : vec3(0.0, 0.0, 1.0);
+    outputNormal = encodeOctahedral(n);
+}
@@ -13,6 +13,7 @@ uniform float dissipationScale;     // 消散噪声缩放
 uniform float dissipationSpeed;     // 消散动画速度
 uniform float cloudThreshold;       // 云状效果阈值
 uniform float edgeSoftness;         // 边缘柔和度
+uniform int effectQuality;           // 2 = full, 1 = reduced, 0 = cheapest (set by the frame governor)
 
 // 从vertex shader传来的变量
 in vec3 worldPos;
@@ -70,13 +71,20 @@ float calculateDissipation(vec3 pos, float t) {
     // 多层噪声创造复杂的云状图案
     
     // 主要消散图案 - 缓慢移动的大块云状
-    float mainPattern = fractalNoise(pos * dissipationScale + vec3(t * dissipationSpeed * 0.1), 4);
-    
-    // 细节消散 - 快速变化的细小消散点
-    float detailPattern = fractalNoise(pos * dissipationScale * 3.0 + vec3(t * dissipationSpeed * 0.3), 3);
-    
-    // 边缘扰动 - 让消散边缘更自然
-    float edgeNoise = noise3d(pos * dissipationScale * 6.0 + vec3(t * dissipationSpeed * 0.5));
+    float mainPattern = fractalNoise(pos * dissipationScale + vec3(t * dissipationSpeed * 0.1), 2 + effectQuality);
+    
+    // Lower quality drops octaves and the edge layer; the cheapest variant
+    // keeps only the main pattern
+    float detailPattern = mainPattern;
+    float edgeNoise = mainPattern;
+    if (effectQuality > 0) {
+        // 细节消散 - 快速变化的细小消散点
+        detailPattern = fractalNoise(pos * dissipationScale * 3.0 + vec3(t * dissipationSpeed * 0.3), 1 + effectQuality);
+    }
+    if (effectQuality > 1) {
+        // 边缘扰动 - 让消散边缘更自然
+        edgeNoise = noise3d(pos * dissipationScale * 6.0 + vec3(t * dissipationSpeed * 0.5));
+    }
     
     // 组合不同层次的图案
     float combined = mainPattern * 0.6 + detailPattern * 0.3 + edgeNoise * 0.1;
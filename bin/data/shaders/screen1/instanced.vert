@@ -0,0 +1,46 @@
+#version 150
+
+// Gallery mode: one instanced draw of the whole model field. Each instance
+// reads its model matrix and parameters from a texture buffer written by
+// InstanceField (5 RGBA32F texels per instance), pairs with model/basic.frag.
+
+uniform samplerBuffer instanceData;
+uniform mat4 viewProjectionMatrix;
+uniform vec3 lightPosition;
+uniform vec3 cameraPosition;
+
+in vec4 position;
+in vec3 normal;
+in vec4 color;
+in vec2 texcoord;
+
+out vec3 worldPos;
+out vec3 worldNormal;
+out vec3 vertexColor;
+out vec3 lightDir;
+out vec3 viewDir;
+out vec2 texCoord;
+
+void main() {
+    int base = gl_InstanceID * 5;
+    mat4 instanceMatrix = mat4(
+        texelFetch(instanceData, base),
+        texelFetch(instanceData, base + 1),
+        texelFetch(instanceData, base + 2),
+        texelFetch(instanceData, base + 3));
+    vec4 params = texelFetch(instanceData, base + 4); // tint.rgb, phase
+
+    vec4 world = instanceMatrix * position;
+    worldPos = world.xyz;
+    // Instance scale is uniform, so the upper 3x3 is fine for normals
+    worldNormal = normalize(mat3(instanceMatrix) * normal);
+
+    vec3 baseColor = length(color.rgb) > 0.1 ? color.rgb : vec3(0.8, 0.8, 0.9);
+    vertexColor = baseColor * params.rgb;
+    texCoord = texcoord;
+
+    lightDir = normalize(lightPosition - worldPos);
+    viewDir = normalize(cameraPosition - worldPos);
+
+    gl_Position = viewProjectionMatrix * world;
+}
@@ -1,32 +1,19 @@
-//#version 150
+#version 330
 
-//uniform mat4 modelMatrix;
-//uniform mat4 modelViewMatrix; 
-//uniform mat4 modelViewProjectionMatrix;
-
-//in vec4 position;
-//in vec3 normal;
-
-//out vec3 worldPosition;
-//out vec3 worldNormal;
-
-//void main() {
-    //vec4 worldPos4 = modelMatrix * position;
-    //worldPosition = worldPos4.xyz;
-    //worldNormal = normalize((modelMatrix * vec4(normal, 0.0)).xyz);
-    //gl_Position = modelViewProjectionMatrix * position;
-
-//    worldPosition = position.xyz; // 直接使用模型坐标
-//    gl_Position = modelViewProjectionMatrix * position;
-//}
+uniform mat4 modelMatrix;
+uniform mat4 modelViewMatrix;
+uniform mat4 modelViewProjectionMatrix;
 
-#version 120  // 改回120版本，使用attribute
+in vec4 position;
+in vec3 normal;
 
-uniform mat4 modelViewProjectionMatrix;
-attribute vec4 position;  // openFrameworks标准属性
-varying vec3 worldPosition;
+out vec3 worldPosition;
+out vec3 viewPosition;
+out vec3 viewNormal;
 
 void main() {
-    worldPosition = position.xyz;
+    worldPosition = (modelMatrix * position).xyz;
+    viewPosition = (modelViewMatrix * position).xyz;
+    viewNormal = transpose(inverse(mat3(modelViewMatrix))) * normal;
     gl_Position = modelViewProjectionMatrix * position;
-}
\ No newline at end of file
+}
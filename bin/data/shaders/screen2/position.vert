@@ -1,18 +1,19 @@
-#version 150
+#version 330
 
 uniform mat4 modelMatrix;
-uniform mat4 modelViewMatrix; 
+uniform mat4 modelViewMatrix;
 uniform mat4 modelViewProjectionMatrix;
 
 in vec4 position;
 in vec3 normal;
 
 out vec3 worldPosition;
-out vec3 worldNormal;
+out vec3 viewPosition;
+out vec3 viewNormal;
 
 void main() {
-    vec4 worldPos4 = modelMatrix * position;
-    worldPosition = worldPos4.xyz;
-    worldNormal = normalize((modelMatrix * vec4(normal, 0.0)).xyz);
+    worldPosition = (modelMatrix * position).xyz;
+    viewPosition = (modelViewMatrix * position).xyz;
+    viewNormal = transpose(inverse(mat3(modelViewMatrix))) * normal;
     gl_Position = modelViewProjectionMatrix * position;
-}
\ No newline at end of file
+}
@@ -0,0 +1,49 @@
+#version 150
+
+// Joint bilateral upsample of the reduced-resolution screen-space fusion.
+// The four nearest low-res texels are weighted bilinearly and by how close
+// their depth is to the full-resolution fused depth of this pixel, so
+// silhouettes stay sharp instead of bleeding into the background.
+
+#pragma include "screenSpaceCommon.glsl"
+
+uniform sampler2D lowResTex; // rgb = color, a = fused depth (nearest filtered)
+uniform vec2 lowResolution;
+uniform float depthSharpness;
+
+in vec2 vTexCoord;
+
+out vec4 outputColor;
+
+void main() {
+    float guide = fusedDepth(sampleScreen1(vTexCoord), sampleScreen2(vTexCoord));
+
+    vec2 texel = vTexCoord * lowResolution - 0.5;
+    vec2 base = floor(texel);
+    vec2 f = texel - base;
+
+    vec3 color = vec3(0.0);
+    float weightSum = 0.0;
+    vec3 closestColor = vec3(0.0);
+    float closestDiff = 1e20;
+
+    for (int j = 0; j < 2; j++) {
+        for (int i = 0; i < 2; i++) {
+            vec2 uv = (base + vec2(i, j) + 0.5) / lowResolution;
+            vec4 s = texture(lowResTex, uv);
+            float diff = abs(s.a - guide);
+            float bilinear = (i == 0 ? 1.0 - f.x : f.x) * (j == 0 ? 1.0 - f.y : f.y);
+            float w = bilinear * exp(-diff * depthSharpness);
+
+            color += s.rgb * w;
+            weightSum += w;
+            if (diff < closestDiff) {
+                closestDiff = diff;
+                closestColor = s.rgb;
+            }
+        }
+    }
+
+    // All neighbours on another surface: take the closest in depth
+    outputColor = vec4(weightSum > 1e-5 ? color / weightSum : closestColor, 1.0);
+}
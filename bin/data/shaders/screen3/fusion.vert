@@ -6,6 +6,19 @@ uniform mat4 modelViewMatrix;
 // TBO containing Screen1 vertex positions
 uniform samplerBuffer screen1PositionsTBO;
 
+// Precomputed target on the Screen1 surface for every cube vertex
+uniform samplerBuffer correspondencePositionsTBO;
+uniform samplerBuffer correspondenceNormalsTBO;
+uniform int useCorrespondence;
+
+// Signed distance volume of the Screen1 model (negative inside); voxel
+// centers follow the GL texel convention, so p maps to (p - origin) / size
+uniform sampler3D modelSDF;
+uniform int fusionMode; // 0 = vertex targets, 1 = project onto the SDF surface
+uniform vec3 sdfOrigin;
+uniform float sdfSize;
+uniform int sdfSteps;
+
 // Fusion parameters
 uniform float mixRatio;
 uniform float time;
@@ -208,6 +221,39 @@ vec3 calculateFlowField(vec3 pos, float t) {
     return flow;
 }
 
+// Outside the volume the distance to the box is added, which keeps the
+// field pointing back towards the model
+float sampleSDF(vec3 p) {
+    vec3 clamped = clamp(p, sdfOrigin, sdfOrigin + vec3(sdfSize));
+    float d = texture(modelSDF, (clamped - sdfOrigin) / sdfSize).r;
+    return d + length(p - clamped);
+}
+
+vec3 sdfGradient(vec3 p) {
+    vec2 k = vec2(sdfSize / float(textureSize(modelSDF, 0).x), 0.0);
+    return vec3(
+        sampleSDF(p + k.xyy) - sampleSDF(p - k.xyy),
+        sampleSDF(p + k.yxy) - sampleSDF(p - k.yxy),
+        sampleSDF(p + k.yyx) - sampleSDF(p - k.yyx)
+    );
+}
+
+// Steps p along the gradient by its distance until it sits on the zero
+// level set; outNormal is the surface normal there
+vec3 projectOntoSDF(vec3 p, out vec3 outNormal) {
+    outNormal = normalize(p + vec3(0.0, 1e-4, 0.0));
+    for (int i = 0; i < sdfSteps; i++) {
+        vec3 g = sdfGradient(p);
+        float len = length(g);
+        if (len < 1e-6) break;
+        outNormal = g / len;
+        float d = sampleSDF(p);
+        p -= d * outNormal;
+        if (abs(d) < sdfSize * 1e-4) break;
+    }
+    return p;
+}
+
 void main() {
     vec3 originalPos = position.xyz;
     vec3 newPos = originalPos;
@@ -262,13 +308,25 @@ void main() {
     
     vec3 screen2Pos = newPos; // This is now the properly deformed Screen2 position
     
-    // Sample Screen1 position from TBO
+    // Sample Screen1 position: the cube vertex projected onto the model's
+    // SDF, the correspondence map, or the raw vertex TBO wrapped by vertex ID
     vec3 screen1Pos = vec3(0.0);
-    int tboSize = textureSize(screen1PositionsTBO);
-    
-    if (tboSize > 0) {
-        int screen1Index = gl_VertexID % tboSize;
-        screen1Pos = texelFetch(screen1PositionsTBO, screen1Index).xyz;
+    vec3 fusedNormal = normal;
+    
+    if (fusionMode == 1) {
+        vec3 screen1Normal;
+        screen1Pos = projectOntoSDF(originalPos, screen1Normal);
+        fusedNormal = normalize(mix(normal, screen1Normal, mixRatio));
+    } else if (useCorrespondence == 1) {
+        screen1Pos = texelFetch(correspondencePositionsTBO, gl_VertexID).xyz;
+        vec3 screen1Normal = texelFetch(correspondenceNormalsTBO, gl_VertexID).xyz;
+        fusedNormal = normalize(mix(normal, screen1Normal, mixRatio));
+    } else {
+        int tboSize = textureSize(screen1PositionsTBO);
+        if (tboSize > 0) {
+            int screen1Index = gl_VertexID % tboSize;
+            screen1Pos = texelFetch(screen1PositionsTBO, screen1Index).xyz;
+        }
     }
     
     // Spatial fusion
@@ -276,7 +334,7 @@ void main() {
     
     vec4 worldPos = modelViewMatrix * vec4(fusedPosition, 1.0);
     worldPosition = worldPos.xyz;
-    worldNormal = normalize((modelViewMatrix * vec4(normal, 0.0)).xyz);
+    worldNormal = normalize((modelViewMatrix * vec4(fusedNormal, 0.0)).xyz);
     
     debugColor = vec4(1.0 - mixRatio, mixRatio, 0.5, 1.0);
     
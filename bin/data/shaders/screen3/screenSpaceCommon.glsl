@@ -0,0 +1,59 @@
+// Inputs shared by screenSpaceMix.frag and depthUpsample.frag: both screens'
+// position targets and the fused depth used as the upsampling guide.
+
+#pragma include "../common/positionEncoding.glsl"
+
+uniform sampler2D screen1PositionTex;
+uniform sampler2D screen1NormalTex;
+uniform sampler2D screen1DepthTex;
+uniform int screen1Encoding;
+uniform mat4 screen1InverseView;
+uniform mat4 screen1InverseViewProjection;
+
+uniform sampler2D screen2PositionTex;
+uniform sampler2D screen2NormalTex;
+uniform sampler2D screen2DepthTex;
+uniform int screen2Encoding;
+uniform mat4 screen2InverseView;
+uniform mat4 screen2InverseViewProjection;
+
+uniform float mixRatio;
+uniform int enableModel;
+uniform int enableGeometry;
+
+struct ScreenSample {
+    bool valid;
+    vec3 position; // world space
+    float depth;
+    bool hasNormal;
+    vec3 normal; // world space
+};
+
+ScreenSample sampleScreen(sampler2D positionTex, sampler2D normalTex, sampler2D depthTex,
+    int encoding, mat4 inverseView, mat4 inverseViewProjection, bool enabled, vec2 uv) {
+    ScreenSample s;
+    s.depth = texture(depthTex, uv).r;
+    vec4 texel = encoding == POSITION_DEPTH_ONLY ? vec4(0.0) : texture(positionTex, uv);
+    s.valid = enabled && isPositionCovered(encoding, texel, s.depth);
+    s.position = s.valid ? decodeWorldPosition(encoding, texel, s.depth, uv, inverseView, inverseViewProjection) : vec3(0.0);
+    s.hasNormal = s.valid && encoding == POSITION_VIEW_RGBA16F;
+    s.normal = s.hasNormal ? normalize(mat3(inverseView) * decodeOctahedral(texture(normalTex, uv).rg)) : vec3(0.0);
+    return s;
+}
+
+ScreenSample sampleScreen1(vec2 uv) {
+    return sampleScreen(screen1PositionTex, screen1NormalTex, screen1DepthTex,
+        screen1Encoding, screen1InverseView, screen1InverseViewProjection, enableModel == 1, uv);
+}
+
+ScreenSample sampleScreen2(vec2 uv) {
+    return sampleScreen(screen2PositionTex, screen2NormalTex, screen2DepthTex,
+        screen2Encoding, screen2InverseView, screen2InverseViewProjection, enableGeometry == 1, uv);
+}
+
+float fusedDepth(ScreenSample s1, ScreenSample s2) {
+    if (s1.valid && s2.valid) return mix(s2.depth, s1.depth, mixRatio);
+    if (s1.valid) return s1.depth;
+    if (s2.valid) return s2.depth;
+    return 1.0;
+}
@@ -1,13 +1,7 @@
 #version 150
 
-uniform sampler2D screen1PositionTex;
-uniform sampler2D screen1DepthTex;
-uniform sampler2D screen2PositionTex;
-uniform sampler2D screen2DepthTex;
-
-uniform float mixRatio;
-uniform int enableModel;
-uniform int enableGeometry;
+#pragma include "screenSpaceCommon.glsl"
+
 uniform float modelInfluence;
 uniform float geometryInfluence;
 
@@ -26,66 +20,76 @@ uniform float shininess;
 uniform int showScreen1Debug;
 uniform int showScreen2Debug;
 
+in vec2 vTexCoord;
+
+// rgb = lit color, a = fused depth (guide for depthUpsample.frag)
 out vec4 outputColor;
 
 void main() {
-    vec2 uv = gl_FragCoord.xy / resolution;
-    
+    // Rendered into a reduced-resolution target; texcoords stay normalized
+    vec2 uv = vTexCoord;
+
     // 采样两个屏幕的位置数据
-    vec4 pos1 = texture(screen1PositionTex, uv);
-    vec4 pos2 = texture(screen2PositionTex, uv);
-    
-    // 检查有效性 (alpha > 0.5 表示有效像素)
-    bool valid1 = (pos1.a > 0.5);
-    bool valid2 = (pos2.a > 0.5);
-    
+    ScreenSample s1 = sampleScreen1(uv);
+    ScreenSample s2 = sampleScreen2(uv);
+    float depth = fusedDepth(s1, s2);
+
     // 调试模式
     if (showScreen1Debug == 1) {
-        outputColor = valid1 ? pos1 : vec4(0.2, 0.2, 0.2, 1.0);
+        outputColor = vec4(s1.valid ? s1.position : vec3(0.2), depth);
         return;
     }
     if (showScreen2Debug == 1) {
-        outputColor = valid2 ? pos2 : vec4(0.2, 0.2, 0.2, 1.0);
+        outputColor = vec4(s2.valid ? s2.position : vec3(0.2), depth);
         return;
     }
-    
+
     vec3 finalWorldPos;
+    vec3 normal = vec3(0.0);
     bool hasValidPos = false;
-    
-    if (valid1 && valid2 && enableModel == 1 && enableGeometry == 1) {
+
+    if (s1.valid && s2.valid) {
         // 两者都有效：根据mixRatio混合
-        finalWorldPos = mix(pos2.xyz, pos1.xyz, mixRatio);
+        finalWorldPos = mix(s2.position, s1.position, mixRatio);
+        if (s1.hasNormal && s2.hasNormal) normal = mix(s2.normal, s1.normal, mixRatio);
         hasValidPos = true;
-    } else if (valid1 && enableModel == 1) {
+    } else if (s1.valid) {
         // 只有Screen1有效
-        finalWorldPos = pos1.xyz;
+        finalWorldPos = s1.position;
+        normal = s1.normal;
         hasValidPos = true;
-    } else if (valid2 && enableGeometry == 1) {
-        // 只有Screen2有效  
-        finalWorldPos = pos2.xyz;
+    } else if (s2.valid) {
+        // 只有Screen2有效
+        finalWorldPos = s2.position;
+        normal = s2.normal;
         hasValidPos = true;
     }
-    
+
     if (!hasValidPos) {
         // 背景色
-        outputColor = vec4(0.1, 0.1, 0.1, 1.0);
+        outputColor = vec4(0.1, 0.1, 0.1, depth);
         return;
     }
-    
+
     // 简单的光照计算
     vec3 baseColor = vec3(0.8, 0.8, 0.9);
     vec3 lightDir = normalize(lightPosition - finalWorldPos);
     vec3 viewDir = normalize(cameraPosition - finalWorldPos);
-    
-    // 假设法向量朝上
-    vec3 normal = vec3(0.0, 1.0, 0.0);
-    
+
+    // Stored normals when the encoding has them, otherwise reconstructed
+    // from the screen-space derivatives of the fused position
+    if (length(normal) < 1e-4) {
+        normal = cross(dFdx(finalWorldPos), dFdy(finalWorldPos));
+    }
+    normal = length(normal) > 1e-8 ? normalize(normal) : vec3(0.0, 1.0, 0.0);
+    if (dot(normal, viewDir) < 0.0) normal = -normal;
+
     vec3 ambient = ambientColor * baseColor;
     float NdotL = max(dot(normal, lightDir), 0.0);
     vec3 diffuse = lightColor * baseColor * NdotL * lightIntensity;
-    
+
     vec3 finalColor = ambient + diffuse;
     finalColor = pow(finalColor, vec3(1.0/2.2)); // gamma校正
-    
-    outputColor = vec4(finalColor, 1.0);
+
+    outputColor = vec4(finalColor, depth);
 }
\ No newline at end of file
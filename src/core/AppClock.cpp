@@ -0,0 +1,33 @@
+#include "AppClock.h"
+#include "ofMain.h"
+
+namespace {
+double fixedStep = 0.0;
+uint64_t fixedFrames = 0;
+}
+
+//--------------------------------------------------------------
+void AppClock::setFixedStep(double seconds) {
+	fixedStep = std::max(0.0, seconds);
+	fixedFrames = 0;
+}
+
+//--------------------------------------------------------------
+bool AppClock::isFixedStep() {
+	return fixedStep > 0.0;
+}
+
+//--------------------------------------------------------------
+void AppClock::advance() {
+	fixedFrames++;
+}
+
+//--------------------------------------------------------------
+float AppClock::getElapsedTimef() {
+	return isFixedStep() ? (float)(fixedFrames * fixedStep) : ofGetElapsedTimef();
+}
+
+//--------------------------------------------------------------
+float AppClock::getLastFrameTime() {
+	return isFixedStep() ? (float)fixedStep : (float)ofGetLastFrameTime();
+}
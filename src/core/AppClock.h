@@ -0,0 +1,20 @@
+#pragma once
+
+// Animation time for the screens. Normally this is the openFrameworks clock;
+// with a fixed step (benchmark runs) it advances by exactly that step per
+// main loop iteration, so every run animates through the same states no
+// matter how long the frames take. Timers that measure cost keep using
+// ofGetElapsedTimeMicros, which is never affected.
+namespace AppClock {
+
+// seconds <= 0 returns to the real clock
+void setFixedStep(double seconds);
+bool isFixedStep();
+
+// Call once per main loop iteration (after every window drew)
+void advance();
+
+float getElapsedTimef();
+float getLastFrameTime();
+
+}
@@ -0,0 +1,246 @@
+#include "BenchRunner.h"
+#include "core/AppClock.h"
+#include <iostream>
+
+//--------------------------------------------------------------
+bool BenchRunner::setup(const Settings & newSettings) {
+	string scriptPath = newSettings.scriptPath.empty() ? ofToDataPath("bench/default.json", true) : newSettings.scriptPath;
+	if (!loadScript(scriptPath)) {
+		if (!newSettings.scriptPath.empty()) return false;
+		ofLogWarning("BenchRunner") << "No script at " << scriptPath << ", running without timeline";
+	}
+
+	// Command line values win over the script
+	if (newSettings.frames > 0) settings.frames = newSettings.frames;
+	if (newSettings.warmup >= 0) settings.warmup = newSettings.warmup;
+	if (newSettings.step > 0.0) settings.step = newSettings.step;
+	if (settings.frames <= 0) settings.frames = 600;
+	if (settings.warmup < 0) settings.warmup = 60;
+	if (settings.step <= 0.0) settings.step = 1.0 / 60.0;
+	settings.scriptPath = scriptPath;
+	settings.outputPath = newSettings.outputPath;
+
+	for (size_t i = 0; i < screens.size(); i++) {
+		screens[i].profiler->setSampleCallback([this, i](const string & pass, float cpuMs, float gpuMs) {
+			if (frame < settings.warmup) return;
+			PassSamples & samples = screens[i].passes[pass];
+			samples.cpu.push_back(cpuMs);
+			if (gpuMs >= 0.0f) samples.gpu.push_back(gpuMs);
+		});
+	}
+
+	AppClock::setFixedStep(settings.step);
+	start();
+	ofAddListener(ofGetMainLoop()->loopEvent, this, &BenchRunner::onLoop);
+
+	ofLogNotice("BenchRunner") << settings.warmup << " warmup + " << settings.frames << " frames at "
+							   << settings.step * 1000.0 << " ms steps, " << events.size() << " scripted events";
+	return true;
+}
+
+//--------------------------------------------------------------
+bool BenchRunner::loadScript(const string & path) {
+	if (!ofFile::doesFileExist(path, false)) {
+		ofLogError("BenchRunner") << "Script not found: " << path;
+		return false;
+	}
+
+	ofJson script = ofLoadJson(path);
+	if (!script.is_object()) {
+		ofLogError("BenchRunner") << "Script is not a JSON object: " << path;
+		return false;
+	}
+
+	settings.frames = script.value("frames", 0);
+	settings.warmup = script.value("warmup", -1);
+	settings.step = script.value("step", 0.0);
+
+	events.clear();
+	for (const auto & entry : script.value("events", ofJson::array())) {
+		Event event;
+		event.frame = entry.value("frame", 0);
+		event.until = entry.value("until", -1);
+		event.screen = entry.value("screen", "");
+		event.param = entry.value("param", "");
+		event.key = entry.value("key", "");
+		event.from = entry.value("from", ofJson());
+		event.value = entry.value("value", ofJson());
+
+		if (event.screen.empty() || (event.param.empty() == event.key.empty())) {
+			ofLogWarning("BenchRunner") << "Skipping event without a screen and exactly one of param / key: " << entry.dump();
+			continue;
+		}
+		if (event.until >= 0 && (event.until <= event.frame || !event.from.is_number() || !event.value.is_number())) {
+			ofLogWarning("BenchRunner") << "Skipping ramp that needs numeric from / value and until > frame: " << entry.dump();
+			continue;
+		}
+		events.push_back(event);
+	}
+	return true;
+}
+
+//--------------------------------------------------------------
+void BenchRunner::start() {
+	// Uncapped and without vsync, so frame times are the cost of the frame
+	for (auto & screen : screens) {
+		screen.window->makeCurrent();
+		screen.window->setVerticalSync(false);
+		screen.window->events().setFrameRate(0);
+	}
+	renderer = string((const char *)glGetString(GL_RENDERER)) + " / " + (const char *)glGetString(GL_VERSION);
+
+	// The governor reacts to measured time, which would make the work differ between runs
+	for (auto & screen : screens) {
+		setParameter(screen, "Adaptive Quality", false);
+	}
+	applyEvents(0);
+	lastLoopMicros = ofGetElapsedTimeMicros();
+}
+
+//--------------------------------------------------------------
+void BenchRunner::onLoop() {
+	// Called once every window has updated and drawn frame `frame`
+	uint64_t now = ofGetElapsedTimeMicros();
+	if (frame >= settings.warmup) {
+		frameMs.push_back((now - lastLoopMicros) / 1000.0f);
+	}
+	lastLoopMicros = now;
+
+	frame++;
+	AppClock::advance();
+	if (frame >= settings.warmup + settings.frames) {
+		finish();
+		return;
+	}
+	applyEvents(frame);
+}
+
+//--------------------------------------------------------------
+void BenchRunner::applyEvents(int currentFrame) {
+	for (const auto & event : events) {
+		if (event.until < 0 ? currentFrame != event.frame : (currentFrame < event.frame || currentFrame > event.until)) {
+			continue;
+		}
+
+		Screen * screen = findScreen(event.screen);
+		if (!screen) {
+			ofLogWarning("BenchRunner") << "Unknown screen '" << event.screen << "'";
+			continue;
+		}
+
+		if (!event.key.empty()) {
+			screen->window->makeCurrent();
+			screen->app->keyPressed(event.key[0]);
+		} else if (event.until >= 0) {
+			double t = double(currentFrame - event.frame) / (event.until - event.frame);
+			double from = event.from.get<double>();
+			setParameter(*screen, event.param, from + (event.value.get<double>() - from) * t);
+		} else {
+			setParameter(*screen, event.param, event.value);
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void BenchRunner::setParameter(Screen & screen, const string & name, const ofJson & value) {
+	ofAbstractParameter * parameter = findParameter(screen.getParameters(), name);
+	if (!parameter) {
+		if (name != "Adaptive Quality") {
+			ofLogWarning("BenchRunner") << screen.name << " has no parameter '" << name << "'";
+		}
+		return;
+	}
+
+	string text;
+	if (value.is_boolean()) {
+		text = value.get<bool>() ? "1" : "0";
+	} else if (value.is_number() && parameter->type() == typeid(ofParameter<int>).name()) {
+		text = ofToString((int)std::round(value.get<double>()));
+	} else if (value.is_number()) {
+		text = ofToString(value.get<double>());
+	} else if (value.is_string()) {
+		text = value.get<string>();
+	} else {
+		ofLogWarning("BenchRunner") << "Unsupported value for '" << name << "': " << value.dump();
+		return;
+	}
+	parameter->fromString(text);
+}
+
+//--------------------------------------------------------------
+BenchRunner::Screen * BenchRunner::findScreen(const string & name) {
+	for (auto & screen : screens) {
+		if (screen.name == name) return &screen;
+	}
+	return nullptr;
+}
+
+//--------------------------------------------------------------
+ofAbstractParameter * BenchRunner::findParameter(ofParameterGroup & group, const string & name) {
+	// By display name, descending into the GUI's sub-groups
+	for (auto & parameter : group) {
+		if (parameter->getName() == name) return parameter.get();
+		if (parameter->type() == typeid(ofParameterGroup).name()) {
+			if (auto found = findParameter(parameter->castGroup(), name)) return found;
+		}
+	}
+	return nullptr;
+}
+
+//--------------------------------------------------------------
+ofJson BenchRunner::summarize(vector<float> samples) {
+	if (samples.empty()) return ofJson();
+
+	std::sort(samples.begin(), samples.end());
+	auto percentile = [&samples](float p) {
+		return samples[std::min(samples.size() - 1, (size_t)(p * (samples.size() - 1) + 0.5f))];
+	};
+	double sum = 0.0;
+	for (float sample : samples) {
+		sum += sample;
+	}
+
+	ofJson stats;
+	stats["count"] = samples.size();
+	stats["min"] = samples.front();
+	stats["avg"] = sum / samples.size();
+	stats["p50"] = percentile(0.50f);
+	stats["p95"] = percentile(0.95f);
+	stats["p99"] = percentile(0.99f);
+	stats["max"] = samples.back();
+	return stats;
+}
+
+//--------------------------------------------------------------
+void BenchRunner::finish() {
+	ofRemoveListener(ofGetMainLoop()->loopEvent, this, &BenchRunner::onLoop);
+
+	ofJson report;
+	report["script"] = settings.scriptPath;
+	report["frames"] = settings.frames;
+	report["warmup"] = settings.warmup;
+	report["stepMs"] = settings.step * 1000.0;
+	report["renderer"] = renderer;
+	report["frameMs"] = summarize(frameMs);
+
+	for (auto & screen : screens) {
+		ofJson passes = ofJson::object();
+		for (const auto & pass : screen.passes) {
+			passes[pass.first]["cpuMs"] = summarize(pass.second.cpu);
+			passes[pass.first]["gpuMs"] = summarize(pass.second.gpu);
+		}
+		report["screens"][screen.name]["window"] = { screen.window->getWidth(), screen.window->getHeight() };
+		report["screens"][screen.name]["passes"] = passes;
+		screen.profiler->setSampleCallback(nullptr);
+	}
+
+	std::cout << report.dump(2) << std::endl;
+	if (!settings.outputPath.empty()) {
+		if (ofSavePrettyJson(settings.outputPath, report)) {
+			ofLogNotice("BenchRunner") << "Results written to " << settings.outputPath;
+		} else {
+			ofLogError("BenchRunner") << "Could not write " << settings.outputPath;
+		}
+	}
+	ofExit(0);
+}
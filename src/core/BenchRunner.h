@@ -0,0 +1,92 @@
+#pragma once
+#include "core/FrameProfiler.h"
+#include "ofMain.h"
+#include <functional>
+
+// Headless benchmark run (--bench). Drives every registered screen with a
+// fixed animation step (AppClock) and a scripted timeline of parameter
+// changes and key presses for a fixed number of frames, then prints the
+// per-frame and per-pass statistics as JSON and exits.
+//
+// Script (bin/data/bench/default.json unless --bench-script= is given):
+//   { "frames": 600, "warmup": 60, "step": 0.0166667,
+//     "events": [
+//       { "frame": 0, "screen": "Screen1", "param": "Gallery Mode", "value": true },
+//       { "frame": 120, "until": 240, "screen": "Screen2", "param": "Grid Resolution", "from": 20, "value": 120 },
+//       { "frame": 300, "screen": "Screen3", "key": "g" } ] }
+// Frame numbers count from the first frame, warmup included; "until" ramps
+// a numeric parameter linearly from "from" to "value".
+// Samples from the warmup frames are discarded. Adaptive quality is turned
+// off on every screen at frame 0 so the work per frame stays repeatable.
+class BenchRunner {
+public:
+	// frames / warmup / step left at their "unset" values come from the
+	// script, or fall back to 600 / 60 / 1/60 s
+	struct Settings {
+		int frames = 0;
+		int warmup = -1;
+		double step = 0.0;
+		string scriptPath;
+		string outputPath; // JSON is also written here when set
+	};
+
+	// Registers a screen; App provides getParameters() and getProfiler()
+	template <typename App>
+	void addScreen(const string & name, shared_ptr<ofAppBaseWindow> window, shared_ptr<App> app) {
+		Screen screen;
+		screen.name = name;
+		screen.window = window;
+		screen.app = app;
+		screen.getParameters = [app]() -> ofParameterGroup & { return app->getParameters(); };
+		screen.profiler = &app->getProfiler();
+		screens.push_back(std::move(screen));
+	}
+
+	// Loads the script, applies the frame 0 events and hooks the main loop;
+	// call after ofRunApp, when every screen has been set up
+	bool setup(const Settings & settings);
+
+private:
+	struct Event {
+		int frame = 0;
+		int until = -1;
+		string screen;
+		string param;
+		string key;
+		ofJson from;
+		ofJson value;
+	};
+
+	struct PassSamples {
+		vector<float> cpu;
+		vector<float> gpu;
+	};
+
+	struct Screen {
+		string name;
+		shared_ptr<ofAppBaseWindow> window;
+		shared_ptr<ofBaseApp> app;
+		std::function<ofParameterGroup &()> getParameters;
+		FrameProfiler * profiler = nullptr;
+		std::map<string, PassSamples> passes;
+	};
+
+	Settings settings;
+	vector<Event> events;
+	vector<Screen> screens;
+	int frame = 0;
+	uint64_t lastLoopMicros = 0;
+	vector<float> frameMs;
+	string renderer;
+
+	bool loadScript(const string & path);
+	void onLoop();
+	void start();
+	void applyEvents(int frame);
+	void setParameter(Screen & screen, const string & name, const ofJson & value);
+	void finish();
+
+	Screen * findScreen(const string & name);
+	static ofAbstractParameter * findParameter(ofParameterGroup & group, const string & name);
+	static ofJson summarize(vector<float> samples);
+};
@@ -1,4 +1,32 @@
 #include "DataManager.h"
+#include "utils/Trace.h"
+#include <limits>
+
+namespace {
+
+// Holds dataMutex like a lock_guard; when the mutex is contended the wait
+// is recorded as its own trace event
+class DataLock {
+public:
+	explicit DataLock(std::mutex & mutex)
+		: mutex(mutex) {
+		if (!mutex.try_lock()) {
+			TRACE_SCOPE("DataManager", "dataMutex wait");
+			mutex.lock();
+		}
+	}
+	~DataLock() { mutex.unlock(); }
+
+private:
+	std::mutex & mutex;
+};
+
+}
+
+// Every accessor is a trace scope named after the accessor
+#define DATA_LOCK() \
+	TRACE_SCOPE("DataManager", __func__); \
+	DataLock lock(dataMutex)
 
 DataManager & DataManager::getInstance() {
 	static DataManager instance;
@@ -7,288 +35,353 @@ DataManager & DataManager::getInstance() {
 
 // === ״̬ ===
 void DataManager::setAnimationState(AnimationState state) {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	currentState = state;
 }
 
 AnimationState DataManager::getAnimationState() const {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	return currentState;
 }
 
 void DataManager::setTargetState(AnimationState target) {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	targetState = target;
 }
 
 AnimationState DataManager::getTargetState() const {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	return targetState;
 }
 
 void DataManager::setStateTransition(float transition) {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	stateTransition = transition;
 }
 
 float DataManager::getStateTransition() const {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	return stateTransition;
 }
 
 // ===  ===
 
 void DataManager::setAnimationParams(const AnimationParams & params) {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	currentAnimParams = params;
 }
 
 AnimationParams DataManager::getAnimationParams() const {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	return currentAnimParams;
 }
 
 void DataManager::setCalmParams(const AnimationParams & params) {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	calmParams = params;
 }
 
 AnimationParams DataManager::getCalmParams() const {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	return calmParams;
 }
 
 void DataManager::setIntenseParams(const AnimationParams & params) {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	intenseParams = params;
 }
 
 AnimationParams DataManager::getIntenseParams() const {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	return intenseParams;
 }
 
 // === Ч ===
 
 void DataManager::setFractureParams(const FractureParams & params) {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	fractureParams = params;
 }
 
 FractureParams DataManager::getFractureParams() const {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	return fractureParams;
 }
 
 void DataManager::setDissipationParams(const DissipationParams & params) {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	dissipationParams = params;
 }
 
 DissipationParams DataManager::getDissipationParams() const {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	return dissipationParams;
 }
 
 // === ղ ===
 
 void DataManager::setLightingParams(const LightingParams & params) {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	lightingParams = params;
 }
 
 LightingParams DataManager::getLightingParams() const {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	return lightingParams;
 }
 
 // === ݹ ===
 
 void DataManager::setCubeMeshConfig(const CubeMeshConfig & config) {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	cubeMeshConfig = config;
 }
 
 CubeMeshConfig DataManager::getCubeMeshConfig() const {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	return cubeMeshConfig;
 }
 
 void DataManager::setFlowFieldConfig(const FlowFieldConfig & config) {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	flowFieldConfig = config;
 }
 
 FlowFieldConfig DataManager::getFlowFieldConfig() const {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	return flowFieldConfig;
 }
 
 // === Ⱦݹ ===
 
 void DataManager::setGeometryFBO(const ofFbo & fbo) {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	// ֻǱFBOݣʵʵFBOҪʹô
 	hasGeometryFboData = true;
 }
 
 bool DataManager::hasGeometryFBO() const {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	return hasGeometryFboData;
 }
 
 const ofFbo & DataManager::getGeometryFBO() const {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	return geometryFbo;
 }
 
 // === ʱ ===
 
 void DataManager::setElapsedTime(float time) {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	elapsedTime = time;
 }
 
 float DataManager::getElapsedTime() const {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	return elapsedTime;
 }
 
 void DataManager::setTransitionSpeed(float speed) {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	transitionSpeed = speed;
 }
 
 float DataManager::getTransitionSpeed() const {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	return transitionSpeed;
 }
 
 // ===  ===
 
 void DataManager::setDebugMode(bool enabled) {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	debugMode = enabled;
 }
 
 bool DataManager::isDebugMode() const {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	return debugMode;
 }
 
 void DataManager::setAutoEffectCycle(bool enabled) {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	autoEffectCycle = enabled;
 }
 
 bool DataManager::isAutoEffectCycle() const {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	return autoEffectCycle;
 }
 
 void DataManager::setEffectStartTime(float time) {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	effectStartTime = time;
 }
 
 float DataManager::getEffectStartTime() const {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	return effectStartTime;
 }
 
 // === Meshݹ ===
-void DataManager::setScreen1Mesh(const ofVboMesh & mesh) {
-	std::lock_guard<std::mutex> lock(dataMutex);
+void DataManager::setScreen1Mesh(const ofMesh & mesh) {
+	DATA_LOCK();
 	screen1Mesh = mesh;
 	hasScreen1Data = true;
 }
 
-ofVboMesh DataManager::getScreen1Mesh() const {
-	std::lock_guard<std::mutex> lock(dataMutex);
+ofMesh DataManager::getScreen1Mesh() const {
+	DATA_LOCK();
 	return screen1Mesh;
 }
 
 bool DataManager::hasScreen1MeshData() const {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	return hasScreen1Data;
 }
 
-void DataManager::setScreen2BaseMesh(const ofVboMesh & mesh) {
-	std::lock_guard<std::mutex> lock(dataMutex);
+void DataManager::setScreen2BaseMesh(const ofMesh & mesh) {
+	DATA_LOCK();
 	screen2BaseMesh = mesh;
 	hasScreen2Data = true;
+	screen2MeshRevision++;
 }
 
-ofVboMesh DataManager::getScreen2BaseMesh() const {
-	std::lock_guard<std::mutex> lock(dataMutex);
+ofMesh DataManager::getScreen2BaseMesh() const {
+	DATA_LOCK();
 	return screen2BaseMesh;
 }
 
 bool DataManager::hasScreen2MeshData() const {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	return hasScreen2Data;
 }
+
+unsigned int DataManager::getScreen2MeshRevision() const {
+	DATA_LOCK();
+	return screen2MeshRevision;
+}
+
+void DataManager::setScreen1MeshLods(const vector<MeshLod> & lods) {
+	DATA_LOCK();
+	// Only the vertex data; the LODs' VBOs stay with Screen1
+	screen1LodMeshes.clear();
+	for (const auto & lod : lods) {
+		screen1LodMeshes.push_back(lod.mesh);
+	}
+	screen1ModelRevision++;
+}
+
+unsigned int DataManager::getScreen1ModelRevision() const {
+	DATA_LOCK();
+	return screen1ModelRevision;
+}
+
+bool DataManager::hasScreen1MeshLods() const {
+	DATA_LOCK();
+	return !screen1LodMeshes.empty();
+}
+
+ofMesh DataManager::getScreen1MeshForVertexCount(int targetVertices) const {
+	DATA_LOCK();
+	return findScreen1Lod(targetVertices);
+}
+
+size_t DataManager::getScreen1VertexCount() const {
+	DATA_LOCK();
+	return screen1Mesh.getNumVertices();
+}
+
+size_t DataManager::getScreen1VertexCountFor(int targetVertices) const {
+	DATA_LOCK();
+	return findScreen1Lod(targetVertices).getNumVertices();
+}
+
+const ofMesh & DataManager::findScreen1Lod(int targetVertices) const {
+	if (screen1LodMeshes.empty()) {
+		return screen1Mesh;
+	}
+
+	size_t best = 0;
+	int bestDiff = std::numeric_limits<int>::max();
+	for (size_t i = 0; i < screen1LodMeshes.size(); i++) {
+		int diff = std::abs((int)screen1LodMeshes[i].getNumVertices() - targetVertices);
+		if (diff < bestDiff) {
+			bestDiff = diff;
+			best = i;
+		}
+	}
+	return screen1LodMeshes[best];
+}
+
 void DataManager::setScreen1ModelMatrix(const ofMatrix4x4 & matrix) {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	screen1ModelMatrix = matrix;
 }
 
 ofMatrix4x4 DataManager::getScreen1ModelMatrix() const {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	return screen1ModelMatrix;
 }
 
 void DataManager::setCurrentModelPath(const string & path) {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	currentModelPath = path;
 }
 
 string DataManager::getCurrentModelPath() const {
-	std::lock_guard<std::mutex> lock(dataMutex);
+	DATA_LOCK();
 	return currentModelPath;
 }
-void DataManager::setScreen1PositionTexture(const ofTexture & posTexture, const ofTexture & depthTexture) {
-	std::lock_guard<std::mutex> lock(dataMutex);
-	ofLogNotice("DataManager") << "Receiving Screen1 texture - ID: " << posTexture.getTextureData().textureID;
-	ofLogNotice("DataManager") << "Texture allocated: " << posTexture.isAllocated();
-	screen1PosTexture = posTexture;
-	screen1DepthTexture = depthTexture;
+void DataManager::setScreen1PositionTarget(const PositionTarget & target) {
+	DATA_LOCK();
+	screen1PositionTarget = target;
 	hasScreen1PosData = true;
 }
 
-void DataManager::setScreen2PositionTexture(const ofTexture & posTexture, const ofTexture & depthTexture) {
-	std::lock_guard<std::mutex> lock(dataMutex);
-	screen2PosTexture = posTexture;
-	screen2DepthTexture = depthTexture;
+void DataManager::setScreen2PositionTarget(const PositionTarget & target) {
+	DATA_LOCK();
+	screen2PositionTarget = target;
 	hasScreen2PosData = true;
 }
 
 bool DataManager::hasScreen1PositionData() const {
-	std::lock_guard<std::mutex> lock(dataMutex);
-	return hasScreen1PosData && screen1PosTexture.isAllocated();
+	DATA_LOCK();
+	return hasScreen1PosData && screen1PositionTarget.depth.isAllocated();
 }
 
 bool DataManager::hasScreen2PositionData() const {
-	std::lock_guard<std::mutex> lock(dataMutex);
-	return hasScreen2PosData && screen2PosTexture.isAllocated();
+	DATA_LOCK();
+	return hasScreen2PosData && screen2PositionTarget.depth.isAllocated();
+}
+
+PositionTarget DataManager::getScreen1PositionTarget() const {
+	DATA_LOCK();
+	return screen1PositionTarget;
+}
+
+PositionTarget DataManager::getScreen2PositionTarget() const {
+	DATA_LOCK();
+	return screen2PositionTarget;
 }
 
-ofTexture DataManager::getScreen1PositionTexture() const {
-	std::lock_guard<std::mutex> lock(dataMutex);
-	return screen1PosTexture;
+void DataManager::setPositionEncoding(PositionEncoding encoding) {
+	DATA_LOCK();
+	positionEncoding = encoding;
 }
 
-ofTexture DataManager::getScreen1DepthTexture() const {
-	std::lock_guard<std::mutex> lock(dataMutex);
-	return screen1DepthTexture;
+PositionEncoding DataManager::getPositionEncoding() const {
+	DATA_LOCK();
+	return positionEncoding;
 }
 
-ofTexture DataManager::getScreen2PositionTexture() const {
-	std::lock_guard<std::mutex> lock(dataMutex);
-	return screen2PosTexture;
+void DataManager::setChannelWanted(DataChannel channel, bool wanted) {
+	DATA_LOCK();
+	channelWanted[channel] = wanted;
 }
 
-ofTexture DataManager::getScreen2DepthTexture() const {
-	std::lock_guard<std::mutex> lock(dataMutex);
-	return screen2DepthTexture;
+bool DataManager::isChannelWanted(DataChannel channel) const {
+	DATA_LOCK();
+	return channelWanted[channel];
 }
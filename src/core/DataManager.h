@@ -69,13 +69,30 @@ public:
 	float getEffectStartTime() const;
 
 
-	void setScreen1Mesh(const ofVboMesh & mesh);
-	ofVboMesh getScreen1Mesh() const;
+	// Mesh channels carry CPU data only. They are read and written from the
+	// screens' CPU phases on TaskSystem workers, where an ofVboMesh copy could
+	// drop the last reference to its GL buffers; a screen that draws a shared
+	// mesh builds its own ofVboMesh from it in its GL phase.
+	void setScreen1Mesh(const ofMesh & mesh);
+	ofMesh getScreen1Mesh() const;
 	bool hasScreen1MeshData() const;
 
-	void setScreen2BaseMesh(const ofVboMesh & mesh);
-	ofVboMesh getScreen2BaseMesh() const;
+	void setScreen2BaseMesh(const ofMesh & mesh);
+	ofMesh getScreen2BaseMesh() const;
 	bool hasScreen2MeshData() const;
+	// Bumped by every setScreen2BaseMesh()
+	unsigned int getScreen2MeshRevision() const;
+
+	// Screen1 LOD chain, published once per model load
+	void setScreen1MeshLods(const vector<MeshLod> & lods);
+	bool hasScreen1MeshLods() const;
+	// Bumped every time a new model's LOD chain is published
+	unsigned int getScreen1ModelRevision() const;
+	// LOD whose vertex count is closest to targetVertices (full mesh if no chain)
+	ofMesh getScreen1MeshForVertexCount(int targetVertices) const;
+	// Vertex counts of the meshes above, for checking for changes without a copy
+	size_t getScreen1VertexCount() const;
+	size_t getScreen1VertexCountFor(int targetVertices) const;
 
 	ofMatrix4x4 getScreen1ModelMatrix() const;
 	void setScreen1ModelMatrix(const ofMatrix4x4 & matrix);
@@ -83,14 +100,22 @@ public:
 	void setCurrentModelPath(const string & path);
 
 	// === λ ===
-	void setScreen1PositionTexture(const ofTexture & posTexture, const ofTexture & depthTexture);
-	void setScreen2PositionTexture(const ofTexture & posTexture, const ofTexture & depthTexture);
+	// Published by Screen1/Screen2 after every position pass
+	void setScreen1PositionTarget(const PositionTarget & target);
+	void setScreen2PositionTarget(const PositionTarget & target);
 	bool hasScreen1PositionData() const;
 	bool hasScreen2PositionData() const;
-	ofTexture getScreen1PositionTexture() const;
-	ofTexture getScreen1DepthTexture() const;
-	ofTexture getScreen2PositionTexture() const;
-	ofTexture getScreen2DepthTexture() const;
+	PositionTarget getScreen1PositionTarget() const;
+	PositionTarget getScreen2PositionTarget() const;
+
+	// Encoding the producers render with, chosen by the consumer (Screen3)
+	void setPositionEncoding(PositionEncoding encoding);
+	PositionEncoding getPositionEncoding() const;
+
+	// Whether any consumer reads the channel; producers skip the pass
+	// otherwise. Everything is wanted unless a FrameScheduler says not.
+	void setChannelWanted(DataChannel channel, bool wanted);
+	bool isChannelWanted(DataChannel channel) const;
 
 
 private:
@@ -138,16 +163,24 @@ private:
 	bool autoEffectCycle = false;
 
 	// === Meshݹ ===
-	ofVboMesh screen1Mesh; // Screen1ģmesh
-	ofVboMesh screen2BaseMesh; // Screen2Ļmesh
+	ofMesh screen1Mesh; // Screen1ģmesh
+	ofMesh screen2BaseMesh; // Screen2Ļmesh
+	unsigned int screen2MeshRevision = 0;
 	bool hasScreen1Data = false;
 	bool hasScreen2Data = false;
+	vector<ofMesh> screen1LodMeshes; // CPU copies of the LOD chain's meshes
+	unsigned int screen1ModelRevision = 0;
+	// getScreen1MeshForVertexCount()'s pick; dataMutex must be held
+	const ofMesh & findScreen1Lod(int targetVertices) const;
 
 	ofMatrix4x4 screen1ModelMatrix = ofMatrix4x4::newIdentityMatrix();
 	string currentModelPath = "";
 
-	ofTexture screen1PosTexture, screen1DepthTexture;
-	ofTexture screen2PosTexture, screen2DepthTexture;
+	PositionTarget screen1PositionTarget;
+	PositionTarget screen2PositionTarget;
+	PositionEncoding positionEncoding = POSITION_VIEW_RGBA16F;
 	bool hasScreen1PosData = false;
 	bool hasScreen2PosData = false;
+
+	bool channelWanted[CHANNEL_COUNT] = { true, true, true, true };
 };
@@ -0,0 +1,130 @@
+#include "DisplayManager.h"
+#include "utils/GlThread.h"
+
+//--------------------------------------------------------------
+ViewportWindow::ViewportWindow(shared_ptr<ofAppBaseWindow> host, const string & name)
+	: host(host)
+	, name(name) {
+}
+
+//--------------------------------------------------------------
+void ViewportWindow::update() {
+	events().notifyUpdate();
+}
+
+//--------------------------------------------------------------
+void ViewportWindow::draw() {
+	GL_THREAD_CHECK();
+	int w = std::max(1, getWidth());
+	int h = std::max(1, getHeight());
+	if (!target.isAllocated() || (int)target.getWidth() != w || (int)target.getHeight() != h) {
+		target.allocate(w, h, GL_RGBA);
+	}
+
+	target.begin();
+	ofClear(ofGetBackgroundColor());
+	events().notifyDraw();
+	target.end();
+}
+
+//--------------------------------------------------------------
+glm::vec2 ViewportWindow::getWindowPosition() {
+	return host->getWindowPosition() + glm::vec2(rect.x, rect.y);
+}
+
+//--------------------------------------------------------------
+DisplayManager::DisplayManager(shared_ptr<ofAppBaseWindow> host)
+	: host(host) {
+}
+
+//--------------------------------------------------------------
+shared_ptr<ViewportWindow> DisplayManager::addViewport(const string & name) {
+	viewports.push_back(std::make_shared<ViewportWindow>(host, name));
+	layout();
+	return viewports.back();
+}
+
+//--------------------------------------------------------------
+void DisplayManager::layout() {
+	// Equal columns: spanning displays of equal size, each screen gets one
+	int count = (int)viewports.size();
+	int w = host->getWidth();
+	int h = host->getHeight();
+	for (int i = 0; i < count; i++) {
+		int x0 = w * i / count;
+		int x1 = w * (i + 1) / count;
+		viewports[i]->setRect(ofRectangle(x0, 0, x1 - x0, h));
+	}
+}
+
+//--------------------------------------------------------------
+void DisplayManager::draw() {
+	// Straight copies: blending would let the targets' alpha show the host
+	// background through translucent GUI pixels
+	ofPushStyle();
+	ofDisableAlphaBlending();
+	ofSetColor(255);
+	for (const auto & viewport : viewports) {
+		if (viewport->getTarget().isAllocated()) {
+			viewport->getTarget().draw(viewport->getRect());
+		}
+	}
+	ofPopStyle();
+}
+
+//--------------------------------------------------------------
+void DisplayManager::windowResized(int w, int h) {
+	layout();
+	for (const auto & viewport : viewports) {
+		notifyIn(viewport, [&viewport]() {
+			viewport->events().notifyWindowResized(viewport->getWidth(), viewport->getHeight());
+		});
+	}
+	ofLogNotice("DisplayManager") << "Host window resized to " << w << "x" << h;
+}
+
+//--------------------------------------------------------------
+shared_ptr<ViewportWindow> DisplayManager::getViewportAt(float x, float y) const {
+	for (const auto & viewport : viewports) {
+		if (viewport->getRect().inside(x, y)) return viewport;
+	}
+	return nullptr;
+}
+
+//--------------------------------------------------------------
+void DisplayManager::notifyIn(const shared_ptr<ViewportWindow> & viewport, const std::function<void()> & notify) {
+	auto mainLoop = ofGetMainLoop();
+	auto previous = mainLoop->getCurrentWindow();
+	mainLoop->setCurrentWindow(viewport);
+	notify();
+	mainLoop->setCurrentWindow(previous);
+}
+
+//--------------------------------------------------------------
+void DisplayManager::forwardKey(ofKeyEventArgs key) {
+	if (!keyboardFocus) return;
+	notifyIn(keyboardFocus, [this, &key]() { keyboardFocus->events().notifyKeyEvent(key); });
+}
+
+//--------------------------------------------------------------
+void DisplayManager::forwardMouse(ofMouseEventArgs mouse) {
+	shared_ptr<ViewportWindow> viewport = mouseCapture ? mouseCapture : getViewportAt(mouse.x, mouse.y);
+	if (!viewport) return;
+
+	keyboardFocus = viewport;
+	if (mouse.type == ofMouseEventArgs::Pressed) mouseCapture = viewport;
+	if (mouse.type == ofMouseEventArgs::Released) mouseCapture = nullptr;
+
+	mouse.x -= viewport->getRect().x;
+	mouse.y -= viewport->getRect().y;
+	notifyIn(viewport, [&viewport, &mouse]() { viewport->events().notifyMouseEvent(mouse); });
+}
+
+//--------------------------------------------------------------
+void DisplayManager::dragEvent(ofDragInfo dragInfo) {
+	shared_ptr<ViewportWindow> viewport = getViewportAt(dragInfo.position.x, dragInfo.position.y);
+	if (!viewport) return;
+
+	dragInfo.position -= glm::vec2(viewport->getRect().x, viewport->getRect().y);
+	notifyIn(viewport, [&viewport, &dragInfo]() { viewport->events().notifyDragEvent(dragInfo); });
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include "ofMain.h"
+
+// Stand-in window for one screen in single-window mode. The app runs on it
+// as on any window, but it reports its viewport's size, borrows the host
+// window's context and renderer, and draw() renders into an offscreen
+// target that DisplayManager composes into the host.
+class ViewportWindow : public ofAppBaseWindow {
+public:
+	ViewportWindow(shared_ptr<ofAppBaseWindow> host, const string & name);
+
+	void setup(const ofWindowSettings & settings) override { }
+	void update() override;
+	void draw() override;
+	void close() override { }
+	bool getWindowShouldClose() override { return host->getWindowShouldClose(); }
+	void setWindowShouldClose() override { host->setWindowShouldClose(); }
+
+	ofCoreEvents & events() override { return coreEvents; }
+	shared_ptr<ofBaseRenderer> & renderer() override { return host->renderer(); }
+	void makeCurrent() override { host->makeCurrent(); }
+
+	glm::vec2 getWindowPosition() override;
+	glm::vec2 getWindowSize() override { return glm::vec2(rect.width, rect.height); }
+	glm::vec2 getScreenSize() override { return host->getScreenSize(); }
+	int getWidth() override { return (int)rect.width; }
+	int getHeight() override { return (int)rect.height; }
+
+	// Window-level requests go to the host
+	ofWindowMode getWindowMode() override { return host->getWindowMode(); }
+	void setFullscreen(bool fullscreen) override { host->setFullscreen(fullscreen); }
+	void toggleFullscreen() override { host->toggleFullscreen(); }
+	void setVerticalSync(bool enabled) override { host->setVerticalSync(enabled); }
+	void hideCursor() override { host->hideCursor(); }
+	void showCursor() override { host->showCursor(); }
+
+	const string & getName() const { return name; }
+	const ofRectangle & getRect() const { return rect; }
+	void setRect(const ofRectangle & newRect) { rect = newRect; }
+	const ofFbo & getTarget() const { return target; }
+
+private:
+	shared_ptr<ofAppBaseWindow> host;
+	string name;
+	ofRectangle rect;
+	ofCoreEvents coreEvents;
+	ofFbo target;
+};
+
+// Single-window presentation: one window, optionally fullscreen across
+// every display, shows the screens side by side in equal viewports. One
+// context, one swap per frame and one renderer instead of a context
+// switch and a swap per window.
+//
+// DisplayManager is the host window's app. Its draw() composes the
+// viewport targets; mouse input goes to the viewport under the cursor (a
+// drag stays with the viewport it started in) and keys to the viewport
+// the mouse was last in. FrameScheduler drives the viewports as screens
+// and presents the host (setPresentWindow) after any of them drew.
+class DisplayManager : public ofBaseApp {
+public:
+	explicit DisplayManager(shared_ptr<ofAppBaseWindow> host);
+
+	// Viewports are laid out left to right in the order they are added
+	shared_ptr<ViewportWindow> addViewport(const string & name);
+	shared_ptr<ofAppBaseWindow> getHost() const { return host; }
+
+	void draw() override;
+	void windowResized(int w, int h) override;
+	void dragEvent(ofDragInfo dragInfo) override;
+	void keyPressed(ofKeyEventArgs & key) override { forwardKey(key); }
+	void keyReleased(ofKeyEventArgs & key) override { forwardKey(key); }
+	void mouseMoved(ofMouseEventArgs & mouse) override { forwardMouse(mouse); }
+	void mouseDragged(ofMouseEventArgs & mouse) override { forwardMouse(mouse); }
+	void mousePressed(ofMouseEventArgs & mouse) override { forwardMouse(mouse); }
+	void mouseReleased(ofMouseEventArgs & mouse) override { forwardMouse(mouse); }
+	void mouseScrolled(ofMouseEventArgs & mouse) override { forwardMouse(mouse); }
+
+private:
+	shared_ptr<ofAppBaseWindow> host;
+	vector<shared_ptr<ViewportWindow>> viewports;
+	shared_ptr<ViewportWindow> mouseCapture;
+	shared_ptr<ViewportWindow> keyboardFocus;
+
+	void layout();
+	shared_ptr<ViewportWindow> getViewportAt(float x, float y) const;
+	void forwardKey(ofKeyEventArgs key);
+	void forwardMouse(ofMouseEventArgs mouse);
+	// Runs a forwarded event with the viewport as the current window, so
+	// ofGetWidth() and friends answer for it
+	void notifyIn(const shared_ptr<ViewportWindow> & viewport, const std::function<void()> & notify);
+};
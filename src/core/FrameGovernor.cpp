@@ -0,0 +1,129 @@
+#include "FrameGovernor.h"
+
+//--------------------------------------------------------------
+FrameGovernor::FrameGovernor(const string & name)
+	: name(name) {
+}
+
+//--------------------------------------------------------------
+const vector<FrameGovernor::Level> & FrameGovernor::getLevels() {
+	// Cheapest knobs first: resolution loses least, geometry and effects next
+	static const vector<Level> levels = {
+		{ 1.00f, 1.00f, 2 },
+		{ 0.85f, 1.00f, 2 },
+		{ 0.85f, 0.75f, 1 },
+		{ 0.70f, 0.75f, 1 },
+		{ 0.70f, 0.50f, 0 },
+		{ 0.50f, 0.50f, 0 },
+		{ 0.50f, 0.35f, 0 },
+	};
+	return levels;
+}
+
+//--------------------------------------------------------------
+void FrameGovernor::setup(const Settings & newSettings) {
+	settings = newSettings;
+}
+
+//--------------------------------------------------------------
+void FrameGovernor::setEnabled(bool newEnabled) {
+	if (enabled == newEnabled) return;
+	enabled = newEnabled;
+	overFrames = underFrames = 0;
+	upgradeBackoff = 1;
+	ofLogNotice("FrameGovernor") << name << ": " << (enabled ? "enabled" : "disabled");
+}
+
+//--------------------------------------------------------------
+void FrameGovernor::beginCpu() {
+	cpuStart = ofGetElapsedTimeMicros();
+}
+
+//--------------------------------------------------------------
+void FrameGovernor::endCpu() {
+	cpuAccumulated += ofGetElapsedTimeMicros() - cpuStart;
+}
+
+//--------------------------------------------------------------
+bool FrameGovernor::update(float newGpuMs) {
+	cpuMs = cpuAccumulated / 1000.0f;
+	cpuAccumulated = 0;
+	if (newGpuMs >= 0.0f) gpuMs = newGpuMs;
+
+	float frameMs = std::max(cpuMs, gpuMs);
+	smoothedMs = smoothedMs > 0.0f ? ofLerp(smoothedMs, frameMs, settings.smoothing) : frameMs;
+	if (framesSinceUpgrade >= 0) framesSinceUpgrade++;
+
+	// Oscillations earlier in the session should not block upgrades forever
+	if (upgradeBackoff > 1 && ++stableFrames >= settings.backoffDecayFrames) {
+		upgradeBackoff /= 2;
+		stableFrames = 0;
+		ofLogNotice("FrameGovernor") << name << ": stable, upgrade backoff down to " << upgradeBackoff << "x";
+	}
+
+	if (!enabled) {
+		if (levelIndex == 0) return false;
+		setLevel(0, "governor disabled");
+		return true;
+	}
+
+	if (cooldown > 0) {
+		cooldown--;
+		return false;
+	}
+
+	if (smoothedMs > settings.budgetMs * settings.downgradeRatio) {
+		overFrames++;
+		underFrames = 0;
+	} else if (smoothedMs < settings.budgetMs * settings.upgradeRatio) {
+		underFrames++;
+		overFrames = 0;
+	} else {
+		overFrames = underFrames = 0;
+	}
+
+	int maxLevel = (int)getLevels().size() - 1;
+	if (overFrames >= settings.downgradeFrames && levelIndex < maxLevel) {
+		// The last upgrade did not hold; wait longer before trying again
+		if (framesSinceUpgrade >= 0 && framesSinceUpgrade < settings.upgradeFrames * upgradeBackoff) {
+			upgradeBackoff = std::min(upgradeBackoff * 2, 8);
+		}
+		setLevel(levelIndex + 1, "over budget");
+		return true;
+	}
+	if (underFrames >= settings.upgradeFrames * upgradeBackoff && levelIndex > 0) {
+		setLevel(levelIndex - 1, "under budget");
+		framesSinceUpgrade = 0;
+		return true;
+	}
+	return false;
+}
+
+//--------------------------------------------------------------
+void FrameGovernor::setLevel(int index, const string & reason) {
+	int previous = levelIndex;
+	levelIndex = std::max(0, std::min(index, (int)getLevels().size() - 1));
+	overFrames = underFrames = 0;
+	stableFrames = 0;
+	cooldown = settings.cooldownFrames;
+
+	const Level & level = getLevel();
+	lastDecision = "L" + ofToString(previous) + " -> L" + ofToString(levelIndex) + " (" + reason + ", "
+		+ ofToString(smoothedMs, 1) + "/" + ofToString(settings.budgetMs, 1) + " ms)";
+	ofLogNotice("FrameGovernor") << name << ": " << lastDecision
+								 << " cpu " << ofToString(cpuMs, 1) << " ms, gpu " << ofToString(gpuMs, 1) << " ms"
+								 << " -> scale " << level.renderScale << ", lod " << level.lodScale
+								 << ", effects " << level.effectQuality;
+}
+
+//--------------------------------------------------------------
+string FrameGovernor::getStatus() const {
+	const Level & level = getLevel();
+	string status = "Governor: " + string(enabled ? "L" + ofToString(levelIndex) + "/" + ofToString(getLevels().size() - 1) : "off")
+		+ " | scale " + ofToString(level.renderScale * 100.0f, 0) + "% lod " + ofToString(level.lodScale * 100.0f, 0)
+		+ "% fx " + ofToString(level.effectQuality) + "\n";
+	status += "Frame: cpu " + ofToString(cpuMs, 1) + " gpu " + ofToString(gpuMs, 1)
+		+ " avg " + ofToString(smoothedMs, 1) + " / " + ofToString(settings.budgetMs, 1) + " ms\n";
+	status += "Last change: " + lastDecision + "\n";
+	return status;
+}
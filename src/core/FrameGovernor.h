@@ -0,0 +1,79 @@
+#pragma once
+#include "ofMain.h"
+
+// Holds one window near a frame-time budget by stepping through a ladder
+// of quality levels. The frame time is max(CPU, GPU), smoothed. Hysteresis:
+// - separate over/under thresholds
+// - over budget must persist for a short run of frames, under budget for a
+//   much longer one
+// - a cooldown after every change
+// - an upgrade that is undone right away doubles the wait before the next;
+//   a long run without any change halves it again
+// Every change is logged and kept for the debug overlay.
+class FrameGovernor {
+public:
+	struct Level {
+		float renderScale = 1.0f; // internal size of the window's FBOs
+		float lodScale = 1.0f; // multiplier on the LOD budget
+		int effectQuality = 2; // 2 = full, 1 = reduced, 0 = cheapest effect variants
+	};
+
+	struct Settings {
+		float budgetMs = 16.6f;
+		float downgradeRatio = 1.05f; // step down above budget * ratio
+		float upgradeRatio = 0.75f; // step up below budget * ratio
+		int downgradeFrames = 30;
+		int upgradeFrames = 180;
+		int cooldownFrames = 60;
+		int backoffDecayFrames = 1800; // stable frames that halve the upgrade backoff
+		float smoothing = 0.1f; // EMA weight of the newest frame
+	};
+
+	explicit FrameGovernor(const string & name = "FrameGovernor");
+
+	void setup(const Settings & settings);
+	void setBudgetMs(float budgetMs) { settings.budgetMs = budgetMs; }
+	// Disabling returns to full quality on the next update()
+	void setEnabled(bool enabled);
+
+	// Bracket the window's CPU work (update and draw); spans accumulate
+	void beginCpu();
+	void endCpu();
+
+	// Once per frame before any work: closes the previous frame's CPU time,
+	// takes the latest GPU time (negative if none arrived) and decides.
+	// Returns true when the level changed.
+	bool update(float gpuMs);
+
+	const Level & getLevel() const { return getLevels()[levelIndex]; }
+	int getLevelIndex() const { return levelIndex; }
+	float getCpuMs() const { return cpuMs; }
+	float getGpuMs() const { return gpuMs; }
+	float getSmoothedMs() const { return smoothedMs; }
+	const string & getLastDecision() const { return lastDecision; }
+	string getStatus() const;
+
+	static const vector<Level> & getLevels();
+
+private:
+	string name;
+	Settings settings;
+	bool enabled = true;
+	int levelIndex = 0;
+
+	uint64_t cpuStart = 0;
+	uint64_t cpuAccumulated = 0;
+	float cpuMs = 0.0f;
+	float gpuMs = 0.0f;
+	float smoothedMs = 0.0f;
+
+	int overFrames = 0;
+	int underFrames = 0;
+	int cooldown = 0;
+	int framesSinceUpgrade = -1; // -1 until the first upgrade
+	int upgradeBackoff = 1;
+	int stableFrames = 0; // since the last level change
+	string lastDecision = "none";
+
+	void setLevel(int index, const string & reason);
+};
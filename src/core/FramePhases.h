@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+
+// Everything a screen's CPU phase may know about the frame, captured on the
+// context thread so the phase never asks the window (ofGetWidth & co. read
+// the main loop's current window and are not safe on workers)
+struct CpuFrame {
+	float time = 0.0f; // AppClock::getElapsedTimef()
+	float deltaTime = 0.0f; // seconds since this screen's previous frame
+	int width = 0; // window size in pixels
+	int height = 0;
+	uint64_t frame = 0; // this screen's frame number
+};
+
+// A screen whose update is split in two:
+// - updateCpu(): pure CPU work (GUI sync, animation, building and
+//   publishing data). FrameScheduler runs it on the TaskSystem, every due
+//   screen concurrently except that consumers wait for their producers.
+//   No GL context is current; GL_THREAD_CHECK() reports any GL entry point
+//   reached from here.
+// - update() / draw(): the GL phase, on the context thread in dependency
+//   order, after every CPU phase of the tick has finished.
+class PhasedScreen {
+public:
+	virtual ~PhasedScreen() = default;
+	virtual void updateCpu(const CpuFrame & frame) = 0;
+};
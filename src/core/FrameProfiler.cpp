@@ -0,0 +1,177 @@
+#include "FrameProfiler.h"
+#include "utils/GlThread.h"
+#include "utils/HotLog.h"
+
+//--------------------------------------------------------------
+void FrameProfiler::RollingStats::add(float value) {
+	samples[next] = value;
+	next = (next + 1) % kHistory;
+	count = std::min(count + 1, kHistory);
+}
+
+//--------------------------------------------------------------
+float FrameProfiler::RollingStats::getMin() const {
+	return count > 0 ? *std::min_element(samples, samples + count) : 0.0f;
+}
+
+//--------------------------------------------------------------
+float FrameProfiler::RollingStats::getAverage() const {
+	if (count == 0) return 0.0f;
+	float sum = 0.0f;
+	for (int i = 0; i < count; i++) {
+		sum += samples[i];
+	}
+	return sum / count;
+}
+
+//--------------------------------------------------------------
+float FrameProfiler::RollingStats::getPercentile(float p) const {
+	if (count == 0) return 0.0f;
+	std::copy(samples, samples + count, sorted);
+	int index = std::min(count - 1, (int)(p * (count - 1) + 0.5f));
+	std::nth_element(sorted, sorted + index, sorted + count);
+	return sorted[index];
+}
+
+//--------------------------------------------------------------
+FrameProfiler::FrameProfiler(const string & name)
+	: name(name) {
+}
+
+//--------------------------------------------------------------
+FrameProfiler::~FrameProfiler() {
+	for (auto & pass : passes) {
+		for (auto & frame : pass.frames) {
+			if (frame.query) glDeleteQueries(1, &frame.query);
+		}
+	}
+}
+
+//--------------------------------------------------------------
+FrameProfiler::Pass & FrameProfiler::getPass(const string & pass) {
+	for (auto & p : passes) {
+		if (p.name == pass) return p;
+	}
+	passes.emplace_back();
+	passes.back().name = pass;
+	return passes.back();
+}
+
+//--------------------------------------------------------------
+void FrameProfiler::beginFrame() {
+	GL_THREAD_CHECK();
+	frameNumber++;
+	if (frameNumber < 3) return;
+
+	// This frame reuses the buffer written two frames ago; read it first
+	int buffer = frameNumber % 2;
+	for (auto & pass : passes) {
+		collect(pass, pass.frames[buffer], frameNumber - 2);
+	}
+}
+
+//--------------------------------------------------------------
+void FrameProfiler::collect(Pass & pass, Frame & frame, uint64_t frameOfResult) {
+	float gpuMs = -1.0f;
+	if (frame.issued) {
+		GLint available = 0;
+		glGetQueryObjectiv(frame.query, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available) {
+			GLuint64 elapsed = 0;
+			glGetQueryObjectui64v(frame.query, GL_QUERY_RESULT, &elapsed);
+			gpuMs = elapsed / 1000000.0f;
+			pass.gpu.add(gpuMs);
+		}
+	}
+
+	if (csv.is_open() && frame.cpuMs >= 0.0f) {
+		csv << frameOfResult << "," << pass.name << "," << frame.cpuMs << ",";
+		if (gpuMs >= 0.0f) csv << gpuMs;
+		csv << "\n";
+	}
+	if (onSample && frame.cpuMs >= 0.0f) {
+		onSample(pass.name, frame.cpuMs, gpuMs);
+	}
+
+	frame.issued = false;
+	frame.cpuMs = -1.0f;
+}
+
+//--------------------------------------------------------------
+void FrameProfiler::begin(const string & passName) {
+	GL_THREAD_CHECK();
+	Pass & pass = getPass(passName);
+	Frame & frame = pass.frames[frameNumber % 2];
+
+	if (activeQueries == 0) {
+		if (frame.query == 0) glGenQueries(1, &frame.query);
+		glBeginQuery(GL_TIME_ELAPSED, frame.query);
+		pass.gpuActive = true;
+		activeQueries++;
+	} else {
+		HOT_LOG_WARNING("FrameProfiler", 1.0f, "%s: '%s' overlaps another pass, GPU time skipped", name.c_str(),
+			passName.c_str());
+	}
+	pass.cpuStart = ofGetElapsedTimeMicros();
+}
+
+//--------------------------------------------------------------
+void FrameProfiler::end(const string & passName) {
+	Pass & pass = getPass(passName);
+	Frame & frame = pass.frames[frameNumber % 2];
+
+	float cpuMs = (ofGetElapsedTimeMicros() - pass.cpuStart) / 1000.0f;
+	frame.cpuMs = std::max(frame.cpuMs, 0.0f) + cpuMs;
+	pass.cpu.add(cpuMs);
+
+	if (pass.gpuActive) {
+		glEndQuery(GL_TIME_ELAPSED);
+		frame.issued = true;
+		pass.gpuActive = false;
+		activeQueries--;
+	}
+}
+
+//--------------------------------------------------------------
+const char * FrameProfiler::getReport() const {
+	// Anything past the end of the buffer is cut
+	size_t length = 0;
+	auto advance = [&](int written) {
+		if (written > 0) length = std::min(length + written, sizeof(report) - 1);
+	};
+
+	advance(snprintf(report, sizeof(report), "Pass                     cpu min/avg/p99    gpu min/avg/p99 (ms)\n"));
+	for (const auto & pass : passes) {
+		char cpu[48];
+		char gpu[48] = "-";
+		snprintf(cpu, sizeof(cpu), "%.2f/%.2f/%.2f", pass.cpu.getMin(), pass.cpu.getAverage(),
+			pass.cpu.getPercentile(0.99f));
+		if (!pass.gpu.empty()) {
+			snprintf(gpu, sizeof(gpu), "%.2f/%.2f/%.2f", pass.gpu.getMin(), pass.gpu.getAverage(),
+				pass.gpu.getPercentile(0.99f));
+		}
+		advance(snprintf(report + length, sizeof(report) - length, "%-24s %-18s %s\n", pass.name.c_str(), cpu, gpu));
+	}
+	if (isRecording()) {
+		advance(snprintf(report + length, sizeof(report) - length, "Recording %s\n", csvPath.c_str()));
+	}
+	return report;
+}
+
+//--------------------------------------------------------------
+void FrameProfiler::toggleRecording() {
+	if (csv.is_open()) {
+		csv.close();
+		ofLogNotice("FrameProfiler") << name << ": saved " << csvPath;
+		return;
+	}
+
+	csvPath = ofToDataPath("profile_" + name + "_" + ofGetTimestampString() + ".csv", true);
+	csv.open(csvPath);
+	if (!csv.is_open()) {
+		ofLogError("FrameProfiler") << name << ": could not open " << csvPath;
+		return;
+	}
+	csv << "frame,pass,cpu_ms,gpu_ms\n";
+	ofLogNotice("FrameProfiler") << name << ": recording to " << csvPath;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include "ofMain.h"
+#include <fstream>
+#include <functional>
+
+// Per-pass CPU and GPU timings for one window. Each pass is bracketed with
+// begin()/end(), which takes a CPU timestamp and issues a GL_TIME_ELAPSED
+// query. Queries are double-buffered: frame N's queries are read when
+// frame N+2 starts, just before reuse, and only once available. A result
+// that is not ready yet is dropped, so profiling never stalls the GPU.
+//
+// GL_TIME_ELAPSED queries cannot nest, so passes must not overlap; a nested
+// begin() still gets its CPU time but no GPU time. One instance per GL
+// context, since query objects are not shared.
+class FrameProfiler {
+public:
+	// Receives every collected sample (gpuMs < 0 when no GPU time was read)
+	using SampleCallback = std::function<void(const string & pass, float cpuMs, float gpuMs)>;
+
+	explicit FrameProfiler(const string & name);
+	~FrameProfiler();
+
+	// Once per frame before the first pass: collects the results of two
+	// frames ago and, while recording, writes them to the CSV
+	void beginFrame();
+
+	void begin(const string & pass);
+	void end(const string & pass);
+
+	// Table of min / avg / p99 over the last kHistory frames per pass.
+	// Formatted into a buffer the profiler keeps, so building it every frame
+	// does not allocate; valid until the next call
+	const char * getReport() const;
+
+	// Starts or stops streaming to profile_<name>_<timestamp>.csv
+	void toggleRecording();
+	bool isRecording() const { return csv.is_open(); }
+
+	void setSampleCallback(SampleCallback callback) { onSample = std::move(callback); }
+	const string & getName() const { return name; }
+
+	static const int kHistory = 240;
+	static const int kReportSize = 4096;
+
+private:
+	class RollingStats {
+	public:
+		void add(float value);
+		bool empty() const { return count == 0; }
+		float getMin() const;
+		float getAverage() const;
+		float getPercentile(float p) const;
+
+	private:
+		float samples[kHistory] = {};
+		mutable float sorted[kHistory]; // scratch for getPercentile()
+		int next = 0;
+		int count = 0;
+	};
+
+	struct Frame {
+		GLuint query = 0;
+		bool issued = false;
+		float cpuMs = -1.0f;
+	};
+
+	struct Pass {
+		string name;
+		Frame frames[2];
+		uint64_t cpuStart = 0;
+		bool gpuActive = false;
+		RollingStats cpu;
+		RollingStats gpu;
+	};
+
+	string name;
+	vector<Pass> passes;
+	uint64_t frameNumber = 0;
+	int activeQueries = 0;
+	std::ofstream csv;
+	string csvPath;
+	SampleCallback onSample;
+	mutable char report[kReportSize];
+
+	Pass & getPass(const string & pass);
+	void collect(Pass & pass, Frame & frame, uint64_t frameOfResult);
+};
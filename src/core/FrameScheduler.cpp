@@ -0,0 +1,280 @@
+#include "FrameScheduler.h"
+#include "core/AppClock.h"
+#include "ofAppGLFWWindow.h"
+#include "utils/GlThread.h"
+#include "utils/TaskSystem.h"
+#include "utils/Trace.h"
+#include <thread>
+
+//--------------------------------------------------------------
+FrameScheduler::Screen & FrameScheduler::addScreen(const string & name, shared_ptr<ofAppBaseWindow> window) {
+	screens.emplace_back();
+	screens.back().name = name;
+	screens.back().window = window;
+	return screens.back();
+}
+
+//--------------------------------------------------------------
+void FrameScheduler::sortScreens() {
+	// Kahn's algorithm over producer -> consumer edges, always taking the
+	// earliest registered screen that is ready
+	size_t count = screens.size();
+	vector<vector<size_t>> consumersOf(count);
+	vector<int> pendingProducers(count, 0);
+	for (auto & screen : screens) {
+		screen.producers.clear();
+	}
+	for (size_t p = 0; p < count; p++) {
+		for (size_t c = 0; c < count; c++) {
+			if (p == c) continue;
+			bool feeds = false;
+			for (DataChannel channel : screens[p].produced) {
+				for (const auto & consumption : screens[c].consumed) {
+					feeds = feeds || consumption.channel == channel;
+				}
+			}
+			if (feeds) {
+				consumersOf[p].push_back(c);
+				pendingProducers[c]++;
+				screens[c].producers.push_back(p);
+			}
+		}
+	}
+
+	order.clear();
+	vector<bool> placed(count, false);
+	while (order.size() < count) {
+		size_t next = count;
+		for (size_t i = 0; i < count && next == count; i++) {
+			if (!placed[i] && pendingProducers[i] == 0) next = i;
+		}
+		if (next == count) {
+			ofLogWarning("FrameScheduler") << "Dependency cycle between screens, keeping registration order for the rest";
+			for (size_t i = 0; i < count; i++) {
+				if (!placed[i]) order.push_back(i);
+			}
+			break;
+		}
+		placed[next] = true;
+		order.push_back(next);
+		for (size_t c : consumersOf[next]) {
+			pendingProducers[c]--;
+		}
+	}
+
+	string names;
+	for (size_t i : order) {
+		names += (names.empty() ? "" : " -> ") + screens[i].name;
+	}
+	ofLogNotice("FrameScheduler") << "Screen order: " << names;
+}
+
+//--------------------------------------------------------------
+bool FrameScheduler::isVisible(const Screen & screen) const {
+	auto glfwWindow = std::dynamic_pointer_cast<ofAppGLFWWindow>(screen.window);
+	if (!glfwWindow) glfwWindow = std::dynamic_pointer_cast<ofAppGLFWWindow>(presentWindow);
+	if (!glfwWindow) return true;
+
+	GLFWwindow * window = glfwWindow->getGLFWWindow();
+	return glfwGetWindowAttrib(window, GLFW_VISIBLE) && !glfwGetWindowAttrib(window, GLFW_ICONIFIED);
+}
+
+//--------------------------------------------------------------
+bool FrameScheduler::isWanted(const Screen & screen) const {
+	DataManager & dataManager = DataManager::getInstance();
+	for (DataChannel channel : screen.produced) {
+		if (dataManager.isChannelWanted(channel)) return true;
+	}
+	return false;
+}
+
+//--------------------------------------------------------------
+void FrameScheduler::updateChannelDemand() {
+	// A channel is wanted while a consumer that will run reads it
+	bool wanted[CHANNEL_COUNT] = {};
+	bool produced[CHANNEL_COUNT] = {};
+	for (const auto & screen : screens) {
+		for (DataChannel channel : screen.produced) {
+			produced[channel] = true;
+		}
+		if (!renderHidden && !isVisible(screen)) continue;
+		for (const auto & consumption : screen.consumed) {
+			if (!consumption.isActive || consumption.isActive()) {
+				wanted[consumption.channel] = true;
+			}
+		}
+	}
+
+	DataManager & dataManager = DataManager::getInstance();
+	for (int channel = 0; channel < CHANNEL_COUNT; channel++) {
+		if (produced[channel]) {
+			dataManager.setChannelWanted((DataChannel)channel, wanted[channel]);
+		}
+	}
+}
+
+//--------------------------------------------------------------
+uint64_t FrameScheduler::getPeriodMicros(const Screen & screen) const {
+	return screen.rateHz > 0.0f ? (uint64_t)(1e6 / screen.rateHz) : 0;
+}
+
+//--------------------------------------------------------------
+void FrameScheduler::tick(uint64_t now) {
+	updateChannelDemand();
+
+	due.clear();
+	for (size_t index : order) {
+		Screen & screen = screens[index];
+
+		uint64_t period = getPeriodMicros(screen);
+		if (period > 0) {
+			if (now < screen.nextDueMicros) continue;
+			// Keep a steady cadence, but do not try to catch up after a stall
+			screen.nextDueMicros = now - screen.nextDueMicros > period ? now + period : screen.nextDueMicros + period;
+		}
+
+		// GLFW windows are shown by their first update(), so it always runs
+		bool visible = renderHidden || isVisible(screen);
+		if (!visible && !isWanted(screen) && screen.updates > 0) continue;
+
+		screen.drawThisTick = visible;
+		due.push_back(index);
+	}
+
+	runCpuPhases();
+
+	auto mainLoop = ofGetMainLoop();
+	bool drew = false;
+	for (size_t index : due) {
+		Screen & screen = screens[index];
+		mainLoop->setCurrentWindow(screen.window);
+		screen.window->makeCurrent();
+		screen.window->update();
+		screen.updates++;
+		if (screen.drawThisTick) {
+			screen.window->draw();
+			screen.draws++;
+			drew = true;
+		}
+	}
+
+	present(drew);
+}
+
+//--------------------------------------------------------------
+void FrameScheduler::present(bool drew) {
+	// Screens that were not due keep their last image in their viewport
+	if (!presentWindow || (!drew && presentShown)) return;
+	TRACE_SCOPE("FrameScheduler", "present");
+
+	auto mainLoop = ofGetMainLoop();
+	mainLoop->setCurrentWindow(presentWindow);
+	presentWindow->makeCurrent();
+	// The first update() shows the window, even before anything drew
+	presentWindow->update();
+	presentShown = true;
+	if (drew) {
+		presentWindow->draw();
+		presents++;
+	}
+}
+
+//--------------------------------------------------------------
+void FrameScheduler::runCpuPhases() {
+	TRACE_SCOPE("FrameScheduler", "cpuPhases");
+	auto mainLoop = ofGetMainLoop();
+	TaskSystem & tasks = TaskSystem::get();
+
+	for (auto & screen : screens) {
+		screen.cpuTask = TaskSystem::Handle();
+	}
+
+	vector<TaskSystem::Handle> handles;
+	for (size_t index : due) {
+		Screen & screen = screens[index];
+		if (!screen.cpuPhase) continue;
+
+		// Captured here: ofGetLastFrameTime() and the window size go through
+		// the main loop's current window, which workers must not touch
+		mainLoop->setCurrentWindow(screen.window);
+		CpuFrame frame;
+		frame.time = AppClock::getElapsedTimef();
+		frame.deltaTime = AppClock::getLastFrameTime();
+		frame.width = screen.window->getWidth();
+		frame.height = screen.window->getHeight();
+		frame.frame = screen.updates;
+
+		// Producers that are not due this tick published earlier; nothing to wait for
+		vector<TaskSystem::Handle> dependencies;
+		for (size_t producer : screen.producers) {
+			if (screens[producer].cpuTask.isValid()) dependencies.push_back(screens[producer].cpuTask);
+		}
+
+		PhasedScreen * phase = screen.cpuPhase;
+		auto task = [phase, frame]() {
+			GlThread::CpuPhase scope;
+			phase->updateCpu(frame);
+		};
+		screen.cpuTask = tasks.submit(task, dependencies);
+		handles.push_back(screen.cpuTask);
+	}
+
+	// The main thread helps instead of idling
+	tasks.waitAll(handles);
+}
+
+//--------------------------------------------------------------
+int FrameScheduler::run() {
+	sortScreens();
+	for (auto & screen : screens) {
+		// Pacing happens here; OF's per-window limiter would sleep inside draw()
+		screen.window->events().setFrameRate(0);
+	}
+	if (presentWindow) presentWindow->events().setFrameRate(0);
+
+	auto mainLoop = ofGetMainLoop();
+	while (true) {
+		bool closing = false;
+		for (const auto & screen : screens) {
+			closing = closing || screen.window->getWindowShouldClose();
+		}
+		closing = closing || (presentWindow && presentWindow->getWindowShouldClose());
+		if (closing) break;
+
+		// GL-affine continuations posted by tasks since the last tick; the
+		// screens share one context, so any window's will do
+		if (!screens.empty()) screens.front().window->makeCurrent();
+		TaskSystem::get().runMainThreadTasks();
+		tick(ofGetElapsedTimeMicros());
+		ofNotifyEvent(mainLoop->loopEvent);
+		mainLoop->pollEvents();
+
+		// Sleep until the next screen is due; uncapped screens never wait
+		uint64_t nextDue = std::numeric_limits<uint64_t>::max();
+		for (const auto & screen : screens) {
+			nextDue = std::min(nextDue, getPeriodMicros(screen) > 0 ? screen.nextDueMicros : 0);
+		}
+		uint64_t now = ofGetElapsedTimeMicros();
+		if (nextDue > now) {
+			std::this_thread::sleep_for(std::chrono::microseconds(nextDue - now));
+		}
+	}
+
+	ofLogNotice("FrameScheduler") << getStatus();
+	mainLoop->exit();
+	return 0;
+}
+
+//--------------------------------------------------------------
+string FrameScheduler::getStatus() const {
+	string status;
+	for (size_t index : order) {
+		const Screen & screen = screens[index];
+		status += screen.name + " (" + (screen.rateHz > 0.0f ? ofToString(screen.rateHz, 0) + " Hz" : "uncapped") + "): "
+			+ ofToString(screen.updates) + " updates, " + ofToString(screen.draws) + " draws\n";
+	}
+	if (presentWindow) {
+		status += "Single window: " + ofToString(presents) + " presents\n";
+	}
+	return status;
+}
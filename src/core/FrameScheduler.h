@@ -0,0 +1,112 @@
+#pragma once
+#include "core/DataManager.h"
+#include "core/FramePhases.h"
+#include "ofMain.h"
+#include "utils/TaskSystem.h"
+#include <deque>
+#include <functional>
+
+// Replaces ofRunMainLoop for the three screens. Each screen declares the
+// DataManager channels it produces and consumes; every tick runs the
+// screens that are due in dependency order (producers before consumers),
+// so a consumer always sees what its producers published in the same tick.
+//
+// A tick has two phases. First the CPU phase of every due screen that has
+// one (setCpuPhase) runs on the TaskSystem: independent screens in
+// parallel, each consumer after its producers. Then, on the context
+// thread and in dependency order, each screen's update() (its GL phase)
+// and draw().
+//
+// Per screen:
+// - a target rate (0 = every tick); the loop sleeps until the next screen
+//   is due instead of spinning at the fastest window's rate
+// - draw() is skipped while the window is iconified or hidden (GLFW cannot
+//   report occlusion by other windows, so that case still renders)
+// - update() is skipped too when, in addition, none of its channels is wanted
+// Each tick first runs the continuations queued with
+// TaskSystem::postToMain(), with the first screen's GL context current.
+// Before the screens run, each channel is marked wanted in DataManager if
+// an active consumer reads it; producers skip the passes nobody reads.
+class FrameScheduler {
+public:
+	using ActivePredicate = std::function<bool()>;
+
+	class Screen {
+	public:
+		Screen & setRate(float hz) {
+			rateHz = std::max(0.0f, hz);
+			return *this;
+		}
+		Screen & produces(DataChannel channel) {
+			produced.push_back(channel);
+			return *this;
+		}
+		// isActive (optional) tells whether the channel is read right now
+		Screen & consumes(DataChannel channel, ActivePredicate isActive = nullptr) {
+			consumed.push_back({ channel, std::move(isActive) });
+			return *this;
+		}
+		// The app's CPU half of update(); must outlive the scheduler
+		Screen & setCpuPhase(PhasedScreen * phase) {
+			cpuPhase = phase;
+			return *this;
+		}
+
+	private:
+		friend class FrameScheduler;
+		struct Consumption {
+			DataChannel channel;
+			ActivePredicate isActive;
+		};
+
+		string name;
+		shared_ptr<ofAppBaseWindow> window;
+		float rateHz = 0.0f;
+		vector<DataChannel> produced;
+		vector<Consumption> consumed;
+		PhasedScreen * cpuPhase = nullptr;
+		vector<size_t> producers; // indices of the screens this one consumes from
+		bool drawThisTick = false;
+		TaskSystem::Handle cpuTask;
+		uint64_t nextDueMicros = 0;
+		uint64_t updates = 0;
+		uint64_t draws = 0;
+	};
+
+	// Registration order is kept wherever dependencies allow it; the
+	// returned reference stays valid for chaining the declarations
+	Screen & addScreen(const string & name, shared_ptr<ofAppBaseWindow> window);
+
+	// Draw hidden windows as well (benchmark runs use hidden windows)
+	void setRenderHidden(bool render) { renderHidden = render; }
+
+	// Single-window mode: the screens draw offscreen into viewports of this
+	// window (see DisplayManager), which is updated and drawn, composing and
+	// swapping once, after every tick in which any screen drew. Its
+	// visibility stands in for that of the screens' stand-in windows.
+	void setPresentWindow(shared_ptr<ofAppBaseWindow> window) { presentWindow = window; }
+
+	// Runs until a window is closed or ofExit() is called, then shuts the
+	// apps down like ofRunMainLoop does
+	int run();
+
+	string getStatus() const;
+
+private:
+	std::deque<Screen> screens;
+	vector<size_t> order;
+	vector<size_t> due; // this tick's screens, in order
+	bool renderHidden = false;
+	shared_ptr<ofAppBaseWindow> presentWindow;
+	bool presentShown = false;
+	uint64_t presents = 0;
+
+	void sortScreens();
+	void updateChannelDemand();
+	void tick(uint64_t now);
+	void runCpuPhases();
+	void present(bool drew);
+	bool isVisible(const Screen & screen) const;
+	bool isWanted(const Screen & screen) const;
+	uint64_t getPeriodMicros(const Screen & screen) const;
+};
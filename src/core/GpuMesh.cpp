@@ -0,0 +1,103 @@
+#include "GpuMesh.h"
+#include "UploadService.h"
+#include "utils/GlThread.h"
+
+//--------------------------------------------------------------
+std::shared_ptr<GpuMesh> GpuMesh::create(const ofMesh & mesh, ReadyCallback onReady) {
+	GL_THREAD_CHECK();
+	auto gpuMesh = std::make_shared<GpuMesh>();
+	gpuMesh->primitive = ofGetGLPrimitiveMode(mesh.getMode());
+	gpuMesh->numVertices = (int)mesh.getNumVertices();
+	gpuMesh->numIndices = (int)mesh.getNumIndices();
+	gpuMesh->onReady = std::move(onReady);
+
+	// All buffers exist before the first fill is queued, so a synchronous
+	// UploadService cannot finish the mesh halfway
+	vector<std::pair<ofBufferObject *, size_t>> buffers = {
+		{ &gpuMesh->vertexBuffer, mesh.getNumVertices() * sizeof(glm::vec3) },
+		{ &gpuMesh->normalBuffer, mesh.getNumNormals() * sizeof(glm::vec3) },
+		{ &gpuMesh->colorBuffer, mesh.getNumColors() * sizeof(ofFloatColor) },
+		{ &gpuMesh->texCoordBuffer, mesh.getNumTexCoords() * sizeof(glm::vec2) },
+		{ &gpuMesh->indexBuffer, mesh.getNumIndices() * sizeof(ofIndexType) },
+	};
+	for (auto & buffer : buffers) {
+		if (buffer.second == 0) continue;
+		buffer.first->allocate(buffer.second, GL_STATIC_DRAW);
+		gpuMesh->pendingUploads++;
+	}
+	// The upload context only sees the new buffer objects once this one flushed
+	glFlush();
+
+	if (gpuMesh->pendingUploads == 0) {
+		gpuMesh->pendingUploads = 1;
+		gpuMesh->onFilled();
+		return gpuMesh;
+	}
+
+	gpuMesh->queueFill(gpuMesh, "meshVertices", gpuMesh->vertexBuffer, mesh.getVertices());
+	gpuMesh->queueFill(gpuMesh, "meshNormals", gpuMesh->normalBuffer, mesh.getNormals());
+	gpuMesh->queueFill(gpuMesh, "meshColors", gpuMesh->colorBuffer, mesh.getColors());
+	gpuMesh->queueFill(gpuMesh, "meshTexCoords", gpuMesh->texCoordBuffer, mesh.getTexCoords());
+	gpuMesh->queueFill(gpuMesh, "meshIndices", gpuMesh->indexBuffer, mesh.getIndices());
+	return gpuMesh;
+}
+
+//--------------------------------------------------------------
+template <typename T>
+void GpuMesh::queueFill(const std::shared_ptr<GpuMesh> & self, const char * name, ofBufferObject & buffer,
+	const vector<T> & data) {
+	if (data.empty()) return;
+	UploadService::get().fillBuffer(name, buffer.getId(), data, [self](GLuint) { self->onFilled(); });
+}
+
+//--------------------------------------------------------------
+void GpuMesh::onFilled() {
+	if (--pendingUploads > 0) return;
+
+	// Attributes at OF's default locations, as ofVboMesh would set them
+	if (vertexBuffer.isAllocated()) vbo.setVertexBuffer(vertexBuffer, 3, sizeof(glm::vec3));
+	if (normalBuffer.isAllocated()) vbo.setNormalBuffer(normalBuffer, sizeof(glm::vec3));
+	if (colorBuffer.isAllocated()) vbo.setColorBuffer(colorBuffer, sizeof(ofFloatColor));
+	if (texCoordBuffer.isAllocated()) vbo.setTexCoordBuffer(texCoordBuffer, sizeof(glm::vec2));
+	if (indexBuffer.isAllocated()) vbo.setIndexBuffer(indexBuffer);
+	ready = true;
+
+	// Cleared before the call: it may hold the last other reference to this mesh
+	ReadyCallback callback = std::move(onReady);
+	onReady = nullptr;
+	if (callback) callback();
+}
+
+//--------------------------------------------------------------
+void GpuMesh::drawPrimitives(GLenum mode) const {
+	if (numIndices > 0) {
+		vbo.drawElements(mode, numIndices);
+	} else {
+		vbo.draw(mode, 0, numVertices);
+	}
+}
+
+//--------------------------------------------------------------
+void GpuMesh::draw() const {
+	if (!ready) return;
+	drawPrimitives(primitive);
+}
+
+//--------------------------------------------------------------
+void GpuMesh::drawWireframe() const {
+	if (!ready) return;
+	// What ofVboMesh::drawWireframe() does on desktop GL
+	glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+	drawPrimitives(primitive);
+	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+}
+
+//--------------------------------------------------------------
+void GpuMesh::drawInstanced(int instanceCount) const {
+	if (!ready || instanceCount <= 0) return;
+	if (numIndices > 0) {
+		vbo.drawElementsInstanced(primitive, numIndices, instanceCount);
+	} else {
+		vbo.drawInstanced(primitive, 0, numVertices, instanceCount);
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include "ofMain.h"
+#include <functional>
+#include <memory>
+
+// Draw-only GPU copy of an ofMesh whose vertex data is uploaded on the
+// UploadService thread instead of in the first draw(), as ofVboMesh does.
+// create() allocates empty buffer objects (cheap, no data crosses the bus)
+// and queues one fill per attribute; once all have landed, the mesh
+// becomes ready and onReady runs on the main thread. Until then the draw
+// calls do nothing, so callers keep drawing whatever they had before.
+//
+// Handed out as shared_ptr: the pending uploads keep the mesh alive, so a
+// caller can drop one that is superseded before it is ready.
+class GpuMesh {
+public:
+	using ReadyCallback = std::function<void()>;
+
+	// Render thread; the mesh's positions, normals, colours, texture
+	// coordinates and indices are copied
+	static std::shared_ptr<GpuMesh> create(const ofMesh & mesh, ReadyCallback onReady = nullptr);
+
+	bool isReady() const { return ready; }
+	int getNumVertices() const { return numVertices; }
+	int getNumIndices() const { return numIndices; }
+
+	void draw() const;
+	void drawWireframe() const;
+	void drawInstanced(int instanceCount) const;
+
+private:
+	ofVbo vbo;
+	ofBufferObject vertexBuffer;
+	ofBufferObject normalBuffer;
+	ofBufferObject colorBuffer;
+	ofBufferObject texCoordBuffer;
+	ofBufferObject indexBuffer;
+	GLenum primitive = GL_TRIANGLES;
+	int numVertices = 0;
+	int numIndices = 0;
+
+	int pendingUploads = 0;
+	bool ready = false;
+	ReadyCallback onReady;
+
+	template <typename T>
+	void queueFill(const std::shared_ptr<GpuMesh> & self, const char * name, ofBufferObject & buffer,
+		const vector<T> & data);
+	void onFilled();
+	void drawPrimitives(GLenum mode) const;
+};
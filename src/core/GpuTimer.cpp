@@ -0,0 +1,59 @@
+#include "GpuTimer.h"
+#include "utils/GlThread.h"
+
+//--------------------------------------------------------------
+GpuTimer::GpuTimer(int ringSize)
+	: slots(std::max(1, ringSize)) {
+}
+
+//--------------------------------------------------------------
+GpuTimer::~GpuTimer() {
+	for (auto & slot : slots) {
+		if (slot.queries[0]) glDeleteQueries(2, slot.queries);
+	}
+}
+
+//--------------------------------------------------------------
+void GpuTimer::begin() {
+	GL_THREAD_CHECK();
+	activeSlot = -1;
+	Slot & slot = slots[nextSlot];
+	if (slot.pending) return;
+
+	if (slot.queries[0] == 0) glGenQueries(2, slot.queries);
+	glQueryCounter(slot.queries[0], GL_TIMESTAMP);
+	activeSlot = (int)nextSlot;
+	nextSlot = (nextSlot + 1) % slots.size();
+}
+
+//--------------------------------------------------------------
+void GpuTimer::end() {
+	if (activeSlot < 0) return;
+	Slot & slot = slots[activeSlot];
+	glQueryCounter(slot.queries[1], GL_TIMESTAMP);
+	slot.pending = true;
+	activeSlot = -1;
+}
+
+//--------------------------------------------------------------
+bool GpuTimer::poll() {
+	bool updated = false;
+	// Oldest first; a slot's end query finishing implies its begin did too
+	for (size_t i = 0; i < slots.size(); i++) {
+		Slot & slot = slots[(nextSlot + i) % slots.size()];
+		if (!slot.pending) continue;
+
+		GLint available = 0;
+		glGetQueryObjectiv(slot.queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available) break;
+
+		GLuint64 start = 0, stop = 0;
+		glGetQueryObjectui64v(slot.queries[0], GL_QUERY_RESULT, &start);
+		glGetQueryObjectui64v(slot.queries[1], GL_QUERY_RESULT, &stop);
+		lastMs = (stop - start) / 1000000.0f;
+		slot.pending = false;
+		resultCount++;
+		updated = true;
+	}
+	return updated;
+}
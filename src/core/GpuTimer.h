@@ -0,0 +1,34 @@
+#pragma once
+#include "ofMain.h"
+
+// Measures GPU time between begin() and end() with GL_TIMESTAMP queries.
+// Results are read back a few frames later from a small ring, only once
+// GL_QUERY_RESULT_AVAILABLE says so, so measuring never stalls the GPU.
+// Timestamps (unlike GL_TIME_ELAPSED) may overlap other timers.
+class GpuTimer {
+public:
+	explicit GpuTimer(int ringSize = 4);
+	~GpuTimer();
+
+	// Skipped (no measurement this frame) while every slot is still in flight
+	void begin();
+	void end();
+
+	// Collects finished measurements; returns true if a new one arrived
+	bool poll();
+
+	float getLastMs() const { return lastMs; }
+	bool hasResult() const { return resultCount > 0; }
+
+private:
+	struct Slot {
+		GLuint queries[2] = { 0, 0 };
+		bool pending = false;
+	};
+
+	vector<Slot> slots;
+	size_t nextSlot = 0;
+	int activeSlot = -1;
+	float lastMs = 0.0f;
+	uint64_t resultCount = 0;
+};
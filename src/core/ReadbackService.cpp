@@ -0,0 +1,194 @@
+#include "ReadbackService.h"
+#include "utils/GlThread.h"
+#include "utils/HotLog.h"
+#include "utils/Trace.h"
+
+namespace {
+
+// Image encoding takes longer than a frame, so it runs off the render thread
+template <typename PixelsType>
+TaskSystem::Handle saveInBackground(PixelsType & pixels, const string & path) {
+	return TaskSystem::get().submitBackground([pixels = std::move(pixels), path]() {
+		TRACE_SCOPE("ReadbackService", "save");
+		if (ofSaveImage(pixels, path)) {
+			ofLogNotice("ReadbackService") << "Saved " << path;
+		} else {
+			ofLogError("ReadbackService") << "Could not save " << path;
+		}
+	});
+}
+
+}
+
+//--------------------------------------------------------------
+ReadbackService::ReadbackService(int ringSize)
+	: slots(std::max(1, ringSize)) {
+}
+
+//--------------------------------------------------------------
+ReadbackService::~ReadbackService() {
+	// Saves still encoding hold no GL state, but must finish before exit
+	TaskSystem::get().waitAll(saveTasks);
+	for (auto & slot : slots) {
+		if (slot.fence) glDeleteSync(slot.fence);
+		if (slot.buffer) glDeleteBuffers(1, &slot.buffer);
+	}
+	if (readFramebuffer) glDeleteFramebuffers(1, &readFramebuffer);
+}
+
+//--------------------------------------------------------------
+bool ReadbackService::request(const ofTexture & texture, PixelsCallback callback, ofRectangle region) {
+	Slot * slot = nullptr;
+	if (!enqueue(texture, region, GL_UNSIGNED_BYTE, slot)) return false;
+	slot->onPixels = std::move(callback);
+	return true;
+}
+
+//--------------------------------------------------------------
+bool ReadbackService::requestFloat(const ofTexture & texture, FloatPixelsCallback callback, ofRectangle region) {
+	Slot * slot = nullptr;
+	if (!enqueue(texture, region, GL_FLOAT, slot)) return false;
+	slot->onFloatPixels = std::move(callback);
+	return true;
+}
+
+//--------------------------------------------------------------
+bool ReadbackService::requestSave(const ofTexture & texture, const string & path, ofRectangle region) {
+	return request(texture, [this, path](ofPixels & pixels) { trackSave(saveInBackground(pixels, path)); }, region);
+}
+
+//--------------------------------------------------------------
+bool ReadbackService::requestSaveFloat(const ofTexture & texture, const string & path) {
+	return requestFloat(texture, [this, path](ofFloatPixels & pixels) { trackSave(saveInBackground(pixels, path)); });
+}
+
+//--------------------------------------------------------------
+void ReadbackService::trackSave(TaskSystem::Handle handle) {
+	auto isDone = [](const TaskSystem::Handle & task) { return task.isDone(); };
+	saveTasks.erase(std::remove_if(saveTasks.begin(), saveTasks.end(), isDone), saveTasks.end());
+	saveTasks.push_back(std::move(handle));
+}
+
+//--------------------------------------------------------------
+ReadbackService::Slot * ReadbackService::acquireSlot() {
+	// Slots are used in ring order, so the next one is also the oldest
+	Slot & slot = slots[nextSlot];
+	if (slot.fence) return nullptr;
+	nextSlot = (nextSlot + 1) % slots.size();
+	return &slot;
+}
+
+//--------------------------------------------------------------
+bool ReadbackService::enqueue(const ofTexture & texture, ofRectangle region, GLenum type, Slot *& outSlot) {
+	GL_THREAD_CHECK();
+	if (!texture.isAllocated()) return false;
+
+	const ofTextureData & data = texture.getTextureData();
+	if (region.isEmpty()) {
+		region.set(0, 0, data.width, data.height);
+	}
+	int x = std::max(0, (int)region.x);
+	int y = std::max(0, (int)region.y);
+	int w = std::min((int)region.width, (int)data.width - x);
+	int h = std::min((int)region.height, (int)data.height - y);
+	if (w <= 0 || h <= 0) return false;
+
+	Slot * slot = acquireSlot();
+	if (!slot) {
+		droppedCount++;
+		HOT_LOG_WARNING("ReadbackService", 1.0f, "All %d readback slots in flight, request dropped", (int)slots.size());
+		return false;
+	}
+
+	size_t bytes = (size_t)w * h * 4 * (type == GL_FLOAT ? sizeof(float) : 1);
+	if (slot->buffer == 0) glGenBuffers(1, &slot->buffer);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->buffer);
+	if (bytes > slot->capacity) {
+		glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+		slot->capacity = bytes;
+	}
+
+	// Copy into the PBO through a read framebuffer; this only queues the
+	// transfer, the pixels are not touched on the CPU until the fence signals
+	if (readFramebuffer == 0) glGenFramebuffers(1, &readFramebuffer);
+	GLint previousReadFramebuffer = 0;
+	glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousReadFramebuffer);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, readFramebuffer);
+	glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, data.textureTarget, data.textureID, 0);
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	GLint previousPackAlignment = 4;
+	glGetIntegerv(GL_PACK_ALIGNMENT, &previousPackAlignment);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(x, y, w, h, GL_RGBA, type, nullptr);
+	glPixelStorei(GL_PACK_ALIGNMENT, previousPackAlignment);
+	glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, data.textureTarget, 0, 0);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, previousReadFramebuffer);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	slot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	slot->width = w;
+	slot->height = h;
+	slot->type = type;
+	slot->frame = ofGetFrameNum();
+	slot->onPixels = nullptr;
+	slot->onFloatPixels = nullptr;
+
+	outSlot = slot;
+	return true;
+}
+
+//--------------------------------------------------------------
+void ReadbackService::update() {
+	GL_THREAD_CHECK();
+	// Deliver in request order; stop at the first one still in flight
+	for (size_t i = 0; i < slots.size(); i++) {
+		Slot & slot = slots[(nextSlot + i) % slots.size()];
+		if (!slot.fence) continue;
+
+		GLenum status = glClientWaitSync(slot.fence, 0, 0);
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) break;
+
+		deliver(slot);
+		release(slot);
+	}
+}
+
+//--------------------------------------------------------------
+void ReadbackService::deliver(Slot & slot) {
+	size_t bytes = (size_t)slot.width * slot.height * 4 * (slot.type == GL_FLOAT ? sizeof(float) : 1);
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+	void * mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, GL_MAP_READ_BIT);
+	if (mapped) {
+		if (slot.type == GL_FLOAT && slot.onFloatPixels) {
+			ofFloatPixels pixels;
+			pixels.setFromPixels(static_cast<const float *>(mapped), slot.width, slot.height, OF_PIXELS_RGBA);
+			slot.onFloatPixels(pixels);
+		} else if (slot.type == GL_UNSIGNED_BYTE && slot.onPixels) {
+			ofPixels pixels;
+			pixels.setFromPixels(static_cast<const unsigned char *>(mapped), slot.width, slot.height, OF_PIXELS_RGBA);
+			slot.onPixels(pixels);
+		}
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	} else {
+		ofLogError("ReadbackService") << "Could not map readback buffer from frame " << slot.frame;
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+//--------------------------------------------------------------
+void ReadbackService::release(Slot & slot) {
+	glDeleteSync(slot.fence);
+	slot.fence = nullptr;
+	slot.onPixels = nullptr;
+	slot.onFloatPixels = nullptr;
+}
+
+//--------------------------------------------------------------
+int ReadbackService::getPendingCount() const {
+	int count = 0;
+	for (const auto & slot : slots) {
+		if (slot.fence) count++;
+	}
+	return count;
+}
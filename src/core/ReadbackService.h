@@ -0,0 +1,62 @@
+#pragma once
+#include "ofMain.h"
+#include "utils/TaskSystem.h"
+#include <functional>
+
+// Asynchronous GPU -> CPU texture readback through a ring of pixel buffer
+// objects. request() only queues the copy into a PBO and fences it; update()
+// polls the fences without waiting and hands finished pixels to the
+// callbacks, typically a frame or two later. Nothing here blocks on the GPU.
+//
+// One instance per GL context (the read framebuffer is not shared); all
+// calls and callbacks happen on that context's thread.
+class ReadbackService {
+public:
+	using PixelsCallback = std::function<void(ofPixels & pixels)>;
+	using FloatPixelsCallback = std::function<void(ofFloatPixels & pixels)>;
+
+	explicit ReadbackService(int ringSize = 3);
+	~ReadbackService();
+
+	// Reads region (whole texture if empty) as RGBA. Returns false when every
+	// slot is still in flight; the request is dropped instead of stalling.
+	bool request(const ofTexture & texture, PixelsCallback callback, ofRectangle region = ofRectangle());
+	bool requestFloat(const ofTexture & texture, FloatPixelsCallback callback, ofRectangle region = ofRectangle());
+
+	// Reads the texture (or region of it) and writes it to path (format from
+	// the extension, e.g. .png, or .exr for float) on a background thread
+	bool requestSave(const ofTexture & texture, const string & path, ofRectangle region = ofRectangle());
+	bool requestSaveFloat(const ofTexture & texture, const string & path);
+
+	// Delivers every readback whose fence has signaled; call once per frame
+	void update();
+
+	int getPendingCount() const;
+	int getDroppedCount() const { return droppedCount; }
+
+private:
+	struct Slot {
+		GLuint buffer = 0;
+		size_t capacity = 0;
+		GLsync fence = nullptr;
+		int width = 0;
+		int height = 0;
+		GLenum type = GL_UNSIGNED_BYTE;
+		uint64_t frame = 0;
+		PixelsCallback onPixels;
+		FloatPixelsCallback onFloatPixels;
+	};
+
+	vector<Slot> slots;
+	size_t nextSlot = 0;
+	GLuint readFramebuffer = 0;
+	int droppedCount = 0;
+	// Saves encoding on the TaskSystem, waited for by the destructor
+	vector<TaskSystem::Handle> saveTasks;
+
+	Slot * acquireSlot();
+	bool enqueue(const ofTexture & texture, ofRectangle region, GLenum type, Slot *& outSlot);
+	void deliver(Slot & slot);
+	void release(Slot & slot);
+	void trackSave(TaskSystem::Handle handle);
+};
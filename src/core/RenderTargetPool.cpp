@@ -0,0 +1,167 @@
+#include "RenderTargetPool.h"
+#include "ofAppGLFWWindow.h"
+#include "utils/GlThread.h"
+
+//--------------------------------------------------------------
+RenderTargetPool::Target::Target(Target && other)
+	: entry(other.entry)
+	, width(other.width)
+	, height(other.height)
+	, nativeRegion(other.nativeRegion) {
+	other.entry = nullptr;
+}
+
+//--------------------------------------------------------------
+RenderTargetPool::Target & RenderTargetPool::Target::operator=(Target && other) {
+	if (this != &other) {
+		release();
+		entry = other.entry;
+		width = other.width;
+		height = other.height;
+		nativeRegion = other.nativeRegion;
+		other.entry = nullptr;
+	}
+	return *this;
+}
+
+//--------------------------------------------------------------
+const ofTexture & RenderTargetPool::Target::getTexture() const {
+	return entry->fbo.getTexture();
+}
+
+//--------------------------------------------------------------
+void RenderTargetPool::Target::begin() {
+	entry->fbo.begin();
+	ofViewport(0, 0, width, height);
+	ofSetupScreenPerspective(width, height);
+	nativeRegion = ofGetNativeViewport();
+}
+
+//--------------------------------------------------------------
+void RenderTargetPool::Target::end() {
+	entry->fbo.end();
+}
+
+//--------------------------------------------------------------
+void RenderTargetPool::Target::draw(float x, float y, float w, float h) const {
+	// The rows begin() rendered into, wherever the viewport flip put them
+	entry->fbo.getTexture().drawSubsection(x, y, w, h, nativeRegion.x, nativeRegion.y, nativeRegion.width,
+		nativeRegion.height);
+}
+
+//--------------------------------------------------------------
+void RenderTargetPool::Target::release() {
+	if (!entry) return;
+	entry->inUse = false;
+	entry->lastUsedMicros = ofGetElapsedTimeMicros();
+	entry = nullptr;
+}
+
+//--------------------------------------------------------------
+RenderTargetPool & RenderTargetPool::get() {
+	// Never destroyed: by static destruction the contexts its FBOs belong
+	// to are gone
+	static RenderTargetPool * instance = new RenderTargetPool();
+	return *instance;
+}
+
+//--------------------------------------------------------------
+RenderTargetPool::Target RenderTargetPool::acquire(int width, int height, GLint internalFormat) {
+	GL_THREAD_CHECK();
+	void * context = glfwGetCurrentContext();
+	trim(context);
+
+	width = std::max(1, width);
+	height = std::max(1, height);
+	int bucketWidth = roundUp(width);
+	int bucketHeight = roundUp(height);
+
+	// The smallest free target that fits; much larger ones are left for
+	// the windows that need them
+	Entry * best = nullptr;
+	for (const auto & entry : entries) {
+		if (entry->inUse || entry->context != context || entry->internalFormat != internalFormat) continue;
+		if (entry->width < width || entry->height < height) continue;
+		if ((int64_t)entry->width * entry->height > 2 * (int64_t)bucketWidth * bucketHeight) continue;
+		if (!best || entry->width * entry->height < best->width * best->height) best = entry.get();
+	}
+
+	if (!best) {
+		entries.push_back(std::make_unique<Entry>());
+		best = entries.back().get();
+		best->context = context;
+		best->internalFormat = internalFormat;
+		best->width = bucketWidth;
+		best->height = bucketHeight;
+		best->fbo.allocate(bucketWidth, bucketHeight, internalFormat);
+		ofLogNotice("RenderTargetPool") << "Allocated " << bucketWidth << "x" << bucketHeight << " for "
+										<< width << "x" << height << "; " << entries.size() << " targets, "
+										<< getAllocatedBytes() / (1024 * 1024) << " MB";
+	}
+
+	best->inUse = true;
+	Target target;
+	target.entry = best;
+	target.width = width;
+	target.height = height;
+	return target;
+}
+
+//--------------------------------------------------------------
+void RenderTargetPool::trim(void * context) {
+	// Only targets of the current context can be deleted from here
+	uint64_t now = ofGetElapsedTimeMicros();
+	uint64_t idleMicros = (uint64_t)(kIdleSeconds * 1e6f);
+	size_t before = entries.size();
+	entries.erase(std::remove_if(entries.begin(), entries.end(), [&](const std::unique_ptr<Entry> & entry) {
+		return !entry->inUse && entry->context == context && now - entry->lastUsedMicros > idleMicros;
+	}),
+		entries.end());
+
+	if (entries.size() != before) {
+		ofLogNotice("RenderTargetPool") << "Freed " << before - entries.size() << " idle targets; " << entries.size()
+										<< " left, " << getAllocatedBytes() / (1024 * 1024) << " MB";
+	}
+}
+
+//--------------------------------------------------------------
+size_t RenderTargetPool::getAllocatedBytes() const {
+	size_t bytes = 0;
+	for (const auto & entry : entries) {
+		int colorBytes = entry->internalFormat == GL_RGBA32F ? 16 : (entry->internalFormat == GL_RGBA16F ? 8 : 4);
+		bytes += (size_t)entry->width * entry->height * (colorBytes + 4);
+	}
+	return bytes;
+}
+
+//--------------------------------------------------------------
+int RenderTargetPool::roundUp(int size) {
+	return (size + kGranularity - 1) / kGranularity * kGranularity;
+}
+
+//--------------------------------------------------------------
+bool ResizeDebouncer::update(int width, int height) {
+	if (settledWidth < 0) {
+		settledWidth = pendingWidth = width;
+		settledHeight = pendingHeight = height;
+		return false;
+	}
+	if (width == settledWidth && height == settledHeight) {
+		pendingWidth = width;
+		pendingHeight = height;
+		return false;
+	}
+
+	uint64_t now = ofGetElapsedTimeMicros();
+	if (width != pendingWidth || height != pendingHeight) {
+		pendingWidth = width;
+		pendingHeight = height;
+		pendingSinceMicros = now;
+		return false;
+	}
+	if (now - pendingSinceMicros < delayMicros) return false;
+
+	settledWidth = width;
+	settledHeight = height;
+	return true;
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include "ofMain.h"
+#include <memory>
+
+// Shared pool of transient render targets, the colour + depth FBOs a screen
+// needs only while it draws. acquire() hands out a free target at least the
+// requested size and the handle returns it when it goes out of scope, so
+// screens whose draws do not overlap (FrameScheduler draws them one after
+// another) render into the same memory. Targets are keyed by GL context as
+// well as format: FBO objects are not shared between contexts, so with three
+// windows each window recycles its own targets, while in single-window mode
+// the three screens share one.
+//
+// Sizes are rounded up to kGranularity, so a resize keeps using the same
+// target until the window outgrows it; the handle's begin() sets a viewport
+// on a corner of the requested size and draw() shows just that part. Targets
+// left unused for kIdleSeconds, such as the smaller ones a window drag
+// leaves behind, are freed by the next acquire() on their context.
+class RenderTargetPool {
+	struct Entry;
+
+public:
+	static const int kGranularity = 128;
+	static constexpr float kIdleSeconds = 1.0f;
+
+	class Target {
+	public:
+		Target() = default;
+		~Target() { release(); }
+		Target(Target && other);
+		Target & operator=(Target && other);
+		Target(const Target &) = delete;
+		Target & operator=(const Target &) = delete;
+
+		bool isValid() const { return entry != nullptr; }
+		int getWidth() const { return width; }
+		int getHeight() const { return height; }
+		// The part rendered into, in texels, for readbacks; set by begin()
+		ofRectangle getNativeRegion() const { return nativeRegion; }
+		const ofTexture & getTexture() const;
+
+		// Binds the target with a viewport and screen matrices for the
+		// requested size, as ofFbo::begin() does for its full size
+		void begin();
+		void end();
+		void draw(float x, float y, float w, float h) const;
+		// Gives the target back before the handle goes out of scope
+		void release();
+
+	private:
+		friend class RenderTargetPool;
+		Entry * entry = nullptr;
+		int width = 0;
+		int height = 0;
+		ofRectangle nativeRegion;
+	};
+
+	static RenderTargetPool & get();
+
+	// A free target of at least width x height for the current context
+	Target acquire(int width, int height, GLint internalFormat = GL_RGBA);
+
+	int getTargetCount() const { return (int)entries.size(); }
+	// Colour plus packed depth-stencil, an estimate
+	size_t getAllocatedBytes() const;
+
+private:
+	struct Entry {
+		ofFbo fbo;
+		void * context = nullptr;
+		GLint internalFormat = GL_RGBA;
+		int width = 0;
+		int height = 0;
+		bool inUse = false;
+		uint64_t lastUsedMicros = 0;
+	};
+
+	vector<std::unique_ptr<Entry>> entries;
+
+	void trim(void * context);
+	static int roundUp(int size);
+};
+
+// Reports a window size once it has held for delaySeconds, so reallocations
+// that depend on it run once at the end of a drag instead of at every step
+class ResizeDebouncer {
+public:
+	explicit ResizeDebouncer(float delaySeconds = 0.25f)
+		: delayMicros((uint64_t)(delaySeconds * 1e6f)) {
+	}
+
+	// True once for each size that settled; the first size seen counts as
+	// already settled
+	bool update(int width, int height);
+
+private:
+	uint64_t delayMicros;
+	int settledWidth = -1;
+	int settledHeight = -1;
+	int pendingWidth = -1;
+	int pendingHeight = -1;
+	uint64_t pendingSinceMicros = 0;
+};
@@ -0,0 +1,170 @@
+#include "UploadService.h"
+#include "ofAppGLFWWindow.h"
+#include "utils/TaskSystem.h"
+#include "utils/Trace.h"
+
+//--------------------------------------------------------------
+UploadService & UploadService::get() {
+	static UploadService instance;
+	return instance;
+}
+
+//--------------------------------------------------------------
+UploadService::~UploadService() {
+	shutdown();
+}
+
+//--------------------------------------------------------------
+bool UploadService::setup(shared_ptr<ofAppBaseWindow> shareWith) {
+	if (isThreaded()) return true;
+
+	auto glfwWindow = std::dynamic_pointer_cast<ofAppGLFWWindow>(shareWith);
+	if (!glfwWindow) {
+		ofLogWarning("UploadService") << "Not a GLFW window, uploads stay on the render thread";
+		return false;
+	}
+
+	// Same context version and profile as the render context, which the
+	// share group requires; hidden, it never presents anything
+	GLFWwindow * shared = glfwWindow->getGLFWWindow();
+	glfwDefaultWindowHints();
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, glfwGetWindowAttrib(shared, GLFW_CONTEXT_VERSION_MAJOR));
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, glfwGetWindowAttrib(shared, GLFW_CONTEXT_VERSION_MINOR));
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, glfwGetWindowAttrib(shared, GLFW_OPENGL_FORWARD_COMPAT));
+	int profile = glfwGetWindowAttrib(shared, GLFW_OPENGL_PROFILE);
+	if (profile != GLFW_OPENGL_ANY_PROFILE) glfwWindowHint(GLFW_OPENGL_PROFILE, profile);
+	context = glfwCreateWindow(1, 1, "upload", nullptr, shared);
+	glfwDefaultWindowHints();
+
+	if (!context) {
+		ofLogWarning("UploadService") << "Could not create a shared GL context, uploads stay on the render thread";
+		return false;
+	}
+
+	stopping = false;
+	thread = std::thread(&UploadService::threadLoop, this);
+	// Before the windows, and with them the share group, go away
+	ofAddListener(ofGetMainLoop()->exitEvent, this, &UploadService::onExit);
+	ofLogNotice("UploadService") << "Upload thread started with a shared GL context";
+	return true;
+}
+
+//--------------------------------------------------------------
+void UploadService::onExit() {
+	shutdown();
+}
+
+//--------------------------------------------------------------
+void UploadService::shutdown() {
+	if (!isThreaded()) return;
+	if (auto mainLoop = ofGetMainLoop()) {
+		ofRemoveListener(mainLoop->exitEvent, this, &UploadService::onExit);
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wakeCondition.notify_one();
+	thread.join();
+
+	glfwDestroyWindow(context);
+	context = nullptr;
+}
+
+//--------------------------------------------------------------
+void UploadService::submit(const char * name, std::function<GLuint()> upload, Callback onDone) {
+	if (!isThreaded()) {
+		TRACE_SCOPE("UploadService", name);
+		GLuint object = upload();
+		if (onDone) onDone(object);
+		return;
+	}
+
+	pendingCount++;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		jobs.push_back({ name, std::move(upload), std::move(onDone) });
+	}
+	wakeCondition.notify_one();
+}
+
+//--------------------------------------------------------------
+void UploadService::threadLoop() {
+	Trace::setThreadName("upload");
+	glfwMakeContextCurrent(context);
+
+	while (true) {
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wakeCondition.wait(lock, [this]() { return stopping || !jobs.empty(); });
+			// Jobs still queued at exit are dropped; nobody would use them
+			if (stopping) break;
+			job = std::move(jobs.front());
+			jobs.pop_front();
+		}
+
+		TRACE_SCOPE("UploadService", job.name);
+		GLuint object = job.upload();
+
+		// Wait here instead of on the render thread; the flush bit makes
+		// sure the fence is submitted at all
+		GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		GLenum status = GL_TIMEOUT_EXPIRED;
+		while (status == GL_TIMEOUT_EXPIRED) {
+			status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 100000000); // 100 ms
+		}
+		glDeleteSync(fence);
+		if (status == GL_WAIT_FAILED) {
+			ofLogError("UploadService") << job.name << ": waiting for the upload failed";
+		}
+
+		Callback onDone = std::move(job.onDone);
+		TaskSystem::get().postToMain([this, onDone, object]() {
+			pendingCount--;
+			if (onDone) onDone(object);
+		});
+	}
+
+	glfwMakeContextCurrent(nullptr);
+}
+
+//--------------------------------------------------------------
+GLuint UploadService::createBuffer(const void * data, size_t bytes) {
+	GLuint buffer = 0;
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glBufferData(GL_ARRAY_BUFFER, bytes, data, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	return buffer;
+}
+
+//--------------------------------------------------------------
+void UploadService::writeBuffer(GLuint buffer, const void * data, size_t bytes) {
+	// The copy-write target leaves the context's vertex bindings alone
+	glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, 0, bytes, data);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+//--------------------------------------------------------------
+void UploadService::uploadTexture3D(const char * name, std::vector<float> data, int width, int height, int depth,
+	GLint internalFormat, Callback onDone) {
+	auto holder = std::make_shared<std::vector<float>>(std::move(data));
+	submit(name, [holder, width, height, depth, internalFormat]() {
+		GLuint texture = 0;
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_3D, texture);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexImage3D(GL_TEXTURE_3D, 0, internalFormat, width, height, depth, 0, GL_RED, GL_FLOAT, holder->data());
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+		glBindTexture(GL_TEXTURE_3D, 0);
+		return texture;
+	},
+		std::move(onDone));
+}
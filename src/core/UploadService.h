@@ -0,0 +1,90 @@
+#pragma once
+#include "ofMain.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+struct GLFWwindow;
+
+// GPU uploads on a dedicated thread with its own GL context, shared with
+// the render context, so large buffers and textures do not stall a frame.
+// Each job creates a new GL object on the upload thread and fills it, or
+// fills one the render thread created (fillBuffer()); the thread fences the upload and waits for the fence, then hands the object
+// to the job's callback on the main thread (through
+// TaskSystem::postToMain(), which FrameScheduler runs at the start of every
+// tick). The callback owns the object from then on, typically swapping it
+// in for an older one and deleting that. Jobs finish in submission order.
+//
+// Without setup(), or if the shared context cannot be created, jobs run
+// synchronously on the calling thread, which must then be the context
+// thread, and the callback runs right away.
+class UploadService {
+public:
+	using Callback = std::function<void(GLuint object)>;
+
+	static UploadService & get();
+
+	UploadService() = default;
+	~UploadService();
+	UploadService(const UploadService &) = delete;
+	UploadService & operator=(const UploadService &) = delete;
+
+	// Main thread, once the windows exist; shareWith must be a GLFW window.
+	// The thread stops by itself before the main loop closes the windows.
+	bool setup(shared_ptr<ofAppBaseWindow> shareWith);
+	void shutdown();
+	bool isThreaded() const { return thread.joinable(); }
+
+	// New GL_STATIC_DRAW buffer object holding data. name is a string
+	// literal, used for trace markers
+	template <typename T>
+	void uploadBuffer(const char * name, std::vector<T> data, Callback onDone) {
+		auto holder = std::make_shared<std::vector<T>>(std::move(data));
+		submit(name, [holder]() { return createBuffer(holder->data(), holder->size() * sizeof(T)); }, std::move(onDone));
+	}
+
+	// Writes data into buffer, an existing buffer object at least that large,
+	// e.g. an ofBufferObject allocated without data on the render thread
+	// (which must flush before submitting). The callback gets buffer back
+	template <typename T>
+	void fillBuffer(const char * name, GLuint buffer, std::vector<T> data, Callback onDone) {
+		auto holder = std::make_shared<std::vector<T>>(std::move(data));
+		submit(name, [holder, buffer]() {
+			writeBuffer(buffer, holder->data(), holder->size() * sizeof(T));
+			return buffer;
+		},
+			std::move(onDone));
+	}
+
+	// New linear-filtered, edge-clamped 3D texture from single-channel data
+	void uploadTexture3D(const char * name, std::vector<float> data, int width, int height, int depth,
+		GLint internalFormat, Callback onDone);
+
+	// Jobs submitted whose callback has not run yet
+	int getPendingCount() const { return pendingCount; }
+
+private:
+	struct Job {
+		const char * name;
+		std::function<GLuint()> upload;
+		Callback onDone;
+	};
+
+	GLFWwindow * context = nullptr;
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable wakeCondition;
+	std::deque<Job> jobs;
+	bool stopping = false;
+	std::atomic<int> pendingCount { 0 };
+
+	void submit(const char * name, std::function<GLuint()> upload, Callback onDone);
+	void threadLoop();
+	void onExit();
+	static GLuint createBuffer(const void * data, size_t bytes);
+	static void writeBuffer(GLuint buffer, const void * data, size_t bytes);
+};
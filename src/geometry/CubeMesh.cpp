@@ -1,5 +1,8 @@
 
 #include "CubeMesh.h"
+#include "MeshOptimizer.h"
+#include "MeshProcessing.h"
+#include "utils/Trace.h"
 #include <algorithm>
 
 CubeMesh::CubeMesh() {
@@ -20,6 +23,7 @@ void CubeMesh::clear() {
 }
 
 void CubeMesh::generateMesh() {
+	TRACE_SCOPE("CubeMesh", "generateMesh");
 	clear();
 	createCubeMesh();
 	logMeshInfo();
@@ -72,6 +76,13 @@ void CubeMesh::createCubeMesh() {
 		vertexPoolData.vertexNormals.resize(vertexPoolData.vertexPool.size());
 	}
 
+	// Faces are emitted row by row, which thrashes the post-transform cache at
+	// high resolutions; reorder before the pool is copied into the mesh
+	acmrBefore = acmrAfter = MeshOptimizer::computeACMR(mesh.getIndices(), vertexPoolData.vertexPool.size());
+	if (config.optimizeVertexOrder) {
+		optimizeMeshOrder();
+	}
+
 	// ӹ㵽mesh
 	for (size_t i = 0; i < vertexPoolData.vertexPool.size(); i++) {
 		mesh.addVertex(vertexPoolData.vertexPool[i]);
@@ -133,6 +144,27 @@ int CubeMesh::getVertexIndexWithNormal(const ofVec3f & pos, const ofVec3f & norm
 	}
 }
 
+void CubeMesh::optimizeMeshOrder() {
+	size_t vertexCount = vertexPoolData.vertexPool.size();
+	MeshOptimizer::Result result = MeshOptimizer::optimize(mesh.getIndices(), vertexCount);
+	acmrBefore = result.acmrBefore;
+	acmrAfter = result.acmrAfter;
+
+	// Effects index originalVertices/vertexPool by mesh vertex, so every pool
+	// array and the position lookup follow the new order
+	MeshProcessing::remapAttribute(vertexPoolData.vertexPool, result.sourceVertex);
+	MeshProcessing::remapAttribute(vertexPoolData.originalVertices, result.sourceVertex);
+	MeshProcessing::remapAttribute(vertexPoolData.vertexNormals, result.sourceVertex);
+
+	std::vector<int> newIndex(vertexCount);
+	for (size_t i = 0; i < vertexCount; i++) {
+		newIndex[result.sourceVertex[i]] = (int)i;
+	}
+	for (auto & entry : vertexPoolData.vertexMap) {
+		entry.second = newIndex[entry.second];
+	}
+}
+
 ofColor CubeMesh::generateVertexColor(const ofVec3f & position) const {
 	// ɰɫ߿ʾ
 	return ofColor(255, 255, 255, 200);
@@ -148,7 +180,8 @@ std::string CubeMesh::vectorToKey(const ofVec3f & vec) const {
 }
 
 void CubeMesh::updateConfig(const CubeMeshConfig & newConfig) {
-	bool needRegenerate = (config.gridResolution != newConfig.gridResolution || config.cubeSize != newConfig.cubeSize);
+	bool needRegenerate = (config.gridResolution != newConfig.gridResolution || config.cubeSize != newConfig.cubeSize
+		|| config.optimizeVertexOrder != newConfig.optimizeVertexOrder);
 
 	config = newConfig;
 
@@ -177,4 +210,6 @@ void CubeMesh::logMeshInfo() const {
 	ofLogNotice("CubeMesh") << "  Vertices: " << getVertexCount() << " (shared via vertexPool)";
 	ofLogNotice("CubeMesh") << "  Indices: " << getIndexCount();
 	ofLogNotice("CubeMesh") << "  Vertex sharing efficiency: " << getVertexSharingRatio() << ":1";
+	ofLogNotice("CubeMesh") << "  ACMR: " << acmrBefore << " -> " << acmrAfter
+							<< (config.optimizeVertexOrder ? "" : " (reordering disabled)");
 }
@@ -44,10 +44,15 @@ private:
 	ofVboMesh mesh;
 	VertexPoolData vertexPoolData;
 
+	// Average cache miss ratio of the index buffer before/after optimizeMeshOrder()
+	float acmrBefore = 0.0f;
+	float acmrAfter = 0.0f;
+
 	// ڲ
 	void createCubeMesh();
 	void addFaceWithNormal(const ofVec3f & origin, const ofVec3f & right, const ofVec3f & down, const ofVec3f & faceNormal);
 	int getVertexIndexWithNormal(const ofVec3f & pos, const ofVec3f & normal);
+	void optimizeMeshOrder();
 
 	// ɫ
 	ofColor generateVertexColor(const ofVec3f & position) const;
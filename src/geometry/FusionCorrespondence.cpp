@@ -0,0 +1,124 @@
+#include "FusionCorrespondence.h"
+#include "utils/Hash.h"
+#include "utils/ParallelFor.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace {
+
+const uint32_t kCacheMagic = 0x314D4346; // "FCM1"
+const size_t kMinChunkSize = 1024;
+
+}
+
+//--------------------------------------------------------------
+void FusionCorrespondence::build(const MeshBVH & bvh, const std::vector<glm::vec3> & modelNormals,
+	const std::vector<glm::vec3> & cubeVertices, const Settings & settings,
+	std::vector<glm::vec3> & outPositions, std::vector<glm::vec3> & outNormals) {
+	outPositions.assign(cubeVertices.size(), settings.center);
+	outNormals.assign(cubeVertices.size(), glm::vec3(0.0f, 1.0f, 0.0f));
+	if (bvh.empty()) return;
+
+	const auto & vertices = bvh.getVertices();
+	const auto & indices = bvh.getIndices();
+	bool interpolateNormals = modelNormals.size() == vertices.size();
+
+	// Rays start outside the model and point inwards, so the first hit is
+	// the outermost surface even for concave shapes
+	float radius = 0.0f;
+	for (const auto & v : vertices) {
+		radius = std::max(radius, glm::length(v - settings.center));
+	}
+	float rayStart = radius * 1.01f + 1.0f;
+
+	auto surfaceNormal = [&](const MeshBVH::Hit & hit) {
+		unsigned int a = indices[hit.triangle * 3], b = indices[hit.triangle * 3 + 1], c = indices[hit.triangle * 3 + 2];
+		glm::vec3 n;
+		if (interpolateNormals) {
+			n = modelNormals[a] * hit.barycentric.x + modelNormals[b] * hit.barycentric.y + modelNormals[c] * hit.barycentric.z;
+		} else {
+			n = glm::cross(vertices[b] - vertices[a], vertices[c] - vertices[a]);
+		}
+		float len = glm::length(n);
+		return len > 1e-12f ? n / len : glm::vec3(0.0f, 1.0f, 0.0f);
+	};
+
+	parallelForChunks(cubeVertices.size(), resolveWorkerCount(settings.workers), kMinChunkSize,
+		[&](size_t begin, size_t end, int) {
+			for (size_t i = begin; i < end; i++) {
+				const glm::vec3 & p = cubeVertices[i];
+				MeshBVH::Hit hit;
+
+				if (settings.mode == RAY_FROM_CENTER) {
+					glm::vec3 dir = p - settings.center;
+					float len = glm::length(dir);
+					if (len > 1e-6f) {
+						dir /= len;
+						hit = bvh.raycast(settings.center + dir * rayStart, -dir, rayStart * 2.0f);
+					}
+				}
+
+				// Rays that miss (model off-center or open) fall back to the nearest point
+				if (!hit.valid) {
+					hit = bvh.closestPoint(p);
+				}
+				if (!hit.valid) continue;
+
+				outPositions[i] = hit.position;
+				outNormals[i] = surfaceNormal(hit);
+			}
+		});
+}
+
+//--------------------------------------------------------------
+uint64_t FusionCorrespondence::computeKey(const std::vector<glm::vec3> & modelVertices,
+	const std::vector<unsigned int> & modelIndices, const std::vector<glm::vec3> & cubeVertices, Mode mode) {
+	uint64_t hash = kHashSeed;
+	int32_t modeValue = mode;
+	hash = hashBytes(hash, &modeValue, sizeof(modeValue));
+	hash = hashBytes(hash, modelVertices.data(), modelVertices.size() * sizeof(glm::vec3));
+	hash = hashBytes(hash, modelIndices.data(), modelIndices.size() * sizeof(unsigned int));
+	hash = hashBytes(hash, cubeVertices.data(), cubeVertices.size() * sizeof(glm::vec3));
+	return hash;
+}
+
+//--------------------------------------------------------------
+bool FusionCorrespondence::loadCache(const std::string & path, uint64_t key, size_t vertexCount,
+	std::vector<glm::vec3> & outPositions, std::vector<glm::vec3> & outNormals) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file) return false;
+
+	uint32_t magic = 0;
+	uint64_t storedKey = 0;
+	uint64_t storedCount = 0;
+	file.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+	file.read(reinterpret_cast<char *>(&storedKey), sizeof(storedKey));
+	file.read(reinterpret_cast<char *>(&storedCount), sizeof(storedCount));
+	if (!file || magic != kCacheMagic || storedKey != key || storedCount != vertexCount) {
+		return false;
+	}
+
+	outPositions.resize(vertexCount);
+	outNormals.resize(vertexCount);
+	file.read(reinterpret_cast<char *>(outPositions.data()), vertexCount * sizeof(glm::vec3));
+	file.read(reinterpret_cast<char *>(outNormals.data()), vertexCount * sizeof(glm::vec3));
+	return (bool)file;
+}
+
+//--------------------------------------------------------------
+bool FusionCorrespondence::saveCache(const std::string & path, uint64_t key,
+	const std::vector<glm::vec3> & positions, const std::vector<glm::vec3> & normals) {
+	if (positions.size() != normals.size()) return false;
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file) return false;
+
+	uint64_t count = positions.size();
+	file.write(reinterpret_cast<const char *>(&kCacheMagic), sizeof(kCacheMagic));
+	file.write(reinterpret_cast<const char *>(&key), sizeof(key));
+	file.write(reinterpret_cast<const char *>(&count), sizeof(count));
+	file.write(reinterpret_cast<const char *>(positions.data()), positions.size() * sizeof(glm::vec3));
+	file.write(reinterpret_cast<const char *>(normals.data()), normals.size() * sizeof(glm::vec3));
+	return (bool)file;
+}
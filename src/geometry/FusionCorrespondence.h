@@ -0,0 +1,45 @@
+#pragma once
+#include "MeshBVH.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Maps every cube vertex to a point on the Screen1 model surface, so the
+// Screen3 fusion can morph each cube vertex towards a stable, spatially
+// coherent target instead of an arbitrary model vertex. GL-independent.
+class FusionCorrespondence {
+public:
+	enum Mode {
+		CLOSEST_POINT = 0, // nearest surface point to the cube vertex
+		RAY_FROM_CENTER = 1 // outermost surface hit on the ray from the center through the vertex
+	};
+
+	struct Settings {
+		Mode mode = RAY_FROM_CENTER;
+		glm::vec3 center = glm::vec3(0.0f);
+		int workers = 0; // 0 = all hardware threads
+	};
+
+	// outPositions[i] / outNormals[i] belong to cubeVertices[i]. modelNormals
+	// are interpolated when they match the BVH's vertices, otherwise the
+	// face normal is used.
+	static void build(const MeshBVH & bvh,
+		const std::vector<glm::vec3> & modelNormals,
+		const std::vector<glm::vec3> & cubeVertices,
+		const Settings & settings,
+		std::vector<glm::vec3> & outPositions,
+		std::vector<glm::vec3> & outNormals);
+
+	// Content hash of everything the map depends on; the cube vertices cover
+	// grid resolution, cube size and vertex order
+	static uint64_t computeKey(const std::vector<glm::vec3> & modelVertices,
+		const std::vector<unsigned int> & modelIndices,
+		const std::vector<glm::vec3> & cubeVertices,
+		Mode mode);
+
+	// Binary cache file; load fails if the key or vertex count differ
+	static bool loadCache(const std::string & path, uint64_t key, size_t vertexCount,
+		std::vector<glm::vec3> & outPositions, std::vector<glm::vec3> & outNormals);
+	static bool saveCache(const std::string & path, uint64_t key,
+		const std::vector<glm::vec3> & positions, const std::vector<glm::vec3> & normals);
+};
@@ -0,0 +1,113 @@
+#include "InstanceField.h"
+#include "utils/ParallelFor.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace {
+
+// Instances are cheap to update, so keep chunks large enough to pay for a thread
+const size_t kMinChunkSize = 256;
+const float kTwoPi = 6.28318530718f;
+
+struct Frustum {
+	glm::vec4 planes[6];
+};
+
+// Gribb/Hartmann plane extraction; normals point inwards
+Frustum extractFrustum(const glm::mat4 & m) {
+	glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+	glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+	glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+	glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+	Frustum frustum;
+	frustum.planes[0] = row3 + row0;
+	frustum.planes[1] = row3 - row0;
+	frustum.planes[2] = row3 + row1;
+	frustum.planes[3] = row3 - row1;
+	frustum.planes[4] = row3 + row2;
+	frustum.planes[5] = row3 - row2;
+	for (auto & plane : frustum.planes) {
+		plane /= glm::length(glm::vec3(plane));
+	}
+	return frustum;
+}
+
+bool isSphereVisible(const Frustum & frustum, const glm::vec3 & center, float radius) {
+	for (const auto & plane : frustum.planes) {
+		if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) return false;
+	}
+	return true;
+}
+
+}
+
+//--------------------------------------------------------------
+void InstanceField::setup(const Settings & newSettings, float newModelRadius) {
+	settings = newSettings;
+	modelRadius = newModelRadius;
+
+	int count = std::max(0, settings.count);
+	int side = (int)std::ceil(std::sqrt((float)count));
+	float half = (side - 1) * 0.5f;
+
+	// Positions are stored in grid units and scaled by the current instance
+	// diameter in update(), so scale changes do not need a new layout
+	std::mt19937 rng(settings.seed);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	instances.assign(count, Instance());
+	for (int i = 0; i < count; i++) {
+		Instance & instance = instances[i];
+		float jitterX = (unit(rng) - 0.5f) * 0.3f;
+		float jitterZ = (unit(rng) - 0.5f) * 0.3f;
+		instance.position = glm::vec3(i % side - half + jitterX, 0.0f, i / side - half + jitterZ);
+		instance.scale = 0.8f + 0.4f * unit(rng);
+		instance.phase = unit(rng);
+		instance.spin = (unit(rng) < 0.5f ? -1.0f : 1.0f) * (0.5f + unit(rng));
+		instance.tint = glm::vec3(0.75f) + glm::vec3(unit(rng), unit(rng), unit(rng)) * 0.25f;
+	}
+}
+
+//--------------------------------------------------------------
+void InstanceField::update(float time, float rotationDeg, float modelScale, const glm::mat4 & viewProjection) {
+	float instanceRadius = modelRadius * modelScale * settings.instanceScale;
+	float pitch = instanceRadius * 2.0f * settings.spacing;
+	float bob = instanceRadius * 2.0f * settings.bobAmplitude;
+	Frustum frustum = extractFrustum(viewProjection);
+
+	int workers = resolveWorkerCount(settings.workers);
+	chunkData.resize(getChunkCount(instances.size(), workers, kMinChunkSize));
+
+	parallelForChunks(instances.size(), workers, kMinChunkSize, [&](size_t begin, size_t end, int chunk) {
+		std::vector<glm::vec4> & out = chunkData[chunk];
+		out.clear();
+
+		for (size_t i = begin; i < end; i++) {
+			const Instance & instance = instances[i];
+			float phaseAngle = instance.phase * kTwoPi;
+			glm::vec3 center = instance.position * pitch;
+			center.y += std::sin(time * 1.5f + phaseAngle) * bob;
+
+			float scale = modelScale * settings.instanceScale * instance.scale;
+			if (!isSphereVisible(frustum, center, modelRadius * scale)) continue;
+
+			// translate * rotateY * scale, written out column by column
+			float angle = rotationDeg * instance.spin * (kTwoPi / 360.0f) + phaseAngle;
+			float c = std::cos(angle) * scale;
+			float s = std::sin(angle) * scale;
+			out.push_back(glm::vec4(c, 0.0f, -s, 0.0f));
+			out.push_back(glm::vec4(0.0f, scale, 0.0f, 0.0f));
+			out.push_back(glm::vec4(s, 0.0f, c, 0.0f));
+			out.push_back(glm::vec4(center, 1.0f));
+			out.push_back(glm::vec4(instance.tint, instance.phase));
+		}
+	});
+
+	// Compact: chunks are in instance order, so the visible list keeps it too
+	visibleData.clear();
+	for (const auto & data : chunkData) {
+		visibleData.insert(visibleData.end(), data.begin(), data.end());
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+// A grid of model copies for the Screen1 gallery mode, each with its own
+// position, scale, spin and animation phase. update() recomputes every
+// transform in parallel, frustum-culls the bounding spheres and packs the
+// survivors contiguously, ready for one instanced draw. GL-independent.
+class InstanceField {
+public:
+	struct Settings {
+		int count = 400;
+		float instanceScale = 0.25f; // relative to the single-model scale
+		float spacing = 2.5f; // grid pitch in instance diameters
+		float bobAmplitude = 0.2f; // vertical bob in instance diameters
+		uint32_t seed = 1;
+		int workers = 0; // 0 = all hardware threads
+	};
+
+	// Texels per visible instance in getVisibleData(): the four columns of
+	// the model matrix, then (tint.rgb, phase)
+	static const int kTexelsPerInstance = 5;
+
+	// Lays out settings.count instances for a model of the given bounding
+	// radius (model space, at scale 1)
+	void setup(const Settings & settings, float modelRadius);
+
+	// modelScale is the single-model scale the whole field follows;
+	// viewProjection is used for culling only
+	void update(float time, float rotationDeg, float modelScale, const glm::mat4 & viewProjection);
+
+	const std::vector<glm::vec4> & getVisibleData() const { return visibleData; }
+	size_t getVisibleCount() const { return visibleData.size() / kTexelsPerInstance; }
+	size_t getCount() const { return instances.size(); }
+	const Settings & getSettings() const { return settings; }
+	float getModelRadius() const { return modelRadius; }
+
+private:
+	struct Instance {
+		glm::vec3 position;
+		float scale = 1.0f;
+		float phase = 0.0f;
+		float spin = 1.0f;
+		glm::vec3 tint = glm::vec3(1.0f);
+	};
+
+	Settings settings;
+	float modelRadius = 0.0f;
+	std::vector<Instance> instances;
+
+	// Per-chunk survivors, concatenated into visibleData after the cull
+	std::vector<std::vector<glm::vec4>> chunkData;
+	std::vector<glm::vec4> visibleData;
+};
@@ -0,0 +1,367 @@
+#include "MeshBVH.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace {
+
+const unsigned int kMaxLeafTriangles = 4;
+const int kSahBins = 12;
+// Depth cap; a depth-first traversal never holds more than depth + 1 nodes,
+// so the fixed query stacks below cannot overflow
+const int kMaxDepth = 60;
+const int kStackSize = kMaxDepth + 4;
+
+float surfaceArea(const glm::vec3 & boundsMin, const glm::vec3 & boundsMax) {
+	glm::vec3 e = glm::max(boundsMax - boundsMin, glm::vec3(0.0f));
+	return 2.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+}
+
+float distanceSquaredToBox(const glm::vec3 & p, const glm::vec3 & boundsMin, const glm::vec3 & boundsMax) {
+	glm::vec3 d = glm::max(glm::max(boundsMin - p, p - boundsMax), glm::vec3(0.0f));
+	return glm::dot(d, d);
+}
+
+// Slab test; returns the entry distance or +inf on a miss
+float intersectBox(const glm::vec3 & origin, const glm::vec3 & invDirection, float maxDistance,
+	const glm::vec3 & boundsMin, const glm::vec3 & boundsMax) {
+	glm::vec3 t0 = (boundsMin - origin) * invDirection;
+	glm::vec3 t1 = (boundsMax - origin) * invDirection;
+	glm::vec3 tNear = glm::min(t0, t1);
+	glm::vec3 tFar = glm::max(t0, t1);
+	float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+	float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+	return enter <= exit ? enter : std::numeric_limits<float>::infinity();
+}
+
+// Closest point on triangle abc to p (Ericson, Real-Time Collision Detection 5.1.5)
+glm::vec3 closestOnTriangle(const glm::vec3 & p, const glm::vec3 & a, const glm::vec3 & b, const glm::vec3 & c,
+	glm::vec3 & outBarycentric) {
+	glm::vec3 ab = b - a, ac = c - a, ap = p - a;
+	float d1 = glm::dot(ab, ap), d2 = glm::dot(ac, ap);
+	if (d1 <= 0.0f && d2 <= 0.0f) {
+		outBarycentric = glm::vec3(1, 0, 0);
+		return a;
+	}
+
+	glm::vec3 bp = p - b;
+	float d3 = glm::dot(ab, bp), d4 = glm::dot(ac, bp);
+	if (d3 >= 0.0f && d4 <= d3) {
+		outBarycentric = glm::vec3(0, 1, 0);
+		return b;
+	}
+
+	float vc = d1 * d4 - d3 * d2;
+	if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+		float v = d1 / (d1 - d3);
+		outBarycentric = glm::vec3(1 - v, v, 0);
+		return a + ab * v;
+	}
+
+	glm::vec3 cp = p - c;
+	float d5 = glm::dot(ab, cp), d6 = glm::dot(ac, cp);
+	if (d6 >= 0.0f && d5 <= d6) {
+		outBarycentric = glm::vec3(0, 0, 1);
+		return c;
+	}
+
+	float vb = d5 * d2 - d1 * d6;
+	if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+		float w = d2 / (d2 - d6);
+		outBarycentric = glm::vec3(1 - w, 0, w);
+		return a + ac * w;
+	}
+
+	float va = d3 * d6 - d5 * d4;
+	if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+		float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+		outBarycentric = glm::vec3(0, 1 - w, w);
+		return b + (c - b) * w;
+	}
+
+	float denom = 1.0f / (va + vb + vc);
+	float v = vb * denom, w = vc * denom;
+	outBarycentric = glm::vec3(1 - v - w, v, w);
+	return a + ab * v + ac * w;
+}
+
+}
+
+//--------------------------------------------------------------
+void MeshBVH::clear() {
+	vertices.clear();
+	indices.clear();
+	triangles.clear();
+	nodes.clear();
+}
+
+//--------------------------------------------------------------
+void MeshBVH::build(const std::vector<glm::vec3> & meshVertices, const std::vector<unsigned int> & meshIndices) {
+	clear();
+	vertices = meshVertices;
+
+	// Only well-formed triangles enter the tree
+	size_t faceCount = meshIndices.size() / 3;
+	indices.reserve(faceCount * 3);
+	for (size_t f = 0; f < faceCount; f++) {
+		unsigned int a = meshIndices[f * 3], b = meshIndices[f * 3 + 1], c = meshIndices[f * 3 + 2];
+		if (a < vertices.size() && b < vertices.size() && c < vertices.size()) {
+			indices.push_back(a);
+			indices.push_back(b);
+			indices.push_back(c);
+		}
+	}
+
+	unsigned int triangleCount = (unsigned int)(indices.size() / 3);
+	if (triangleCount == 0) return;
+
+	std::vector<glm::vec3> centroids(triangleCount);
+	triangles.resize(triangleCount);
+	for (unsigned int t = 0; t < triangleCount; t++) {
+		triangles[t] = t;
+		centroids[t] = (vertices[indices[t * 3]] + vertices[indices[t * 3 + 1]] + vertices[indices[t * 3 + 2]]) / 3.0f;
+	}
+
+	nodes.reserve(2 * triangleCount / kMaxLeafTriangles + 1);
+	Node root;
+	root.first = 0;
+	root.count = triangleCount;
+	updateBounds(root);
+	nodes.push_back(root);
+
+	subdivide(0, centroids);
+	nodes.shrink_to_fit();
+}
+
+//--------------------------------------------------------------
+void MeshBVH::updateBounds(Node & node) const {
+	node.boundsMin = glm::vec3(std::numeric_limits<float>::max());
+	node.boundsMax = glm::vec3(std::numeric_limits<float>::lowest());
+	for (unsigned int i = node.first; i < node.first + node.count; i++) {
+		unsigned int t = triangles[i];
+		for (int k = 0; k < 3; k++) {
+			node.boundsMin = glm::min(node.boundsMin, vertices[indices[t * 3 + k]]);
+			node.boundsMax = glm::max(node.boundsMax, vertices[indices[t * 3 + k]]);
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void MeshBVH::subdivide(unsigned int rootIndex, const std::vector<glm::vec3> & centroids) {
+	// Explicit stack of (node, depth): degenerate inputs can make the tree deep
+	std::vector<std::pair<unsigned int, int>> stack(1, std::make_pair(rootIndex, 0));
+
+	while (!stack.empty()) {
+		unsigned int nodeIndex = stack.back().first;
+		int depth = stack.back().second;
+		stack.pop_back();
+		Node node = nodes[nodeIndex];
+		if (node.count <= kMaxLeafTriangles || depth >= kMaxDepth) continue;
+
+		glm::vec3 centroidMin(std::numeric_limits<float>::max());
+		glm::vec3 centroidMax(std::numeric_limits<float>::lowest());
+		for (unsigned int i = node.first; i < node.first + node.count; i++) {
+			centroidMin = glm::min(centroidMin, centroids[triangles[i]]);
+			centroidMax = glm::max(centroidMax, centroids[triangles[i]]);
+		}
+
+		// Binned SAH over all three axes
+		int bestAxis = -1;
+		int bestSplit = 0;
+		float bestCost = surfaceArea(node.boundsMin, node.boundsMax) * node.count;
+		for (int axis = 0; axis < 3; axis++) {
+			float extent = centroidMax[axis] - centroidMin[axis];
+			if (extent <= 0.0f) continue;
+
+			glm::vec3 binMin[kSahBins], binMax[kSahBins];
+			unsigned int binCount[kSahBins] = {};
+			for (int b = 0; b < kSahBins; b++) {
+				binMin[b] = glm::vec3(std::numeric_limits<float>::max());
+				binMax[b] = glm::vec3(std::numeric_limits<float>::lowest());
+			}
+
+			float scale = kSahBins / extent;
+			for (unsigned int i = node.first; i < node.first + node.count; i++) {
+				unsigned int t = triangles[i];
+				int b = std::min(kSahBins - 1, (int)((centroids[t][axis] - centroidMin[axis]) * scale));
+				binCount[b]++;
+				for (int k = 0; k < 3; k++) {
+					binMin[b] = glm::min(binMin[b], vertices[indices[t * 3 + k]]);
+					binMax[b] = glm::max(binMax[b], vertices[indices[t * 3 + k]]);
+				}
+			}
+
+			// Sweep from the right to get the cost of every right half
+			float rightArea[kSahBins];
+			unsigned int rightCount[kSahBins];
+			glm::vec3 accMin(std::numeric_limits<float>::max()), accMax(std::numeric_limits<float>::lowest());
+			unsigned int acc = 0;
+			for (int b = kSahBins - 1; b > 0; b--) {
+				acc += binCount[b];
+				accMin = glm::min(accMin, binMin[b]);
+				accMax = glm::max(accMax, binMax[b]);
+				rightArea[b] = acc ? surfaceArea(accMin, accMax) : 0.0f;
+				rightCount[b] = acc;
+			}
+
+			accMin = glm::vec3(std::numeric_limits<float>::max());
+			accMax = glm::vec3(std::numeric_limits<float>::lowest());
+			acc = 0;
+			for (int b = 0; b < kSahBins - 1; b++) {
+				acc += binCount[b];
+				accMin = glm::min(accMin, binMin[b]);
+				accMax = glm::max(accMax, binMax[b]);
+				if (acc == 0 || rightCount[b + 1] == 0) continue;
+				float cost = surfaceArea(accMin, accMax) * acc + rightArea[b + 1] * rightCount[b + 1];
+				if (cost < bestCost) {
+					bestCost = cost;
+					bestAxis = axis;
+					bestSplit = b + 1;
+				}
+			}
+		}
+
+		unsigned int mid;
+		if (bestAxis >= 0) {
+			float scale = kSahBins / (centroidMax[bestAxis] - centroidMin[bestAxis]);
+			auto begin = triangles.begin() + node.first;
+			auto split = std::partition(begin, begin + node.count, [&](unsigned int t) {
+				return std::min(kSahBins - 1, (int)((centroids[t][bestAxis] - centroidMin[bestAxis]) * scale)) < bestSplit;
+			});
+			mid = (unsigned int)(split - triangles.begin());
+		} else {
+			// SAH found nothing better than a leaf; only split oversized
+			// leaves, at the median of the longest centroid axis
+			if (node.count <= kMaxLeafTriangles * 4) continue;
+			glm::vec3 extent = centroidMax - centroidMin;
+			int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+			mid = node.first + node.count / 2;
+			std::nth_element(triangles.begin() + node.first, triangles.begin() + mid, triangles.begin() + node.first + node.count,
+				[&](unsigned int a, unsigned int b) { return centroids[a][axis] < centroids[b][axis]; });
+		}
+
+		Node left, right;
+		left.first = node.first;
+		left.count = mid - node.first;
+		right.first = mid;
+		right.count = node.first + node.count - mid;
+		if (left.count == 0 || right.count == 0) continue;
+		updateBounds(left);
+		updateBounds(right);
+
+		unsigned int leftIndex = (unsigned int)nodes.size();
+		nodes.push_back(left);
+		nodes.push_back(right);
+		nodes[nodeIndex].first = leftIndex;
+		nodes[nodeIndex].count = 0;
+
+		stack.push_back(std::make_pair(leftIndex, depth + 1));
+		stack.push_back(std::make_pair(leftIndex + 1, depth + 1));
+	}
+}
+
+//--------------------------------------------------------------
+MeshBVH::Hit MeshBVH::closestPoint(const glm::vec3 & p, float maxDistance) const {
+	Hit hit;
+	if (nodes.empty()) return hit;
+
+	float bestDistSq = maxDistance < 1e18f ? maxDistance * maxDistance : std::numeric_limits<float>::max();
+	unsigned int stack[kStackSize];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while (stackSize > 0) {
+		const Node & node = nodes[stack[--stackSize]];
+		if (distanceSquaredToBox(p, node.boundsMin, node.boundsMax) >= bestDistSq) continue;
+
+		if (node.count > 0) {
+			for (unsigned int i = node.first; i < node.first + node.count; i++) {
+				unsigned int t = triangles[i];
+				glm::vec3 barycentric;
+				glm::vec3 q = closestOnTriangle(p, vertices[indices[t * 3]], vertices[indices[t * 3 + 1]], vertices[indices[t * 3 + 2]], barycentric);
+				float distSq = glm::dot(q - p, q - p);
+				if (distSq < bestDistSq) {
+					bestDistSq = distSq;
+					hit.valid = true;
+					hit.triangle = t;
+					hit.position = q;
+					hit.barycentric = barycentric;
+				}
+			}
+			continue;
+		}
+
+		// Visit the nearer child first so the far one is usually culled
+		unsigned int nearChild = node.first, farChild = node.first + 1;
+		if (distanceSquaredToBox(p, nodes[farChild].boundsMin, nodes[farChild].boundsMax)
+			< distanceSquaredToBox(p, nodes[nearChild].boundsMin, nodes[nearChild].boundsMax)) {
+			std::swap(nearChild, farChild);
+		}
+		stack[stackSize++] = farChild;
+		stack[stackSize++] = nearChild;
+	}
+
+	hit.distance = std::sqrt(bestDistSq);
+	return hit;
+}
+
+//--------------------------------------------------------------
+MeshBVH::Hit MeshBVH::raycast(const glm::vec3 & origin, const glm::vec3 & direction, float maxDistance) const {
+	Hit hit;
+	if (nodes.empty()) return hit;
+
+	glm::vec3 invDirection(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+	float bestT = maxDistance;
+	unsigned int stack[kStackSize];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while (stackSize > 0) {
+		const Node & node = nodes[stack[--stackSize]];
+		if (intersectBox(origin, invDirection, bestT, node.boundsMin, node.boundsMax) > bestT) continue;
+
+		if (node.count > 0) {
+			// Moller-Trumbore
+			for (unsigned int i = node.first; i < node.first + node.count; i++) {
+				unsigned int t = triangles[i];
+				const glm::vec3 & a = vertices[indices[t * 3]];
+				glm::vec3 e1 = vertices[indices[t * 3 + 1]] - a;
+				glm::vec3 e2 = vertices[indices[t * 3 + 2]] - a;
+				glm::vec3 pv = glm::cross(direction, e2);
+				float det = glm::dot(e1, pv);
+				if (std::fabs(det) < 1e-12f) continue;
+
+				float invDet = 1.0f / det;
+				glm::vec3 tv = origin - a;
+				float u = glm::dot(tv, pv) * invDet;
+				if (u < 0.0f || u > 1.0f) continue;
+				glm::vec3 qv = glm::cross(tv, e1);
+				float v = glm::dot(direction, qv) * invDet;
+				if (v < 0.0f || u + v > 1.0f) continue;
+
+				float dist = glm::dot(e2, qv) * invDet;
+				if (dist > 0.0f && dist < bestT) {
+					bestT = dist;
+					hit.valid = true;
+					hit.triangle = t;
+					hit.position = origin + direction * dist;
+					hit.barycentric = glm::vec3(1.0f - u - v, u, v);
+					hit.distance = dist;
+				}
+			}
+			continue;
+		}
+
+		float tLeft = intersectBox(origin, invDirection, bestT, nodes[node.first].boundsMin, nodes[node.first].boundsMax);
+		float tRight = intersectBox(origin, invDirection, bestT, nodes[node.first + 1].boundsMin, nodes[node.first + 1].boundsMax);
+		if (tLeft <= tRight) {
+			if (tRight <= bestT) stack[stackSize++] = node.first + 1;
+			if (tLeft <= bestT) stack[stackSize++] = node.first;
+		} else {
+			if (tLeft <= bestT) stack[stackSize++] = node.first;
+			if (tRight <= bestT) stack[stackSize++] = node.first + 1;
+		}
+	}
+	return hit;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+
+// Bounding volume hierarchy over the triangles of an indexed mesh, built
+// with binned SAH. GL-independent; queries are const and safe to run from
+// several threads at once.
+class MeshBVH {
+public:
+	struct Hit {
+		bool valid = false;
+		unsigned int triangle = 0;
+		glm::vec3 position = glm::vec3(0.0f);
+		glm::vec3 barycentric = glm::vec3(0.0f); // weights of the triangle's three corners
+		float distance = 0.0f; // to the query point / along the ray
+	};
+
+	void build(const std::vector<glm::vec3> & vertices, const std::vector<unsigned int> & indices);
+	void clear();
+	bool empty() const { return nodes.empty(); }
+
+	// Nearest point on the surface to p; nothing farther than maxDistance
+	// is considered, which makes narrow-band queries cheap
+	Hit closestPoint(const glm::vec3 & p, float maxDistance = 1e30f) const;
+
+	// First intersection of origin + t * direction for 0 < t < maxDistance
+	Hit raycast(const glm::vec3 & origin, const glm::vec3 & direction, float maxDistance = 1e30f) const;
+
+	const std::vector<glm::vec3> & getVertices() const { return vertices; }
+	const std::vector<unsigned int> & getIndices() const { return indices; }
+
+private:
+	struct Node {
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+		unsigned int first = 0; // first triangle (leaf) or left child (inner)
+		unsigned int count = 0; // triangle count, 0 for inner nodes
+	};
+
+	std::vector<glm::vec3> vertices;
+	std::vector<unsigned int> indices;
+	std::vector<unsigned int> triangles; // leaf ranges point into this permutation
+	std::vector<Node> nodes;
+
+	void subdivide(unsigned int nodeIndex, const std::vector<glm::vec3> & centroids);
+	void updateBounds(Node & node) const;
+};
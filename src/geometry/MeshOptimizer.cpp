@@ -0,0 +1,198 @@
+#include "MeshOptimizer.h"
+#include "MeshProcessing.h"
+#include "utils/ParallelFor.h"
+#include <algorithm>
+
+namespace MeshOptimizer {
+
+//--------------------------------------------------------------
+float computeACMR(const std::vector<unsigned int> & indices, size_t vertexCount, int cacheSize) {
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0) return 0.0f;
+
+	// FIFO cache: a vertex is resident while fewer than cacheSize misses
+	// have happened since it was last loaded
+	std::vector<size_t> loadedAt(vertexCount, 0);
+	std::vector<bool> everLoaded(vertexCount, false);
+	size_t misses = 0;
+
+	for (size_t i = 0; i < triangleCount * 3; i++) {
+		unsigned int v = indices[i];
+		if (v >= vertexCount) continue;
+		if (!everLoaded[v] || misses - loadedAt[v] >= (size_t)cacheSize) {
+			loadedAt[v] = misses++;
+			everLoaded[v] = true;
+		}
+	}
+	return (float)misses / triangleCount;
+}
+
+//--------------------------------------------------------------
+void optimizeVertexCache(std::vector<unsigned int> & indices, size_t vertexCount, int cacheSize) {
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0 || vertexCount == 0) return;
+
+	MeshProcessing::VertexFaceAdjacency adjacency;
+	MeshProcessing::buildVertexFaceAdjacency(vertexCount, indices, adjacency);
+
+	// Number of not-yet-emitted triangles around each vertex
+	std::vector<int> live(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++) {
+		live[v] = (int)(adjacency.offsets[v + 1] - adjacency.offsets[v]);
+	}
+
+	// Cache timestamps start far enough in the past to count as evicted
+	std::vector<int> cacheTime(vertexCount, 0);
+	int time = cacheSize + 1;
+
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<unsigned int> deadEnd;
+	std::vector<unsigned int> candidates;
+	std::vector<unsigned int> output;
+	output.reserve(triangleCount * 3);
+
+	size_t cursor = 0;
+	auto nextUnfinished = [&]() -> long long {
+		// Most recently touched vertex that still has work, else scan forwards
+		while (!deadEnd.empty()) {
+			unsigned int d = deadEnd.back();
+			deadEnd.pop_back();
+			if (live[d] > 0) return d;
+		}
+		while (cursor < vertexCount) {
+			if (live[cursor] > 0) return (long long)cursor++;
+			cursor++;
+		}
+		return -1;
+	};
+
+	long long fan = nextUnfinished();
+	while (fan >= 0) {
+		candidates.clear();
+
+		// Emit every remaining triangle around the fanning vertex
+		for (unsigned int k = adjacency.offsets[fan]; k < adjacency.offsets[fan + 1]; k++) {
+			unsigned int t = adjacency.faces[k];
+			if (emitted[t]) continue;
+			emitted[t] = true;
+
+			for (int c = 0; c < 3; c++) {
+				unsigned int v = indices[t * 3 + c];
+				output.push_back(v);
+				deadEnd.push_back(v);
+				candidates.push_back(v);
+				live[v]--;
+				if (time - cacheTime[v] > cacheSize) {
+					cacheTime[v] = time++;
+				}
+			}
+		}
+
+		// Next fan: the candidate that will still be in cache after its own
+		// triangles are emitted, preferring the oldest such entry
+		long long best = -1;
+		int bestPriority = -1;
+		for (unsigned int v : candidates) {
+			if (live[v] <= 0) continue;
+			int priority = 0;
+			if (time - cacheTime[v] + 2 * live[v] <= cacheSize) {
+				priority = time - cacheTime[v];
+			}
+			if (priority > bestPriority) {
+				bestPriority = priority;
+				best = v;
+			}
+		}
+		fan = best >= 0 ? best : nextUnfinished();
+	}
+
+	// Triangles whose indices are out of range never enter the adjacency;
+	// keep them at the end so nothing is lost
+	for (size_t t = 0; t < triangleCount; t++) {
+		if (!emitted[t]) {
+			output.insert(output.end(), indices.begin() + t * 3, indices.begin() + t * 3 + 3);
+		}
+	}
+	output.insert(output.end(), indices.begin() + triangleCount * 3, indices.end());
+	indices.swap(output);
+}
+
+//--------------------------------------------------------------
+void optimizeVertexCache(std::vector<unsigned int> & indices, const std::vector<IndexRange> & ranges,
+	int cacheSize, int workers) {
+	parallelForChunks(ranges.size(), resolveWorkerCount(workers), 1, [&](size_t begin, size_t end, int) {
+		std::vector<unsigned int> local;
+		std::vector<unsigned int> localToGlobal;
+
+		for (size_t r = begin; r < end; r++) {
+			size_t offset = std::min(ranges[r].offset, indices.size());
+			size_t count = std::min(ranges[r].count, indices.size() - offset) / 3 * 3;
+			if (count == 0) continue;
+
+			// Compact the range to local vertex ids so the adjacency is sized
+			// by this submesh rather than by the whole scene
+			localToGlobal.assign(indices.begin() + offset, indices.begin() + offset + count);
+			std::sort(localToGlobal.begin(), localToGlobal.end());
+			localToGlobal.erase(std::unique(localToGlobal.begin(), localToGlobal.end()), localToGlobal.end());
+
+			local.resize(count);
+			for (size_t i = 0; i < count; i++) {
+				local[i] = (unsigned int)(std::lower_bound(localToGlobal.begin(), localToGlobal.end(), indices[offset + i]) - localToGlobal.begin());
+			}
+
+			optimizeVertexCache(local, localToGlobal.size(), cacheSize);
+
+			for (size_t i = 0; i < count; i++) {
+				indices[offset + i] = localToGlobal[local[i]];
+			}
+		}
+	});
+}
+
+//--------------------------------------------------------------
+std::vector<unsigned int> optimizeVertexFetch(std::vector<unsigned int> & indices, size_t vertexCount) {
+	const unsigned int unassigned = ~0u;
+	std::vector<unsigned int> newIndex(vertexCount, unassigned);
+	std::vector<unsigned int> sourceVertex;
+	sourceVertex.reserve(vertexCount);
+
+	for (auto & index : indices) {
+		if (index >= vertexCount) continue;
+		if (newIndex[index] == unassigned) {
+			newIndex[index] = (unsigned int)sourceVertex.size();
+			sourceVertex.push_back(index);
+		}
+		index = newIndex[index];
+	}
+
+	for (size_t v = 0; v < vertexCount; v++) {
+		if (newIndex[v] == unassigned) {
+			newIndex[v] = (unsigned int)sourceVertex.size();
+			sourceVertex.push_back((unsigned int)v);
+		}
+	}
+	return sourceVertex;
+}
+
+//--------------------------------------------------------------
+Result optimize(std::vector<unsigned int> & indices, size_t vertexCount, int cacheSize) {
+	Result result;
+	result.acmrBefore = computeACMR(indices, vertexCount, cacheSize);
+	optimizeVertexCache(indices, vertexCount, cacheSize);
+	result.sourceVertex = optimizeVertexFetch(indices, vertexCount);
+	result.acmrAfter = computeACMR(indices, vertexCount, cacheSize);
+	return result;
+}
+
+//--------------------------------------------------------------
+Result optimize(std::vector<unsigned int> & indices, size_t vertexCount, const std::vector<IndexRange> & ranges,
+	int cacheSize, int workers) {
+	Result result;
+	result.acmrBefore = computeACMR(indices, vertexCount, cacheSize);
+	optimizeVertexCache(indices, ranges, cacheSize, workers);
+	result.sourceVertex = optimizeVertexFetch(indices, vertexCount);
+	result.acmrAfter = computeACMR(indices, vertexCount, cacheSize);
+	return result;
+}
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// Index/vertex reordering for GPU locality. GL-independent: works on the
+// index buffer of an ofMesh plus its vertex count.
+namespace MeshOptimizer {
+
+// Post-transform cache size assumed by the reordering and the ACMR metric.
+const int kDefaultCacheSize = 16;
+
+// A contiguous slice of the index buffer, e.g. one submesh of a merged scene.
+struct IndexRange {
+	size_t offset = 0;
+	size_t count = 0;
+};
+
+// Average cache miss ratio: vertex shader invocations per triangle for a
+// FIFO post-transform cache of `cacheSize` entries. 0.5 is the optimum for
+// large regular grids, 3.0 means no reuse at all.
+float computeACMR(const std::vector<unsigned int> & indices, size_t vertexCount, int cacheSize = kDefaultCacheSize);
+
+// Tipsify (Sander, Nehab & Barczak 2007): reorders triangles in place so
+// that consecutive triangles fan around recently used vertices. Linear time.
+void optimizeVertexCache(std::vector<unsigned int> & indices, size_t vertexCount, int cacheSize = kDefaultCacheSize);
+
+// Same, but triangles only move within their own range so per-submesh draw
+// ranges stay valid. Ranges are independent and run on `workers` threads.
+void optimizeVertexCache(std::vector<unsigned int> & indices, const std::vector<IndexRange> & ranges,
+	int cacheSize = kDefaultCacheSize, int workers = 0);
+
+// Renumbers vertices in the order the index buffer first touches them, so
+// attribute and TBO fetches walk memory forwards. Indices are rewritten in
+// place; unreferenced vertices keep their relative order at the end.
+// Returns new vertex -> old vertex (see MeshProcessing::remapAttribute).
+std::vector<unsigned int> optimizeVertexFetch(std::vector<unsigned int> & indices, size_t vertexCount);
+
+// Both passes plus the before/after metric.
+struct Result {
+	std::vector<unsigned int> sourceVertex; // new vertex -> old vertex
+	float acmrBefore = 0.0f;
+	float acmrAfter = 0.0f;
+};
+
+Result optimize(std::vector<unsigned int> & indices, size_t vertexCount, int cacheSize = kDefaultCacheSize);
+Result optimize(std::vector<unsigned int> & indices, size_t vertexCount, const std::vector<IndexRange> & ranges,
+	int cacheSize = kDefaultCacheSize, int workers = 0);
+
+}
@@ -0,0 +1,425 @@
+#include "MeshProcessing.h"
+#include "utils/ParallelFor.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#include <xmmintrin.h>
+	#define MESH_PROCESSING_SSE 1
+#endif
+
+namespace MeshProcessing {
+
+static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "glm::vec3 must be tightly packed");
+
+// Below this many elements per chunk the thread start-up cost dominates.
+static const size_t kMinChunkSize = 16384;
+
+//--------------------------------------------------------------
+float Bounds::getMaxDimension() const {
+	glm::vec3 size = getSize();
+	return std::max({ size.x, size.y, size.z });
+}
+
+//--------------------------------------------------------------
+static void reduceBoundsRange(const glm::vec3 * vertices, size_t count, glm::vec3 & outMin, glm::vec3 & outMax) {
+	float minX = std::numeric_limits<float>::max();
+	float minY = minX, minZ = minX;
+	float maxX = std::numeric_limits<float>::lowest();
+	float maxY = maxX, maxZ = maxX;
+
+	size_t i = 0;
+
+#ifdef MESH_PROCESSING_SSE
+	// Four vec3s are twelve floats, i.e. exactly three SSE registers:
+	//   a = x0 y0 z0 x1 | b = y1 z1 x2 y2 | c = z2 x3 y3 z3
+	// Each register keeps its own lane-wise min/max and the lanes are folded
+	// back into x/y/z once at the end.
+	if (count >= 4) {
+		const float * data = &vertices[0].x;
+		__m128 minA = _mm_loadu_ps(data), maxA = minA;
+		__m128 minB = _mm_loadu_ps(data + 4), maxB = minB;
+		__m128 minC = _mm_loadu_ps(data + 8), maxC = minC;
+
+		for (i = 4; i + 4 <= count; i += 4) {
+			const float * p = data + i * 3;
+			__m128 a = _mm_loadu_ps(p);
+			__m128 b = _mm_loadu_ps(p + 4);
+			__m128 c = _mm_loadu_ps(p + 8);
+			minA = _mm_min_ps(minA, a);
+			maxA = _mm_max_ps(maxA, a);
+			minB = _mm_min_ps(minB, b);
+			maxB = _mm_max_ps(maxB, b);
+			minC = _mm_min_ps(minC, c);
+			maxC = _mm_max_ps(maxC, c);
+		}
+
+		alignas(16) float lo[12], hi[12];
+		_mm_store_ps(lo, minA);
+		_mm_store_ps(lo + 4, minB);
+		_mm_store_ps(lo + 8, minC);
+		_mm_store_ps(hi, maxA);
+		_mm_store_ps(hi + 4, maxB);
+		_mm_store_ps(hi + 8, maxC);
+
+		for (int k = 0; k < 12; k += 3) {
+			minX = std::min(minX, lo[k]);
+			minY = std::min(minY, lo[k + 1]);
+			minZ = std::min(minZ, lo[k + 2]);
+			maxX = std::max(maxX, hi[k]);
+			maxY = std::max(maxY, hi[k + 1]);
+			maxZ = std::max(maxZ, hi[k + 2]);
+		}
+	}
+#endif
+
+	for (; i < count; i++) {
+		const glm::vec3 & v = vertices[i];
+		minX = std::min(minX, v.x);
+		minY = std::min(minY, v.y);
+		minZ = std::min(minZ, v.z);
+		maxX = std::max(maxX, v.x);
+		maxY = std::max(maxY, v.y);
+		maxZ = std::max(maxZ, v.z);
+	}
+
+	outMin = glm::vec3(minX, minY, minZ);
+	outMax = glm::vec3(maxX, maxY, maxZ);
+}
+
+//--------------------------------------------------------------
+Bounds computeBounds(const std::vector<glm::vec3> & vertices, int workers) {
+	Bounds bounds;
+	if (vertices.empty()) return bounds;
+
+	int threadCount = resolveWorkerCount(workers);
+	int chunks = getChunkCount(vertices.size(), threadCount, kMinChunkSize);
+	std::vector<glm::vec3> chunkMin(chunks), chunkMax(chunks);
+
+	parallelForChunks(vertices.size(), threadCount, kMinChunkSize, [&](size_t begin, size_t end, int chunk) {
+		reduceBoundsRange(vertices.data() + begin, end - begin, chunkMin[chunk], chunkMax[chunk]);
+	});
+
+	bounds.min = chunkMin[0];
+	bounds.max = chunkMax[0];
+	for (int c = 1; c < chunks; c++) {
+		bounds.min = glm::min(bounds.min, chunkMin[c]);
+		bounds.max = glm::max(bounds.max, chunkMax[c]);
+	}
+	return bounds;
+}
+
+//--------------------------------------------------------------
+void buildVertexFaceAdjacency(size_t vertexCount, const std::vector<unsigned int> & indices, VertexFaceAdjacency & outAdjacency) {
+	size_t faceCount = indices.size() / 3;
+	auto & offsets = outAdjacency.offsets;
+	auto & faces = outAdjacency.faces;
+
+	offsets.assign(vertexCount + 1, 0);
+	for (size_t f = 0; f < faceCount; f++) {
+		for (int k = 0; k < 3; k++) {
+			unsigned int v = indices[f * 3 + k];
+			if (v < vertexCount) offsets[v + 1]++;
+		}
+	}
+	for (size_t v = 0; v < vertexCount; v++) {
+		offsets[v + 1] += offsets[v];
+	}
+
+	faces.resize(offsets[vertexCount]);
+	std::vector<unsigned int> cursor(offsets.begin(), offsets.end() - 1);
+	for (size_t f = 0; f < faceCount; f++) {
+		for (int k = 0; k < 3; k++) {
+			unsigned int v = indices[f * 3 + k];
+			if (v < vertexCount) faces[cursor[v]++] = (unsigned int)f;
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void computeVertexNormals(const std::vector<glm::vec3> & vertices, const std::vector<unsigned int> & indices,
+	std::vector<glm::vec3> & outNormals, int workers) {
+	size_t vertexCount = vertices.size();
+	size_t faceCount = indices.size() / 3;
+	outNormals.assign(vertexCount, glm::vec3(0.0f));
+	if (vertexCount == 0 || faceCount == 0) return;
+
+	int threadCount = resolveWorkerCount(workers);
+
+	// 1. Unnormalized face normals; their length is twice the face area,
+	//    which gives the area weighting for free.
+	std::vector<glm::vec3> faceNormals(faceCount);
+	parallelForChunks(faceCount, threadCount, kMinChunkSize, [&](size_t begin, size_t end, int) {
+		for (size_t f = begin; f < end; f++) {
+			unsigned int i0 = indices[f * 3];
+			unsigned int i1 = indices[f * 3 + 1];
+			unsigned int i2 = indices[f * 3 + 2];
+			if (i0 < vertexCount && i1 < vertexCount && i2 < vertexCount) {
+				faceNormals[f] = glm::cross(vertices[i1] - vertices[i0], vertices[i2] - vertices[i0]);
+			} else {
+				faceNormals[f] = glm::vec3(0.0f);
+			}
+		}
+	});
+
+	// 2. Gather per vertex. Each thread owns a disjoint vertex range.
+	VertexFaceAdjacency adjacency;
+	buildVertexFaceAdjacency(vertexCount, indices, adjacency);
+
+	parallelForChunks(vertexCount, threadCount, kMinChunkSize, [&](size_t begin, size_t end, int) {
+		for (size_t v = begin; v < end; v++) {
+			glm::vec3 sum(0.0f);
+			for (unsigned int k = adjacency.offsets[v]; k < adjacency.offsets[v + 1]; k++) {
+				sum += faceNormals[adjacency.faces[k]];
+			}
+			float len = glm::length(sum);
+			outNormals[v] = len > 0.0f ? sum / len : sum;
+		}
+	});
+}
+
+//--------------------------------------------------------------
+void translateAndScale(std::vector<glm::vec3> & vertices, const glm::vec3 & center, float scale, int workers) {
+	parallelForChunks(vertices.size(), resolveWorkerCount(workers), kMinChunkSize, [&](size_t begin, size_t end, int) {
+		glm::vec3 * v = vertices.data();
+		for (size_t i = begin; i < end; i++) {
+			v[i] = (v[i] - center) * scale;
+		}
+	});
+}
+
+//--------------------------------------------------------------
+static uint64_t hashCell(int x, int y, int z) {
+	// Large primes from the usual spatial hashing scheme, widened to 64 bit
+	uint64_t h = (uint64_t)(uint32_t)x * 73856093ull;
+	h ^= (uint64_t)(uint32_t)y * 19349663ull;
+	h ^= (uint64_t)(uint32_t)z * 83492791ull;
+	return h * 0x9E3779B97F4A7C15ull;
+}
+
+//--------------------------------------------------------------
+WeldResult weldVertices(std::vector<glm::vec3> & vertices, std::vector<unsigned int> & indices,
+	float tolerance, const std::vector<glm::vec2> * texCoords, float uvTolerance, int workers) {
+	WeldResult result;
+	size_t vertexCount = vertices.size();
+	if (vertexCount == 0) return result;
+
+	int threadCount = resolveWorkerCount(workers);
+	float cellSize = std::max(tolerance, 1e-6f);
+	float toleranceSq = tolerance * tolerance;
+	bool matchUV = texCoords && texCoords->size() == vertexCount;
+
+	// 1. Hash every vertex into its grid cell and sort (key, vertex) pairs so
+	//    each cell becomes a contiguous run.
+	struct CellEntry {
+		uint64_t key;
+		unsigned int vertex;
+	};
+	std::vector<CellEntry> entries(vertexCount);
+	std::vector<glm::ivec3> cells(vertexCount);
+	parallelForChunks(vertexCount, threadCount, kMinChunkSize, [&](size_t begin, size_t end, int) {
+		for (size_t i = begin; i < end; i++) {
+			const glm::vec3 & p = vertices[i];
+			glm::ivec3 c((int)std::floor(p.x / cellSize), (int)std::floor(p.y / cellSize), (int)std::floor(p.z / cellSize));
+			cells[i] = c;
+			entries[i] = { hashCell(c.x, c.y, c.z), (unsigned int)i };
+		}
+	});
+	parallelSort(entries, threadCount, kMinChunkSize, [](const CellEntry & a, const CellEntry & b) {
+		return a.key != b.key ? a.key < b.key : a.vertex < b.vertex;
+	});
+
+	// 2. For every vertex find the lowest-indexed vertex within tolerance in
+	//    the surrounding 3x3x3 cells. Hash collisions only add candidates that
+	//    the distance test rejects.
+	std::vector<unsigned int> representative(vertexCount);
+	parallelForChunks(vertexCount, threadCount, kMinChunkSize, [&](size_t begin, size_t end, int) {
+		for (size_t i = begin; i < end; i++) {
+			const glm::vec3 & p = vertices[i];
+			const glm::ivec3 & c = cells[i];
+			unsigned int best = (unsigned int)i;
+
+			for (int dz = -1; dz <= 1; dz++) {
+				for (int dy = -1; dy <= 1; dy++) {
+					for (int dx = -1; dx <= 1; dx++) {
+						uint64_t key = hashCell(c.x + dx, c.y + dy, c.z + dz);
+						auto it = std::lower_bound(entries.begin(), entries.end(), key,
+							[](const CellEntry & e, uint64_t k) { return e.key < k; });
+
+						// Entries within a cell are sorted by vertex, so stop at the first
+						// one that cannot beat the current best.
+						for (; it != entries.end() && it->key == key && it->vertex < best; ++it) {
+							glm::vec3 d = vertices[it->vertex] - p;
+							if (glm::dot(d, d) > toleranceSq) continue;
+							if (matchUV) {
+								glm::vec2 duv = (*texCoords)[it->vertex] - (*texCoords)[i];
+								if (std::abs(duv.x) > uvTolerance || std::abs(duv.y) > uvTolerance) continue;
+							}
+							best = it->vertex;
+							break;
+						}
+					}
+				}
+			}
+			representative[i] = best;
+		}
+	});
+
+	// 3. representative[i] <= i, so one forward pass resolves chains and
+	//    assigns compact indices in first-occurrence order.
+	std::vector<unsigned int> remap(vertexCount);
+	result.sourceVertex.reserve(vertexCount);
+	for (size_t i = 0; i < vertexCount; i++) {
+		if (representative[i] == i) {
+			remap[i] = (unsigned int)result.sourceVertex.size();
+			result.sourceVertex.push_back((unsigned int)i);
+		} else {
+			remap[i] = remap[representative[i]];
+		}
+	}
+
+	remapAttribute(vertices, result.sourceVertex);
+
+	// 4. Remap the index buffer and drop triangles that collapsed.
+	size_t faceCount = indices.size() / 3;
+	size_t written = 0;
+	result.keptTriangles.reserve(faceCount);
+	for (size_t f = 0; f < faceCount; f++) {
+		unsigned int a = indices[f * 3], b = indices[f * 3 + 1], c = indices[f * 3 + 2];
+		if (a >= vertexCount || b >= vertexCount || c >= vertexCount) {
+			result.removedTriangles++;
+			continue;
+		}
+		a = remap[a];
+		b = remap[b];
+		c = remap[c];
+		if (a == b || b == c || a == c) {
+			result.removedTriangles++;
+			continue;
+		}
+		indices[written++] = a;
+		indices[written++] = b;
+		indices[written++] = c;
+		result.keptTriangles.push_back((unsigned int)f);
+	}
+	indices.resize(written);
+
+	return result;
+}
+
+//--------------------------------------------------------------
+SmoothResult smoothNormals(std::vector<glm::vec3> & vertices, std::vector<unsigned int> & indices,
+	std::vector<glm::vec3> & outNormals, float creaseAngleDeg, int workers) {
+	SmoothResult result;
+	size_t vertexCount = vertices.size();
+	size_t faceCount = indices.size() / 3;
+	if (vertexCount == 0) return result;
+
+	int threadCount = resolveWorkerCount(workers);
+	float cosCrease = std::cos(glm::radians(glm::clamp(creaseAngleDeg, 0.0f, 180.0f)));
+
+	// 1. Unit face normals and the interior angle at each corner
+	std::vector<glm::vec3> faceNormals(faceCount);
+	std::vector<float> cornerAngles(faceCount * 3);
+	parallelForChunks(faceCount, threadCount, kMinChunkSize, [&](size_t begin, size_t end, int) {
+		for (size_t f = begin; f < end; f++) {
+			unsigned int idx[3] = { indices[f * 3], indices[f * 3 + 1], indices[f * 3 + 2] };
+			if (idx[0] >= vertexCount || idx[1] >= vertexCount || idx[2] >= vertexCount) {
+				faceNormals[f] = glm::vec3(0.0f);
+				cornerAngles[f * 3] = cornerAngles[f * 3 + 1] = cornerAngles[f * 3 + 2] = 0.0f;
+				continue;
+			}
+
+			glm::vec3 n = glm::cross(vertices[idx[1]] - vertices[idx[0]], vertices[idx[2]] - vertices[idx[0]]);
+			float len = glm::length(n);
+			faceNormals[f] = len > 0.0f ? n / len : n;
+
+			for (int k = 0; k < 3; k++) {
+				glm::vec3 e0 = vertices[idx[(k + 1) % 3]] - vertices[idx[k]];
+				glm::vec3 e1 = vertices[idx[(k + 2) % 3]] - vertices[idx[k]];
+				float l0 = glm::length(e0), l1 = glm::length(e1);
+				cornerAngles[f * 3 + k] = (l0 > 0.0f && l1 > 0.0f)
+					? std::acos(glm::clamp(glm::dot(e0, e1) / (l0 * l1), -1.0f, 1.0f))
+					: 0.0f;
+			}
+		}
+	});
+
+	VertexFaceAdjacency adjacency;
+	buildVertexFaceAdjacency(vertexCount, indices, adjacency);
+
+	// 2. Group the faces around each vertex by crease angle. slotGroup holds
+	//    the group id of every adjacency slot, groupCount the groups per vertex.
+	std::vector<unsigned int> slotGroup(adjacency.faces.size());
+	std::vector<unsigned int> groupCount(vertexCount, 1);
+	parallelForChunks(vertexCount, threadCount, kMinChunkSize, [&](size_t begin, size_t end, int) {
+		for (size_t v = begin; v < end; v++) {
+			unsigned int first = adjacency.offsets[v], last = adjacency.offsets[v + 1];
+			const unsigned int unassigned = std::numeric_limits<unsigned int>::max();
+			for (unsigned int s = first; s < last; s++) slotGroup[s] = unassigned;
+
+			unsigned int groups = 0;
+			for (unsigned int s = first; s < last; s++) {
+				if (slotGroup[s] != unassigned) continue;
+				const glm::vec3 & seed = faceNormals[adjacency.faces[s]];
+				for (unsigned int t = s; t < last; t++) {
+					if (slotGroup[t] == unassigned && glm::dot(seed, faceNormals[adjacency.faces[t]]) >= cosCrease) {
+						slotGroup[t] = groups;
+					}
+				}
+				groups++;
+			}
+			groupCount[v] = std::max(1u, groups);
+		}
+	});
+
+	// 3. Group 0 keeps the original vertex; extra groups are appended.
+	std::vector<unsigned int> extraOffset(vertexCount + 1, 0);
+	for (size_t v = 0; v < vertexCount; v++) {
+		extraOffset[v + 1] = extraOffset[v] + groupCount[v] - 1;
+	}
+	result.splitVertices = extraOffset[vertexCount];
+	size_t newVertexCount = vertexCount + result.splitVertices;
+
+	result.sourceVertex.resize(newVertexCount);
+	outNormals.assign(newVertexCount, glm::vec3(0.0f));
+	const std::vector<unsigned int> originalIndices = indices;
+
+	// 4. Accumulate angle-weighted normals per group and point each corner at
+	//    its group's vertex. Every corner belongs to exactly one vertex, so
+	//    threads never write the same index or normal.
+	parallelForChunks(vertexCount, threadCount, kMinChunkSize, [&](size_t begin, size_t end, int) {
+		for (size_t v = begin; v < end; v++) {
+			auto groupVertex = [&](unsigned int g) {
+				return g == 0 ? (unsigned int)v : (unsigned int)(vertexCount + extraOffset[v] + g - 1);
+			};
+
+			for (unsigned int g = 0; g < groupCount[v]; g++) {
+				result.sourceVertex[groupVertex(g)] = (unsigned int)v;
+			}
+
+			for (unsigned int s = adjacency.offsets[v]; s < adjacency.offsets[v + 1]; s++) {
+				unsigned int f = adjacency.faces[s];
+				for (int k = 0; k < 3; k++) {
+					if (originalIndices[f * 3 + k] != v) continue;
+					unsigned int target = groupVertex(slotGroup[s]);
+					outNormals[target] += faceNormals[f] * cornerAngles[f * 3 + k];
+					indices[f * 3 + k] = target;
+				}
+			}
+
+			for (unsigned int g = 0; g < groupCount[v]; g++) {
+				glm::vec3 & n = outNormals[groupVertex(g)];
+				float len = glm::length(n);
+				if (len > 0.0f) n /= len;
+			}
+		}
+	});
+
+	remapAttribute(vertices, result.sourceVertex);
+	return result;
+}
+
+}
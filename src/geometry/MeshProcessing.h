@@ -0,0 +1,94 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+
+// GL-independent mesh kernels used by ModelLoader's post-processing pipeline.
+// Every stage works directly on the vertex/index arrays of an ofMesh
+// (std::vector<glm::vec3> / std::vector<unsigned int>) and splits its work
+// across `workers` threads (0 = all hardware threads).
+namespace MeshProcessing {
+
+struct Bounds {
+	glm::vec3 min = glm::vec3(0.0f);
+	glm::vec3 max = glm::vec3(0.0f);
+
+	glm::vec3 getCenter() const { return (min + max) * 0.5f; }
+	glm::vec3 getSize() const { return max - min; }
+	float getMaxDimension() const;
+};
+
+// Single min/max reduction over all vertices (SSE where available).
+Bounds computeBounds(const std::vector<glm::vec3> & vertices, int workers = 0);
+
+// Area-weighted vertex normals. Face normals are computed once, then each
+// vertex gathers from its incident faces through a vertex-to-face CSR
+// adjacency, so no two threads ever write the same normal.
+void computeVertexNormals(const std::vector<glm::vec3> & vertices,
+	const std::vector<unsigned int> & indices,
+	std::vector<glm::vec3> & outNormals,
+	int workers = 0);
+
+// Fused center-and-scale pass: v = (v - center) * scale.
+void translateAndScale(std::vector<glm::vec3> & vertices, const glm::vec3 & center, float scale, int workers = 0);
+
+// Vertex-to-face adjacency in compressed sparse row form: the faces touching
+// vertex v are faces[offsets[v]] .. faces[offsets[v + 1] - 1].
+struct VertexFaceAdjacency {
+	std::vector<unsigned int> offsets;
+	std::vector<unsigned int> faces;
+};
+
+void buildVertexFaceAdjacency(size_t vertexCount,
+	const std::vector<unsigned int> & indices,
+	VertexFaceAdjacency & outAdjacency);
+
+// === Vertex welding ===
+// Merges vertices closer than `tolerance` using a spatial hash grid with
+// cell size == tolerance, so each vertex only tests its own and the 26
+// neighbouring cells. If texCoords is given, vertices only merge when their
+// texture coordinates also match within uvTolerance, which keeps UV seams
+// intact. `tolerance` is in model units, uvTolerance in texture coordinates.
+// Vertices are compacted in first-occurrence order, the index buffer is
+// remapped in place and triangles that collapse are dropped.
+struct WeldResult {
+	std::vector<unsigned int> sourceVertex; // new vertex -> original vertex it was copied from
+	std::vector<unsigned int> keptTriangles; // new triangle -> original triangle, ascending
+	size_t removedTriangles = 0;
+};
+
+WeldResult weldVertices(std::vector<glm::vec3> & vertices,
+	std::vector<unsigned int> & indices,
+	float tolerance,
+	const std::vector<glm::vec2> * texCoords = nullptr,
+	float uvTolerance = 1e-5f,
+	int workers = 0);
+
+// === Normal smoothing ===
+// Angle-weighted vertex normals with a crease threshold. Around each vertex
+// the incident faces are grouped so that faces within `creaseAngleDeg` of a
+// group's seed face share one smoothed normal; every extra group becomes a
+// new vertex appended after the originals, and the index buffer is rewritten
+// to reference it. Hard edges stay sharp, curved surfaces become smooth.
+struct SmoothResult {
+	std::vector<unsigned int> sourceVertex; // new vertex -> original vertex it was copied from
+	size_t splitVertices = 0;
+};
+
+SmoothResult smoothNormals(std::vector<glm::vec3> & vertices,
+	std::vector<unsigned int> & indices,
+	std::vector<glm::vec3> & outNormals,
+	float creaseAngleDeg,
+	int workers = 0);
+
+// Gather an attribute array through a sourceVertex table.
+template <typename T>
+void remapAttribute(std::vector<T> & attribute, const std::vector<unsigned int> & sourceVertex) {
+	if (attribute.empty()) return;
+	std::vector<T> remapped(sourceVertex.size());
+	for (size_t i = 0; i < sourceVertex.size(); i++) {
+		remapped[i] = attribute[sourceVertex[i]];
+	}
+	attribute.swap(remapped);
+}
+
+}
@@ -0,0 +1,425 @@
+#include "MeshSimplifier.h"
+#include "MeshProcessing.h"
+#include "utils/ParallelFor.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+// Symmetric 4x4 error quadric, upper triangle only
+struct Quadric {
+	double a00 = 0, a01 = 0, a02 = 0, a03 = 0;
+	double a11 = 0, a12 = 0, a13 = 0;
+	double a22 = 0, a23 = 0;
+	double a33 = 0;
+
+	static Quadric fromPlane(const glm::vec3 & n, double d, double weight) {
+		Quadric q;
+		q.a00 = weight * n.x * n.x;
+		q.a01 = weight * n.x * n.y;
+		q.a02 = weight * n.x * n.z;
+		q.a03 = weight * n.x * d;
+		q.a11 = weight * n.y * n.y;
+		q.a12 = weight * n.y * n.z;
+		q.a13 = weight * n.y * d;
+		q.a22 = weight * n.z * n.z;
+		q.a23 = weight * n.z * d;
+		q.a33 = weight * d * d;
+		return q;
+	}
+
+	Quadric & operator+=(const Quadric & o) {
+		a00 += o.a00; a01 += o.a01; a02 += o.a02; a03 += o.a03;
+		a11 += o.a11; a12 += o.a12; a13 += o.a13;
+		a22 += o.a22; a23 += o.a23;
+		a33 += o.a33;
+		return *this;
+	}
+
+	double evaluate(const glm::vec3 & p) const {
+		double x = p.x, y = p.y, z = p.z;
+		return a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z + 2 * a03 * x
+			+ a11 * y * y + 2 * a12 * y * z + 2 * a13 * y
+			+ a22 * z * z + 2 * a23 * z
+			+ a33;
+	}
+
+	// Minimizer of the quadric, if the 3x3 system is well conditioned
+	bool optimum(glm::vec3 & out) const {
+		double det = a00 * (a11 * a22 - a12 * a12) - a01 * (a01 * a22 - a12 * a02) + a02 * (a01 * a12 - a11 * a02);
+		if (std::abs(det) < 1e-12) return false;
+		double inv = 1.0 / det;
+		double bx = -a03, by = -a13, bz = -a23;
+		out.x = (float)(inv * (bx * (a11 * a22 - a12 * a12) - a01 * (by * a22 - a12 * bz) + a02 * (by * a12 - a11 * bz)));
+		out.y = (float)(inv * (a00 * (by * a22 - a12 * bz) - bx * (a01 * a22 - a12 * a02) + a02 * (a01 * bz - by * a02)));
+		out.z = (float)(inv * (a00 * (a11 * bz - by * a12) - a01 * (a01 * bz - by * a02) + bx * (a01 * a12 - a11 * a02)));
+		return true;
+	}
+};
+
+struct Candidate {
+	float cost;
+	unsigned int keep;
+	unsigned int remove;
+	unsigned int keepVersion;
+	unsigned int removeVersion;
+	glm::vec3 position;
+
+	bool operator<(const Candidate & o) const { return cost > o.cost; } // min-heap
+};
+
+struct SimplifyState {
+	std::vector<glm::vec3> positions;
+	std::vector<unsigned int> triangles;
+	std::vector<char> triangleAlive;
+	std::vector<Quadric> quadrics;
+	std::vector<std::vector<unsigned int>> vertexTriangles;
+	std::vector<unsigned int> version;
+	std::vector<char> removed;
+	std::vector<char> borderLocked;
+	std::vector<char> seamLocked; // rebuilt every round
+	std::vector<int> partition; // rebuilt every round
+	const MeshSimplifier::Settings * settings = nullptr;
+
+	bool isLocked(unsigned int v) const { return borderLocked[v] || seamLocked[v]; }
+};
+
+const size_t kMinChunkSize = 16384;
+
+//--------------------------------------------------------------
+void initQuadrics(SimplifyState & s, int workers) {
+	size_t vertexCount = s.positions.size();
+	size_t faceCount = s.triangles.size() / 3;
+
+	std::vector<Quadric> faceQuadrics(faceCount);
+	parallelForChunks(faceCount, workers, kMinChunkSize, [&](size_t begin, size_t end, int) {
+		for (size_t f = begin; f < end; f++) {
+			const glm::vec3 & p0 = s.positions[s.triangles[f * 3]];
+			const glm::vec3 & p1 = s.positions[s.triangles[f * 3 + 1]];
+			const glm::vec3 & p2 = s.positions[s.triangles[f * 3 + 2]];
+			glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+			float len = glm::length(n);
+			if (len <= 0.0f) continue;
+			n /= len;
+			faceQuadrics[f] = Quadric::fromPlane(n, -glm::dot(n, p0), len * 0.5);
+		}
+	});
+
+	MeshProcessing::VertexFaceAdjacency adjacency;
+	MeshProcessing::buildVertexFaceAdjacency(vertexCount, s.triangles, adjacency);
+
+	s.quadrics.assign(vertexCount, Quadric());
+	s.vertexTriangles.assign(vertexCount, std::vector<unsigned int>());
+	parallelForChunks(vertexCount, workers, kMinChunkSize, [&](size_t begin, size_t end, int) {
+		for (size_t v = begin; v < end; v++) {
+			auto & tris = s.vertexTriangles[v];
+			tris.assign(adjacency.faces.begin() + adjacency.offsets[v], adjacency.faces.begin() + adjacency.offsets[v + 1]);
+			for (unsigned int f : tris) {
+				s.quadrics[v] += faceQuadrics[f];
+			}
+		}
+	});
+}
+
+//--------------------------------------------------------------
+void lockBorderVertices(SimplifyState & s, int workers) {
+	s.borderLocked.assign(s.positions.size(), 0);
+	if (!s.settings->lockBorders) return;
+
+	// An edge used by exactly one triangle lies on an open border
+	size_t faceCount = s.triangles.size() / 3;
+	std::vector<uint64_t> edges(faceCount * 3);
+	for (size_t f = 0; f < faceCount; f++) {
+		for (int k = 0; k < 3; k++) {
+			uint64_t a = s.triangles[f * 3 + k], b = s.triangles[f * 3 + (k + 1) % 3];
+			edges[f * 3 + k] = (std::min(a, b) << 32) | std::max(a, b);
+		}
+	}
+	parallelSort(edges, workers, kMinChunkSize, std::less<uint64_t>());
+
+	for (size_t i = 0; i < edges.size();) {
+		size_t j = i + 1;
+		while (j < edges.size() && edges[j] == edges[i]) j++;
+		if (j - i == 1) {
+			s.borderLocked[edges[i] >> 32] = 1;
+			s.borderLocked[edges[i] & 0xffffffffu] = 1;
+		}
+		i = j;
+	}
+}
+
+//--------------------------------------------------------------
+bool makeCandidate(const SimplifyState & s, unsigned int a, unsigned int b, Candidate & out) {
+	bool lockA = s.isLocked(a), lockB = s.isLocked(b);
+	if (lockA && lockB) return false;
+	if (lockB) std::swap(a, b); // a locked vertex is always the one kept in place
+
+	Quadric q = s.quadrics[a];
+	q += s.quadrics[b];
+
+	glm::vec3 p;
+	glm::vec3 mid = (s.positions[a] + s.positions[b]) * 0.5f;
+	float edgeLength = glm::length(s.positions[a] - s.positions[b]);
+	if (s.isLocked(a)) {
+		p = s.positions[a];
+	} else if (!q.optimum(p) || glm::length(p - mid) > 2.0f * edgeLength) {
+		// Ill-conditioned (flat or linear neighbourhood): best of endpoints and midpoint
+		double ea = q.evaluate(s.positions[a]), eb = q.evaluate(s.positions[b]), em = q.evaluate(mid);
+		p = (ea <= eb && ea <= em) ? s.positions[a] : (eb <= em ? s.positions[b] : mid);
+	}
+
+	out.cost = (float)std::max(0.0, q.evaluate(p));
+	out.keep = a;
+	out.remove = b;
+	out.keepVersion = s.version[a];
+	out.removeVersion = s.version[b];
+	out.position = p;
+	return true;
+}
+
+//--------------------------------------------------------------
+bool collapseFlipsTriangles(const SimplifyState & s, const Candidate & c) {
+	for (unsigned int v : { c.keep, c.remove }) {
+		for (unsigned int t : s.vertexTriangles[v]) {
+			if (!s.triangleAlive[t]) continue;
+			const unsigned int * tri = &s.triangles[t * 3];
+			bool hasKeep = tri[0] == c.keep || tri[1] == c.keep || tri[2] == c.keep;
+			bool hasRemove = tri[0] == c.remove || tri[1] == c.remove || tri[2] == c.remove;
+			if (hasKeep && hasRemove) continue; // this triangle disappears
+
+			glm::vec3 p[3], q[3];
+			for (int k = 0; k < 3; k++) {
+				p[k] = s.positions[tri[k]];
+				q[k] = (tri[k] == v) ? c.position : p[k];
+			}
+			glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+			glm::vec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+			float lb = glm::length(before), la = glm::length(after);
+			if (la <= 0.0f) return true;
+			if (lb > 0.0f && glm::dot(before, after) < s.settings->minNormalDot * lb * la) return true;
+		}
+	}
+	return false;
+}
+
+//--------------------------------------------------------------
+void pushVertexEdges(const SimplifyState & s, unsigned int v, int part, std::vector<Candidate> & heap) {
+	for (unsigned int t : s.vertexTriangles[v]) {
+		if (!s.triangleAlive[t]) continue;
+		for (int k = 0; k < 3; k++) {
+			unsigned int n = s.triangles[t * 3 + k];
+			if (n == v || s.partition[n] != part) continue;
+			Candidate c;
+			if (makeCandidate(s, v, n, c)) {
+				heap.push_back(c);
+				std::push_heap(heap.begin(), heap.end());
+			}
+		}
+	}
+}
+
+//--------------------------------------------------------------
+// Collapse edges of one partition until `goal` of its triangles remain.
+// Only touches vertices of this partition and triangles made solely of them,
+// so partitions can run concurrently.
+size_t simplifyPartition(SimplifyState & s, int part, const std::vector<unsigned int> & partTriangles, size_t goal, float & maxError) {
+	std::vector<Candidate> heap;
+	for (unsigned int t : partTriangles) {
+		for (int k = 0; k < 3; k++) {
+			unsigned int a = s.triangles[t * 3 + k], b = s.triangles[t * 3 + (k + 1) % 3];
+			Candidate c;
+			if (makeCandidate(s, a, b, c)) heap.push_back(c);
+		}
+	}
+	std::make_heap(heap.begin(), heap.end());
+
+	size_t alive = partTriangles.size();
+	while (alive > goal && !heap.empty()) {
+		std::pop_heap(heap.begin(), heap.end());
+		Candidate c = heap.back();
+		heap.pop_back();
+
+		if (s.removed[c.keep] || s.removed[c.remove]) continue;
+		if (s.version[c.keep] != c.keepVersion || s.version[c.remove] != c.removeVersion) continue;
+		if (c.cost > s.settings->maxError) break;
+		if (collapseFlipsTriangles(s, c)) continue;
+
+		auto & keepTris = s.vertexTriangles[c.keep];
+		for (unsigned int t : s.vertexTriangles[c.remove]) {
+			if (!s.triangleAlive[t]) continue;
+			unsigned int * tri = &s.triangles[t * 3];
+			if (tri[0] == c.keep || tri[1] == c.keep || tri[2] == c.keep) {
+				s.triangleAlive[t] = 0;
+				alive--;
+				continue;
+			}
+			for (int k = 0; k < 3; k++) {
+				if (tri[k] == c.remove) tri[k] = c.keep;
+			}
+			keepTris.push_back(t);
+		}
+		keepTris.erase(std::remove_if(keepTris.begin(), keepTris.end(),
+						   [&](unsigned int t) { return !s.triangleAlive[t]; }),
+			keepTris.end());
+		s.vertexTriangles[c.remove].clear();
+
+		s.positions[c.keep] = c.position;
+		s.quadrics[c.keep] += s.quadrics[c.remove];
+		s.removed[c.remove] = 1;
+		s.version[c.keep]++;
+		s.version[c.remove]++;
+		maxError = std::max(maxError, c.cost);
+
+		pushVertexEdges(s, c.keep, part, heap);
+	}
+	return partTriangles.size() - alive;
+}
+
+//--------------------------------------------------------------
+// One parallel round over a grid of partitions. `shift` offsets the grid by
+// a fraction of a cell so seams move between rounds.
+size_t simplifyRound(SimplifyState & s, size_t targetTriangles, size_t aliveTriangles, int workers, float shift, float & maxError) {
+	size_t vertexCount = s.positions.size();
+	size_t faceCount = s.triangles.size() / 3;
+
+	int gridDim = std::max(1, (int)std::round(std::cbrt((double)workers * 4)));
+	MeshProcessing::Bounds bounds = MeshProcessing::computeBounds(s.positions, workers);
+	glm::vec3 cellSize = glm::max(bounds.getSize() / (float)gridDim, glm::vec3(1e-6f));
+
+	s.partition.assign(vertexCount, -1);
+	parallelForChunks(vertexCount, workers, kMinChunkSize, [&](size_t begin, size_t end, int) {
+		for (size_t v = begin; v < end; v++) {
+			if (s.removed[v]) continue;
+			glm::vec3 cell = (s.positions[v] - bounds.min) / cellSize + shift;
+			int cx = std::min(gridDim, std::max(0, (int)cell.x));
+			int cy = std::min(gridDim, std::max(0, (int)cell.y));
+			int cz = std::min(gridDim, std::max(0, (int)cell.z));
+			s.partition[v] = (cz * (gridDim + 1) + cy) * (gridDim + 1) + cx;
+		}
+	});
+
+	int partitionCount = (gridDim + 1) * (gridDim + 1) * (gridDim + 1);
+	std::vector<std::vector<unsigned int>> partTriangles(partitionCount);
+	s.seamLocked.assign(vertexCount, 0);
+	for (size_t t = 0; t < faceCount; t++) {
+		if (!s.triangleAlive[t]) continue;
+		const unsigned int * tri = &s.triangles[t * 3];
+		int p = s.partition[tri[0]];
+		if (s.partition[tri[1]] == p && s.partition[tri[2]] == p) {
+			partTriangles[p].push_back((unsigned int)t);
+		} else {
+			s.seamLocked[tri[0]] = s.seamLocked[tri[1]] = s.seamLocked[tri[2]] = 1;
+		}
+	}
+
+	double keepFraction = aliveTriangles > 0 ? (double)targetTriangles / aliveTriangles : 1.0;
+	std::vector<size_t> removedPerPart(partitionCount, 0);
+	std::vector<float> errorPerPart(partitionCount, 0.0f);
+
+	parallelForChunks(partitionCount, workers, 1, [&](size_t begin, size_t end, int) {
+		for (size_t p = begin; p < end; p++) {
+			if (partTriangles[p].empty()) continue;
+			size_t goal = (size_t)std::ceil(partTriangles[p].size() * keepFraction);
+			removedPerPart[p] = simplifyPartition(s, (int)p, partTriangles[p], goal, errorPerPart[p]);
+		}
+	});
+
+	size_t removedTotal = 0;
+	for (int p = 0; p < partitionCount; p++) {
+		removedTotal += removedPerPart[p];
+		maxError = std::max(maxError, errorPerPart[p]);
+	}
+	return removedTotal;
+}
+
+}
+
+//--------------------------------------------------------------
+MeshSimplifier::Result MeshSimplifier::simplify(const std::vector<glm::vec3> & vertices,
+	const std::vector<unsigned int> & indices, const Settings & settings) {
+	Result result;
+	int workers = resolveWorkerCount(settings.workers);
+
+	SimplifyState s;
+	s.settings = &settings;
+	s.positions = vertices;
+	s.version.assign(vertices.size(), 0);
+	s.removed.assign(vertices.size(), 0);
+
+	// Drop out-of-range and degenerate triangles up front
+	s.triangles.reserve(indices.size());
+	for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+		unsigned int a = indices[i], b = indices[i + 1], c = indices[i + 2];
+		if (a >= vertices.size() || b >= vertices.size() || c >= vertices.size()) continue;
+		if (a == b || b == c || a == c) continue;
+		s.triangles.insert(s.triangles.end(), { a, b, c });
+	}
+	size_t faceCount = s.triangles.size() / 3;
+	s.triangleAlive.assign(faceCount, 1);
+
+	initQuadrics(s, workers);
+	lockBorderVertices(s, workers);
+
+	size_t target = (size_t)std::ceil(faceCount * glm::clamp(settings.targetRatio, 0.0f, 1.0f));
+	size_t alive = faceCount;
+	const float shifts[] = { 0.0f, 0.5f };
+	for (float shift : shifts) {
+		if (alive <= target) break;
+		alive -= simplifyRound(s, target, alive, workers, shift, result.maxError);
+		if (workers == 1) break; // a single partition has no seams to revisit
+	}
+
+	// Compact: surviving triangles and the vertices they reference
+	std::vector<unsigned int> remap(vertices.size(), ~0u);
+	result.indices.reserve(alive * 3);
+	for (size_t t = 0; t < faceCount; t++) {
+		if (!s.triangleAlive[t]) continue;
+		for (int k = 0; k < 3; k++) {
+			unsigned int v = s.triangles[t * 3 + k];
+			if (remap[v] == ~0u) {
+				remap[v] = (unsigned int)result.vertices.size();
+				result.vertices.push_back(s.positions[v]);
+				result.sourceVertex.push_back(v);
+			}
+			result.indices.push_back(remap[v]);
+		}
+	}
+	return result;
+}
+
+//--------------------------------------------------------------
+std::vector<MeshSimplifier::Result> MeshSimplifier::buildLodChain(const std::vector<glm::vec3> & vertices,
+	const std::vector<unsigned int> & indices, const std::vector<float> & ratios, const Settings & settings) {
+	std::vector<float> sorted = ratios;
+	std::sort(sorted.begin(), sorted.end(), std::greater<float>());
+
+	std::vector<Result> chain;
+	const std::vector<glm::vec3> * srcVertices = &vertices;
+	const std::vector<unsigned int> * srcIndices = &indices;
+	float srcRatio = 1.0f;
+
+	for (float ratio : sorted) {
+		Result level;
+		if (ratio >= 1.0f) {
+			level.vertices = vertices;
+			level.indices = indices;
+			level.sourceVertex.resize(vertices.size());
+			for (size_t i = 0; i < vertices.size(); i++) level.sourceVertex[i] = (unsigned int)i;
+		} else {
+			Settings levelSettings = settings;
+			levelSettings.targetRatio = ratio / srcRatio;
+			level = simplify(*srcVertices, *srcIndices, levelSettings);
+			if (!chain.empty()) {
+				// Re-express sourceVertex relative to the original input
+				for (auto & src : level.sourceVertex) src = chain.back().sourceVertex[src];
+				level.maxError = std::max(level.maxError, chain.back().maxError);
+			}
+		}
+		chain.push_back(std::move(level));
+		srcVertices = &chain.back().vertices;
+		srcIndices = &chain.back().indices;
+		srcRatio = std::min(ratio, 1.0f);
+	}
+	return chain;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+
+// Quadric-error-metric edge-collapse simplifier (Garland & Heckbert).
+// GL-independent: operates on plain position/index arrays.
+//
+// To run in parallel the mesh is cut into a grid of spatial partitions and
+// each partition collapses only edges whose triangles lie entirely inside it;
+// vertices on partition seams and open borders are locked. A second round
+// uses a grid shifted by half a cell so the first round's seams become
+// interior edges and get simplified too.
+class MeshSimplifier {
+public:
+	struct Settings {
+		float targetRatio = 0.5f; // fraction of the input triangles to keep
+		float maxError = 1e30f; // stop collapsing above this quadric error
+		float minNormalDot = 0.2f; // reject collapses that flip a triangle further than this
+		bool lockBorders = true; // keep open boundaries (and crease splits) in place
+		int workers = 0; // 0 = all hardware threads
+	};
+
+	struct Result {
+		std::vector<glm::vec3> vertices;
+		std::vector<unsigned int> indices;
+		std::vector<unsigned int> sourceVertex; // output vertex -> input vertex
+		float maxError = 0.0f;
+	};
+
+	static Result simplify(const std::vector<glm::vec3> & vertices,
+		const std::vector<unsigned int> & indices,
+		const Settings & settings);
+
+	// Progressive chain: each level is simplified from the previous one.
+	// ratios are relative to the input, e.g. { 1.0, 0.5, 0.25, 0.1 }; a
+	// ratio >= 1 copies the input. sourceVertex always refers to the input.
+	static std::vector<Result> buildLodChain(const std::vector<glm::vec3> & vertices,
+		const std::vector<unsigned int> & indices,
+		const std::vector<float> & ratios,
+		const Settings & settings);
+};
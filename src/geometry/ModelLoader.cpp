@@ -1,4 +1,9 @@
 #include "ModelLoader.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "ofxAssimpModelLoader.h"
+#include "utils/ParallelFor.h"
+#include "utils/Trace.h"
 #include <algorithm>
 
 ModelLoader::ModelLoader() {
@@ -20,6 +25,9 @@ void ModelLoader::initializeSupportedFormats() {
 	supportedFormats.clear();
 	supportedFormats.push_back("obj");
 	supportedFormats.push_back("ply");
+	supportedFormats.push_back("3ds");
+	supportedFormats.push_back("dae");
+	supportedFormats.push_back("fbx");
 	// ԸҪӸʽ
 }
 
@@ -36,6 +44,7 @@ vector<string> ModelLoader::getSupportedFormats() {
 
 //--------------------------------------------------------------
 bool ModelLoader::loadModel(const string & filepath, ofVboMesh & outMesh) {
+	TRACE_SCOPE("ModelLoader", "loadModel");
 	if (!ofFile::doesFileExist(filepath)) {
 		ofLogError("ModelLoader") << "File does not exist: " << filepath;
 		return false;
@@ -51,15 +60,19 @@ bool ModelLoader::loadModel(const string & filepath, ofVboMesh & outMesh) {
 
 	// mesh
 	outMesh.clear();
+	submeshes.clear();
 
 	// չӦļ
 	if (extension == "obj") {
 		success = loadOBJ(filepath, outMesh);
 	} else if (extension == "ply") {
 		success = loadPLY(filepath, outMesh);
+	} else {
+		success = loadAssimp(filepath, outMesh);
 	}
 
 	if (success && validateMesh(outMesh)) {
+		finalizeSubmeshes(outMesh.getNumIndices());
 		// 
 		postProcessMesh(outMesh);
 		ofLogNotice("ModelLoader") << "Successfully loaded: " << filepath;
@@ -73,6 +86,7 @@ bool ModelLoader::loadModel(const string & filepath, ofVboMesh & outMesh) {
 
 //--------------------------------------------------------------
 bool ModelLoader::loadOBJ(const string & filepath, ofVboMesh & outMesh) {
+	TRACE_SCOPE("ModelLoader", "loadOBJ");
 	ofLogNotice("ModelLoader") << "Loading OBJ file: " << filepath;
 
 	ofFile file(filepath);
@@ -114,6 +128,10 @@ bool ModelLoader::loadOBJ(const string & filepath, ofVboMesh & outMesh) {
 			float v = ofToFloat(tokens[2]);
 			texCoords.push_back(ofVec2f(u, v));
 
+		} else if ((tokens[0] == "o" || tokens[0] == "g") && tokens.size() >= 2) {
+			// Each object/group becomes a submesh range of the merged mesh
+			beginSubmesh(tokens[1], indices.size());
+
 		} else if (tokens[0] == "f" && tokens.size() >= 4) {
 			// 涨 (֧κı)
 			vector<int> faceVertices;
@@ -185,16 +203,156 @@ bool ModelLoader::loadOBJ(const string & filepath, ofVboMesh & outMesh) {
 
 //--------------------------------------------------------------
 bool ModelLoader::loadPLY(const string & filepath, ofVboMesh & outMesh) {
+	TRACE_SCOPE("ModelLoader", "loadPLY");
 	// PLYļʵ
 	// ԸҪʵPLYʽ֧
-	ofLogWarning("ModelLoader") << "PLY format not yet implemented";
-	return false;
+	// assimp already reads PLY, so it goes through the scene importer
+	return loadAssimp(filepath, outMesh);
+}
+
+//--------------------------------------------------------------
+bool ModelLoader::loadAssimp(const string & filepath, ofVboMesh & outMesh) {
+	TRACE_SCOPE("ModelLoader", "loadAssimp");
+	ofLogNotice("ModelLoader") << "Loading scene via assimp: " << filepath;
+
+	ofxAssimpModelLoader scene;
+	if (!scene.loadModel(filepath, false)) {
+		ofLogError("ModelLoader") << "assimp could not read: " << filepath;
+		return false;
+	}
+
+	// Attributes only some submeshes carry are zero-filled for the others so
+	// every array of the merged mesh stays the same length
+	bool anyNormals = false;
+	bool anyTexCoords = false;
+	for (unsigned int i = 0; i < scene.getMeshCount(); i++) {
+		anyNormals |= scene.getMesh(i).hasNormals();
+		anyTexCoords |= scene.getMesh(i).hasTexCoords();
+	}
+
+	vector<string> names = scene.getMeshNames();
+	outMesh.clear();
+	outMesh.setMode(OF_PRIMITIVE_TRIANGLES);
+
+	for (unsigned int i = 0; i < scene.getMeshCount(); i++) {
+		ofMesh mesh = scene.getMesh(i);
+		if (mesh.getNumVertices() == 0) continue;
+
+		// Bake the node transform so the merged mesh needs no per-object matrix
+		glm::mat4 transform = scene.getMeshHelper(i).matrix;
+		glm::mat3 normalTransform = glm::transpose(glm::inverse(glm::mat3(transform)));
+		unsigned int baseVertex = outMesh.getNumVertices();
+
+		beginSubmesh(i < names.size() ? names[i] : "mesh" + ofToString(i), outMesh.getNumIndices());
+
+		for (const auto & v : mesh.getVertices()) {
+			outMesh.addVertex(glm::vec3(transform * glm::vec4(v, 1.0f)));
+		}
+		if (anyNormals) {
+			for (size_t k = 0; k < mesh.getNumVertices(); k++) {
+				outMesh.addNormal(mesh.hasNormals() ? glm::normalize(normalTransform * mesh.getNormal(k)) : glm::vec3(0.0f));
+			}
+		}
+		if (anyTexCoords) {
+			for (size_t k = 0; k < mesh.getNumVertices(); k++) {
+				outMesh.addTexCoord(mesh.hasTexCoords() ? mesh.getTexCoord(k) : glm::vec2(0.0f));
+			}
+		}
+
+		if (mesh.hasIndices()) {
+			for (auto index : mesh.getIndices()) {
+				outMesh.addIndex(baseVertex + index);
+			}
+		} else {
+			for (size_t k = 0; k < mesh.getNumVertices(); k++) {
+				outMesh.addIndex(baseVertex + (ofIndexType)k);
+			}
+		}
+	}
+
+	ofLogNotice("ModelLoader") << "Scene loaded - Meshes: " << scene.getMeshCount()
+							   << ", Vertices: " << outMesh.getNumVertices()
+							   << ", Indices: " << outMesh.getNumIndices();
+
+	return outMesh.getNumVertices() > 0;
+}
+
+//--------------------------------------------------------------
+void ModelLoader::beginSubmesh(const string & name, size_t indexOffset) {
+	// An object header followed directly by a group header names one range
+	if (!submeshes.empty() && submeshes.back().indexOffset == indexOffset) {
+		submeshes.back().name = name;
+		return;
+	}
+
+	SubmeshRange range;
+	range.name = name;
+	range.indexOffset = (unsigned int)indexOffset;
+	submeshes.push_back(range);
+}
+
+//--------------------------------------------------------------
+void ModelLoader::finalizeSubmeshes(size_t indexCount) {
+	// Faces before the first object header belong to an unnamed range
+	if (submeshes.empty() || submeshes.front().indexOffset > 0) {
+		SubmeshRange range;
+		range.name = "default";
+		submeshes.insert(submeshes.begin(), range);
+	}
+
+	for (size_t i = 0; i < submeshes.size(); i++) {
+		size_t end = i + 1 < submeshes.size() ? submeshes[i + 1].indexOffset : indexCount;
+		submeshes[i].indexCount = (unsigned int)(end - submeshes[i].indexOffset);
+	}
+
+	submeshes.erase(std::remove_if(submeshes.begin(), submeshes.end(),
+						[](const SubmeshRange & range) { return range.indexCount == 0; }),
+		submeshes.end());
+}
+
+//--------------------------------------------------------------
+void ModelLoader::remapSubmeshes(const vector<unsigned int> & keptTriangles) {
+	// keptTriangles is ascending, so each range maps to a contiguous run of it
+	for (auto & range : submeshes) {
+		unsigned int firstTriangle = range.indexOffset / 3;
+		unsigned int endTriangle = (range.indexOffset + range.indexCount) / 3;
+		auto first = std::lower_bound(keptTriangles.begin(), keptTriangles.end(), firstTriangle);
+		auto last = std::lower_bound(first, keptTriangles.end(), endTriangle);
+		range.indexOffset = (unsigned int)(first - keptTriangles.begin()) * 3;
+		range.indexCount = (unsigned int)(last - first) * 3;
+	}
+
+	submeshes.erase(std::remove_if(submeshes.begin(), submeshes.end(),
+						[](const SubmeshRange & range) { return range.indexCount == 0; }),
+		submeshes.end());
 }
 
 //--------------------------------------------------------------
 void ModelLoader::postProcessMesh(ofVboMesh & mesh) {
+	TRACE_SCOPE("ModelLoader", "postProcessMesh");
+	// The bounding box is reduced once here and carried through every stage;
+	// centering/scaling updates it analytically instead of re-scanning.
+	uint64_t stageStart = ofGetElapsedTimeMicros();
+	MeshProcessing::Bounds bounds = calculateBoundingBox(mesh);
+	uint64_t boundsTime = ofGetElapsedTimeMicros() - stageStart;
+	lastModelInfo.sourceVertexCount = mesh.getNumVertices();
+
+	// 0. Weld split vertices so smoothing sees a connected surface
+	stageStart = ofGetElapsedTimeMicros();
+	if (loadOptions.weldVertices) {
+		removeDuplicateVertices(mesh, bounds);
+	}
+	lastModelInfo.weldedVertexCount = mesh.getNumVertices();
+	uint64_t weldTime = ofGetElapsedTimeMicros() - stageStart;
+
+	stageStart = ofGetElapsedTimeMicros();
 	// 1. ɷ (Ҫû)
-	if (loadOptions.generateNormals && !mesh.hasNormals()) {
+	//    Smoothing recomputes every normal from the geometry, so it replaces
+	//    plain generation rather than running after it.
+	lastModelInfo.splitVertexCount = 0;
+	if (loadOptions.smoothNormals && (mesh.hasNormals() || loadOptions.generateNormals)) {
+		smoothNormals(mesh);
+	} else if (loadOptions.generateNormals && !mesh.hasNormals()) {
 		generateNormals(mesh);
 	}
 
@@ -205,118 +363,135 @@ void ModelLoader::postProcessMesh(ofVboMesh & mesh) {
 			normal *= -1;
 		}
 	}
+	uint64_t normalsTime = ofGetElapsedTimeMicros() - stageStart;
 
+	stageStart = ofGetElapsedTimeMicros();
 	// 3. кͱ׼
 	if (loadOptions.centerModel || loadOptions.normalizeSize) {
-		centerAndNormalizeMesh(mesh);
+		centerAndNormalizeMesh(mesh, bounds);
 	}
+	uint64_t transformTime = ofGetElapsedTimeMicros() - stageStart;
 
-	// 4. ƽ
-	if (loadOptions.smoothNormals && mesh.hasNormals()) {
-		smoothNormals(mesh);
+	// 4. Reorder for the post-transform cache and fetch locality
+	stageStart = ofGetElapsedTimeMicros();
+	lastModelInfo.acmrBefore = lastModelInfo.acmrAfter = MeshOptimizer::computeACMR(mesh.getIndices(), mesh.getNumVertices());
+	if (loadOptions.optimizeVertexOrder) {
+		optimizeVertexOrder(mesh);
 	}
+	uint64_t optimizeTime = ofGetElapsedTimeMicros() - stageStart;
 
 	// 5. ģϢ
-	calculateModelInfo(mesh);
+	calculateModelInfo(mesh, bounds);
+
+	ofLogNotice("ModelLoader") << "Post-process (" << resolveWorkerCount(loadOptions.workerThreads) << " threads) - "
+							   << "bounds: " << boundsTime / 1000.0f << " ms, "
+							   << "weld: " << weldTime / 1000.0f << " ms, "
+							   << "normals: " << normalsTime / 1000.0f << " ms, "
+							   << "transform: " << transformTime / 1000.0f << " ms, "
+							   << "reorder: " << optimizeTime / 1000.0f << " ms";
+	logMeshInfo();
 }
 
 //--------------------------------------------------------------
 void ModelLoader::generateNormals(ofVboMesh & mesh) {
+	TRACE_SCOPE("ModelLoader", "generateNormals");
 	if (mesh.getNumVertices() == 0) return;
 
-	vector<ofVec3f> normals(mesh.getNumVertices(), ofVec3f(0, 0, 0));
-	auto & vertices = mesh.getVertices();
-	auto & indices = mesh.getIndices();
-
-	// 淨߲ۼӵ㷨
-	for (int i = 0; i < indices.size(); i += 3) {
-		if (i + 2 < indices.size()) {
-			int i0 = indices[i];
-			int i1 = indices[i + 1];
-			int i2 = indices[i + 2];
-
-			if (i0 < vertices.size() && i1 < vertices.size() && i2 < vertices.size()) {
-				ofVec3f v0 = vertices[i0];
-				ofVec3f v1 = vertices[i1];
-				ofVec3f v2 = vertices[i2];
-
-				ofVec3f edge1 = v1 - v0;
-				ofVec3f edge2 = v2 - v0;
-				ofVec3f faceNormal = edge1.getCrossed(edge2);
-
-				normals[i0] += faceNormal;
-				normals[i1] += faceNormal;
-				normals[i2] += faceNormal;
-			}
-		}
-	}
-
-	// һ
-	for (auto & normal : normals) {
-		normal.normalize();
-	}
+	vector<glm::vec3> normals;
+	MeshProcessing::computeVertexNormals(mesh.getVertices(), mesh.getIndices(), normals, loadOptions.workerThreads);
 
 	mesh.clearNormals();
-	for (const auto & normal : normals) {
-		mesh.addNormal(normal);
-	}
-	//mesh.addNormals(normals);
+	mesh.addNormals(normals);
 }
 
 //--------------------------------------------------------------
-void ModelLoader::centerAndNormalizeMesh(ofVboMesh & mesh) {
+void ModelLoader::centerAndNormalizeMesh(ofVboMesh & mesh, MeshProcessing::Bounds & bounds) {
+	TRACE_SCOPE("ModelLoader", "centerAndNormalizeMesh");
 	if (mesh.getNumVertices() == 0) return;
 
-	ofVec3f minBounds, maxBounds;
-	calculateBoundingBox(mesh, minBounds, maxBounds);
+	glm::vec3 center = loadOptions.centerModel ? bounds.getCenter() : glm::vec3(0.0f);
+	float maxDimension = bounds.getMaxDimension();
+	float scale = 1.0f;
+	if (loadOptions.normalizeSize && maxDimension > 0) {
+		scale = loadOptions.targetSize / maxDimension;
+	}
 
-	ofVec3f center = (minBounds + maxBounds) * 0.5f;
-	ofVec3f size = maxBounds - minBounds;
-	float maxDimension = std::max({ size.x, size.y, size.z });
+	// Centering and normalization are applied in a single pass
+	MeshProcessing::translateAndScale(mesh.getVertices(), center, scale, loadOptions.workerThreads);
 
-	auto & vertices = mesh.getVertices();
+	bounds.min = (bounds.min - center) * scale;
+	bounds.max = (bounds.max - center) * scale;
+}
 
-	// 
-	if (loadOptions.centerModel) {
-		for (auto & vertex : vertices) {
-			vertex -= center;
-		}
-	}
+//--------------------------------------------------------------
+MeshProcessing::Bounds ModelLoader::calculateBoundingBox(const ofVboMesh & mesh) {
+	return MeshProcessing::computeBounds(mesh.getVertices(), loadOptions.workerThreads);
+}
 
-	// ׼ߴ
-	if (loadOptions.normalizeSize && maxDimension > 0) {
-		float scale = loadOptions.targetSize / maxDimension;
-		for (auto & vertex : vertices) {
-			vertex *= scale;
-		}
-	}
+//--------------------------------------------------------------
+void ModelLoader::smoothNormals(ofVboMesh & mesh) {
+	TRACE_SCOPE("ModelLoader", "smoothNormals");
+	if (mesh.getNumVertices() == 0 || mesh.getNumIndices() == 0) return;
+
+	vector<glm::vec3> normals;
+	MeshProcessing::SmoothResult result = MeshProcessing::smoothNormals(
+		mesh.getVertices(), mesh.getIndices(), normals, loadOptions.creaseAngle, loadOptions.workerThreads);
+
+	// Vertices split at creases carry the attributes of the vertex they came from
+	MeshProcessing::remapAttribute(mesh.getTexCoords(), result.sourceVertex);
+	MeshProcessing::remapAttribute(mesh.getColors(), result.sourceVertex);
+
+	mesh.clearNormals();
+	mesh.addNormals(normals);
+
+	lastModelInfo.splitVertexCount = (int)result.splitVertices;
 }
 
 //--------------------------------------------------------------
-void ModelLoader::calculateBoundingBox(const ofVboMesh & mesh, ofVec3f & min, ofVec3f & max) {
-	if (mesh.getNumVertices() == 0) {
-		min = max = ofVec3f(0, 0, 0);
-		return;
+void ModelLoader::optimizeVertexOrder(ofVboMesh & mesh) {
+	TRACE_SCOPE("ModelLoader", "optimizeVertexOrder");
+	if (mesh.getNumVertices() == 0 || mesh.getNumIndices() == 0) return;
+
+	// Triangles are only reordered inside their own submesh range
+	vector<MeshOptimizer::IndexRange> ranges;
+	for (const auto & submesh : submeshes) {
+		MeshOptimizer::IndexRange range;
+		range.offset = submesh.indexOffset;
+		range.count = submesh.indexCount;
+		ranges.push_back(range);
 	}
 
-	auto & vertices = mesh.getVertices();
-	min = max = vertices[0];
+	MeshOptimizer::Result result = MeshOptimizer::optimize(mesh.getIndices(), mesh.getNumVertices(), ranges,
+		MeshOptimizer::kDefaultCacheSize, loadOptions.workerThreads);
 
-	for (const auto & vertex : vertices) {
-		min.x = std::min(min.x, vertex.x);
-		min.y = std::min(min.y, vertex.y);
-		min.z = std::min(min.z, vertex.z);
+	MeshProcessing::remapAttribute(mesh.getVertices(), result.sourceVertex);
+	MeshProcessing::remapAttribute(mesh.getNormals(), result.sourceVertex);
+	MeshProcessing::remapAttribute(mesh.getTexCoords(), result.sourceVertex);
+	MeshProcessing::remapAttribute(mesh.getColors(), result.sourceVertex);
 
-		max.x = std::max(max.x, vertex.x);
-		max.y = std::max(max.y, vertex.y);
-		max.z = std::max(max.z, vertex.z);
-	}
+	lastModelInfo.acmrBefore = result.acmrBefore;
+	lastModelInfo.acmrAfter = result.acmrAfter;
 }
 
 //--------------------------------------------------------------
-void ModelLoader::smoothNormals(ofVboMesh & mesh) {
-	// 򵥵ķƽ㷨
-	// ԸҪʵָӵƽ㷨
+void ModelLoader::removeDuplicateVertices(ofVboMesh & mesh, const MeshProcessing::Bounds & bounds) {
+	TRACE_SCOPE("ModelLoader", "removeDuplicateVertices");
+	if (mesh.getNumVertices() == 0 || mesh.getNumIndices() == 0) return;
+
+	float tolerance = loadOptions.weldTolerance * std::max(bounds.getMaxDimension(), 1e-6f);
+	const vector<glm::vec2> * texCoords = mesh.hasTexCoords() ? &mesh.getTexCoords() : nullptr;
+
+	MeshProcessing::WeldResult result = MeshProcessing::weldVertices(
+		mesh.getVertices(), mesh.getIndices(), tolerance, texCoords, loadOptions.weldUvTolerance, loadOptions.workerThreads);
+
+	MeshProcessing::remapAttribute(mesh.getNormals(), result.sourceVertex);
+	MeshProcessing::remapAttribute(mesh.getTexCoords(), result.sourceVertex);
+	MeshProcessing::remapAttribute(mesh.getColors(), result.sourceVertex);
+
+	if (result.removedTriangles > 0) {
+		remapSubmeshes(result.keptTriangles);
+		ofLogNotice("ModelLoader") << "Welding removed " << result.removedTriangles << " degenerate triangles";
+	}
 }
 
 //--------------------------------------------------------------
@@ -334,17 +509,88 @@ bool ModelLoader::validateMesh(const ofVboMesh & mesh) {
 }
 
 //--------------------------------------------------------------
-void ModelLoader::calculateModelInfo(const ofVboMesh & mesh) {
+void ModelLoader::calculateModelInfo(const ofVboMesh & mesh, const MeshProcessing::Bounds & bounds) {
 	lastModelInfo.vertexCount = mesh.getNumVertices();
 	lastModelInfo.indexCount = mesh.getNumIndices();
 	lastModelInfo.hasNormals = mesh.hasNormals();
 	lastModelInfo.hasTexCoords = mesh.hasTexCoords();
 	lastModelInfo.hasColors = mesh.hasColors();
 
-	calculateBoundingBox(mesh, lastModelInfo.boundingBoxMin, lastModelInfo.boundingBoxMax);
-	lastModelInfo.center = (lastModelInfo.boundingBoxMin + lastModelInfo.boundingBoxMax) * 0.5f;
+	lastModelInfo.boundingBoxMin = bounds.min;
+	lastModelInfo.boundingBoxMax = bounds.max;
+	lastModelInfo.center = bounds.getCenter();
+	lastModelInfo.maxDimension = bounds.getMaxDimension();
+}
+//--------------------------------------------------------------
+void ModelLoader::logMeshInfo() const {
+	const ModelInfo & info = lastModelInfo;
+	int welded = info.sourceVertexCount - info.weldedVertexCount;
+	float reduction = info.sourceVertexCount > 0 ? 100.0f * (info.sourceVertexCount - info.vertexCount) / info.sourceVertexCount : 0.0f;
+
+	ofLogNotice("ModelLoader") << "Mesh info:";
+	ofLogNotice("ModelLoader") << "  Source vertices: " << info.sourceVertexCount;
+	ofLogNotice("ModelLoader") << "  Welded: -" << welded << " (" << info.weldedVertexCount << " unique)";
+	ofLogNotice("ModelLoader") << "  Crease splits: +" << info.splitVertexCount;
+	ofLogNotice("ModelLoader") << "  Final vertices: " << info.vertexCount << " (" << ofToString(reduction, 1) << "% fewer than source)";
+	ofLogNotice("ModelLoader") << "  Indices: " << info.indexCount;
+	ofLogNotice("ModelLoader") << "  Submeshes: " << submeshes.size() << " (merged into one draw)";
+	ofLogNotice("ModelLoader") << "  ACMR: " << info.acmrBefore << " -> " << info.acmrAfter;
+}
+//--------------------------------------------------------------
+void ModelLoader::generateLods(const ofVboMesh & mesh, vector<MeshLod> & outLods) {
+	TRACE_SCOPE("ModelLoader", "generateLods");
+	outLods.clear();
+
+	MeshLod full;
+	full.mesh = mesh;
+	outLods.push_back(full);
 
-	ofVec3f size = lastModelInfo.boundingBoxMax - lastModelInfo.boundingBoxMin;
-	lastModelInfo.maxDimension = std::max({ size.x, size.y, size.z });
+	int triangleCount = mesh.getNumIndices() / 3;
+	if (!loadOptions.buildLods || triangleCount < loadOptions.lodMinTriangles) {
+		return;
+	}
+
+	vector<float> ratios;
+	for (float ratio : loadOptions.lodRatios) {
+		if (ratio > 0.0f && ratio < 1.0f) ratios.push_back(ratio);
+	}
+	if (ratios.empty()) return;
+
+	uint64_t startTime = ofGetElapsedTimeMicros();
+
+	MeshSimplifier::Settings settings;
+	settings.workers = loadOptions.workerThreads;
+	auto chain = MeshSimplifier::buildLodChain(mesh.getVertices(), mesh.getIndices(), ratios, settings);
+
+	for (size_t i = 0; i < chain.size(); i++) {
+		// Collapses leave the index buffer in heap order, so every level is
+		// reordered like the full-detail mesh
+		if (loadOptions.optimizeVertexOrder) {
+			MeshOptimizer::Result order = MeshOptimizer::optimize(chain[i].indices, chain[i].vertices.size());
+			MeshProcessing::remapAttribute(chain[i].vertices, order.sourceVertex);
+			MeshProcessing::remapAttribute(chain[i].sourceVertex, order.sourceVertex);
+		}
+
+		MeshLod lod;
+		lod.ratio = (float)(chain[i].indices.size() / 3) / triangleCount;
+		lod.maxError = chain[i].maxError;
+		lod.mesh.setMode(OF_PRIMITIVE_TRIANGLES);
+		lod.mesh.addVertices(chain[i].vertices);
+		lod.mesh.addIndices(chain[i].indices);
+
+		// Surviving vertices keep the attributes of the full-detail vertex
+		for (unsigned int src : chain[i].sourceVertex) {
+			if (mesh.hasNormals()) lod.mesh.addNormal(mesh.getNormals()[src]);
+			if (mesh.hasTexCoords()) lod.mesh.addTexCoord(mesh.getTexCoords()[src]);
+			if (mesh.hasColors()) lod.mesh.addColor(mesh.getColors()[src]);
+		}
+		outLods.push_back(lod);
+	}
+
+	ofLogNotice("ModelLoader") << "LOD chain built in " << (ofGetElapsedTimeMicros() - startTime) / 1000.0f << " ms:";
+	for (size_t i = 0; i < outLods.size(); i++) {
+		ofLogNotice("ModelLoader") << "  LOD" << i << ": " << outLods[i].mesh.getNumIndices() / 3 << " triangles, "
+								   << outLods[i].mesh.getNumVertices() << " vertices, error " << outLods[i].maxError;
+	}
 }
 //--------------------------------------------------------------
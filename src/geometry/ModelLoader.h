@@ -1,5 +1,7 @@
 #pragma once
+#include "MeshProcessing.h"
 #include "ofMain.h"
+#include "shared/GeometryData.h"
 
 class ModelLoader {
 public:
@@ -24,10 +26,19 @@ public:
 		bool hasNormals;
 		bool hasTexCoords;
 		bool hasColors;
+		int sourceVertexCount = 0; // vertices as read from the file
+		int weldedVertexCount = 0; // after removeDuplicateVertices
+		int splitVertexCount = 0; // added back by smoothNormals at creases
+		float acmrBefore = 0.0f; // average cache miss ratio as loaded
+		float acmrAfter = 0.0f; // after optimizeVertexOrder
 	};
 
 	ModelInfo getLastLoadedInfo() const { return lastModelInfo; }
 
+	// Objects of the last loaded model; all of them share the one merged
+	// mesh, so a single draw covers the whole scene
+	const vector<SubmeshRange> & getSubmeshes() const { return submeshes; }
+
 	// ѡ
 	struct LoadOptions {
 		bool generateNormals = true;
@@ -36,32 +47,56 @@ public:
 		bool normalizeSize = true;
 		float targetSize = 100.0f;
 		bool smoothNormals = true;
+		float creaseAngle = 60.0f; // faces meeting at a sharper angle keep a hard edge
+		bool weldVertices = true;
+		float weldTolerance = 1e-5f; // relative to the model's largest dimension
+		float weldUvTolerance = 1e-5f; // absolute, in texture coordinates
+		int workerThreads = 0; // post-processing threads, 0 = all hardware threads
+		bool optimizeVertexOrder = true; // Tipsify triangle order + first-use vertex order
+
+		// LOD chain (quadric-error decimation), only for models above lodMinTriangles
+		bool buildLods = true;
+		int lodMinTriangles = 20000;
+		vector<float> lodRatios = { 1.0f, 0.5f, 0.25f, 0.1f };
 	};
 
 	void setLoadOptions(const LoadOptions & options) { loadOptions = options; }
 	LoadOptions getLoadOptions() const { return loadOptions; }
 
+	void logMeshInfo() const;
+
+	// Build the LOD chain of a loaded mesh; outLods[0] is always full detail
+	void generateLods(const ofVboMesh & mesh, vector<MeshLod> & outLods);
+
 private:
 	bool loadOBJ(const string & filepath, ofVboMesh & outMesh);
 	bool loadPLY(const string & filepath, ofVboMesh & outMesh);
+	bool loadAssimp(const string & filepath, ofVboMesh & outMesh);
+
+	// Submesh range bookkeeping
+	void beginSubmesh(const string & name, size_t indexOffset);
+	void finalizeSubmeshes(size_t indexCount);
+	void remapSubmeshes(const vector<unsigned int> & keptTriangles);
 
 	// 
 	void postProcessMesh(ofVboMesh & mesh);
 	void generateNormals(ofVboMesh & mesh);
-	void centerAndNormalizeMesh(ofVboMesh & mesh);
-	void calculateBoundingBox(const ofVboMesh & mesh, ofVec3f & min, ofVec3f & max);
+	void centerAndNormalizeMesh(ofVboMesh & mesh, MeshProcessing::Bounds & bounds);
+	MeshProcessing::Bounds calculateBoundingBox(const ofVboMesh & mesh);
 	void smoothNormals(ofVboMesh & mesh);
+	void optimizeVertexOrder(ofVboMesh & mesh);
 
 	// ֤޸
 	bool validateMesh(const ofVboMesh & mesh);
-	void removeDuplicateVertices(ofVboMesh & mesh);
+	void removeDuplicateVertices(ofVboMesh & mesh, const MeshProcessing::Bounds & bounds);
 
 	// ģϢ
-	void calculateModelInfo(const ofVboMesh & mesh);
+	void calculateModelInfo(const ofVboMesh & mesh, const MeshProcessing::Bounds & bounds);
 
 	// ڲ״̬
 	LoadOptions loadOptions;
 	ModelInfo lastModelInfo;
+	vector<SubmeshRange> submeshes;
 
 	// ֵ֧ĸʽб
 	vector<string> supportedFormats;
@@ -0,0 +1,304 @@
+#include "SDFBaker.h"
+#include "utils/Hash.h"
+#include "utils/ParallelFor.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <utility>
+
+namespace {
+
+const uint32_t kCacheMagic = 0x31464453; // "SDF1"
+const size_t kMinChunkSize = 256;
+const int kSweepCount = 8;
+
+const uint8_t kFlagBand = 1;
+const uint8_t kFlagInside = 2;
+
+}
+
+//--------------------------------------------------------------
+void SDFBaker::clear() {
+	bvh = nullptr;
+	normals.clear();
+	volume = Volume();
+	flags.clear();
+	phase = PHASE_IDLE;
+	bakedSlices = 0;
+	sweepIndex = 0;
+}
+
+//--------------------------------------------------------------
+void SDFBaker::begin(const MeshBVH & meshBvh, const std::vector<glm::vec3> & meshNormals, const Settings & bakeSettings) {
+	clear();
+	settings = bakeSettings;
+	if (meshBvh.empty() || settings.resolution < 2) return;
+
+	bvh = &meshBvh;
+	if (meshNormals.size() == meshBvh.getVertices().size()) {
+		normals = meshNormals;
+	}
+
+	glm::vec3 boundsMin(std::numeric_limits<float>::max());
+	glm::vec3 boundsMax(std::numeric_limits<float>::lowest());
+	for (const auto & v : meshBvh.getVertices()) {
+		boundsMin = glm::min(boundsMin, v);
+		boundsMax = glm::max(boundsMax, v);
+	}
+
+	// Cubic volume so voxels are isotropic
+	glm::vec3 extent = boundsMax - boundsMin;
+	float maxExtent = std::max(std::max(extent.x, extent.y), std::max(extent.z, 1e-4f));
+	volume.resolution = settings.resolution;
+	volume.size = maxExtent * (1.0f + 2.0f * settings.padding);
+	volume.origin = (boundsMin + boundsMax) * 0.5f - glm::vec3(volume.size * 0.5f);
+
+	size_t voxelCount = (size_t)volume.resolution * volume.resolution * volume.resolution;
+	volume.distances.assign(voxelCount, std::numeric_limits<float>::infinity());
+	flags.assign(voxelCount, 0);
+	phase = PHASE_BAND;
+}
+
+//--------------------------------------------------------------
+float SDFBaker::getProgress() const {
+	if (phase == PHASE_DONE) return 1.0f;
+	if (phase == PHASE_IDLE || volume.resolution == 0) return 0.0f;
+
+	// Band slices dominate the cost; sign and sweeps count as one slice each
+	float total = (float)(volume.resolution + 1 + kSweepCount);
+	float done = (float)bakedSlices + (phase > PHASE_SIGN ? 1.0f : 0.0f) + sweepIndex;
+	return done / total;
+}
+
+//--------------------------------------------------------------
+void SDFBaker::bakeStep(int maxSlices) {
+	switch (phase) {
+	case PHASE_BAND:
+		bakeBand(std::max(1, maxSlices));
+		if (bakedSlices >= volume.resolution) phase = PHASE_SIGN;
+		break;
+	case PHASE_SIGN:
+		classifySign();
+		phase = PHASE_SWEEP;
+		break;
+	case PHASE_SWEEP:
+		sweep(sweepIndex++);
+		if (sweepIndex >= kSweepCount) finish();
+		break;
+	default:
+		break;
+	}
+}
+
+//--------------------------------------------------------------
+void SDFBaker::bakeBand(int maxSlices) {
+	int res = volume.resolution;
+	int first = bakedSlices;
+	int last = std::min(res, first + maxSlices);
+	float voxel = volume.size / res;
+	float band = settings.bandVoxels * voxel;
+	const auto & vertices = bvh->getVertices();
+	const auto & indices = bvh->getIndices();
+
+	size_t sliceVoxels = (size_t)res * res;
+	size_t base = (size_t)first * sliceVoxels;
+	size_t count = (size_t)(last - first) * sliceVoxels;
+
+	parallelForChunks(count, resolveWorkerCount(settings.workers), kMinChunkSize, [&](size_t begin, size_t end, int) {
+		for (size_t i = begin; i < end; i++) {
+			size_t index = base + i;
+			int x = (int)(index % res);
+			int y = (int)((index / res) % res);
+			int z = (int)(index / sliceVoxels);
+			glm::vec3 p = volume.origin + (glm::vec3((float)x, (float)y, (float)z) + 0.5f) * voxel;
+
+			MeshBVH::Hit hit = bvh->closestPoint(p, band);
+			if (!hit.valid) continue;
+
+			// Inside when the point lies behind the surface normal at the closest point
+			unsigned int a = indices[hit.triangle * 3], b = indices[hit.triangle * 3 + 1], c = indices[hit.triangle * 3 + 2];
+			glm::vec3 n = normals.empty()
+				? glm::cross(vertices[b] - vertices[a], vertices[c] - vertices[a])
+				: normals[a] * hit.barycentric.x + normals[b] * hit.barycentric.y + normals[c] * hit.barycentric.z;
+			bool inside = glm::dot(p - hit.position, n) < 0.0f;
+
+			volume.distances[index] = inside ? -hit.distance : hit.distance;
+			flags[index] = kFlagBand | (inside ? kFlagInside : 0);
+		}
+	});
+
+	bakedSlices = last;
+}
+
+//--------------------------------------------------------------
+void SDFBaker::classifySign() {
+	// Everything reachable from the border without crossing an inside band
+	// voxel is outside; the band is thick enough that 6-connected paths
+	// cannot slip through a closed surface
+	int res = volume.resolution;
+	size_t voxelCount = volume.distances.size();
+	std::vector<uint8_t> outside(voxelCount, 0);
+	std::vector<size_t> queue;
+	queue.reserve(voxelCount / 4);
+
+	auto visit = [&](size_t index) {
+		if (outside[index] || (flags[index] & kFlagInside)) return;
+		outside[index] = 1;
+		queue.push_back(index);
+	};
+
+	for (int a = 0; a < res; a++) {
+		for (int b = 0; b < res; b++) {
+			visit(((size_t)0 * res + a) * res + b);
+			visit(((size_t)(res - 1) * res + a) * res + b);
+			visit(((size_t)a * res + 0) * res + b);
+			visit(((size_t)a * res + (res - 1)) * res + b);
+			visit(((size_t)a * res + b) * res + 0);
+			visit(((size_t)a * res + b) * res + (res - 1));
+		}
+	}
+
+	size_t sliceVoxels = (size_t)res * res;
+	for (size_t head = 0; head < queue.size(); head++) {
+		size_t index = queue[head];
+		int x = (int)(index % res);
+		int y = (int)((index / res) % res);
+		int z = (int)(index / sliceVoxels);
+		if (x > 0) visit(index - 1);
+		if (x < res - 1) visit(index + 1);
+		if (y > 0) visit(index - res);
+		if (y < res - 1) visit(index + res);
+		if (z > 0) visit(index - sliceVoxels);
+		if (z < res - 1) visit(index + sliceVoxels);
+	}
+
+	for (size_t i = 0; i < voxelCount; i++) {
+		if (!outside[i] && !(flags[i] & kFlagBand)) flags[i] |= kFlagInside;
+	}
+}
+
+//--------------------------------------------------------------
+void SDFBaker::sweep(int direction) {
+	// Godunov upwind update of |grad d| = 1 on unsigned distances; band
+	// voxels are exact and stay fixed
+	int res = volume.resolution;
+	float h = volume.size / res;
+	auto & d = volume.distances;
+	const float inf = std::numeric_limits<float>::infinity();
+	size_t sliceVoxels = (size_t)res * res;
+
+	int dx = (direction & 1) ? -1 : 1;
+	int dy = (direction & 2) ? -1 : 1;
+	int dz = (direction & 4) ? -1 : 1;
+
+	auto neighbourMin = [&](size_t index, int coord, size_t stride) {
+		float m = inf;
+		if (coord > 0) m = std::min(m, std::fabs(d[index - stride]));
+		if (coord < res - 1) m = std::min(m, std::fabs(d[index + stride]));
+		return m;
+	};
+
+	for (int z = dz > 0 ? 0 : res - 1; z >= 0 && z < res; z += dz) {
+		for (int y = dy > 0 ? 0 : res - 1; y >= 0 && y < res; y += dy) {
+			for (int x = dx > 0 ? 0 : res - 1; x >= 0 && x < res; x += dx) {
+				size_t index = (size_t)z * sliceVoxels + (size_t)y * res + x;
+				if (flags[index] & kFlagBand) continue;
+
+				float a[3] = { neighbourMin(index, x, 1), neighbourMin(index, y, res), neighbourMin(index, z, sliceVoxels) };
+				std::sort(a, a + 3);
+				if (a[0] == inf) continue;
+
+				float u = a[0] + h;
+				if (u > a[1]) {
+					float diff = a[0] - a[1];
+					u = 0.5f * (a[0] + a[1] + std::sqrt(std::max(0.0f, 2.0f * h * h - diff * diff)));
+					if (u > a[2]) {
+						float s = a[0] + a[1] + a[2];
+						float q = a[0] * a[0] + a[1] * a[1] + a[2] * a[2] - h * h;
+						u = (s + std::sqrt(std::max(0.0f, s * s - 3.0f * q))) / 3.0f;
+					}
+				}
+				if (u < d[index]) d[index] = u;
+			}
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void SDFBaker::finish() {
+	// Far-field voxels were swept as unsigned distances
+	auto & d = volume.distances;
+	for (size_t i = 0; i < d.size(); i++) {
+		if (flags[i] & kFlagBand) continue;
+		if (std::isinf(d[i])) d[i] = volume.size;
+		if (flags[i] & kFlagInside) d[i] = -d[i];
+	}
+
+	bvh = nullptr;
+	normals.clear();
+	flags.clear();
+	flags.shrink_to_fit();
+	phase = PHASE_DONE;
+}
+
+//--------------------------------------------------------------
+void SDFBaker::setVolume(const Volume & baked) {
+	clear();
+	volume = baked;
+	phase = PHASE_DONE;
+}
+
+//--------------------------------------------------------------
+uint64_t SDFBaker::computeKey(const std::vector<glm::vec3> & vertices, const std::vector<unsigned int> & indices, int resolution) {
+	uint64_t hash = kHashSeed;
+	int32_t resolutionValue = resolution;
+	hash = hashBytes(hash, &resolutionValue, sizeof(resolutionValue));
+	hash = hashBytes(hash, vertices.data(), vertices.size() * sizeof(glm::vec3));
+	hash = hashBytes(hash, indices.data(), indices.size() * sizeof(unsigned int));
+	return hash;
+}
+
+//--------------------------------------------------------------
+bool SDFBaker::loadCache(const std::string & path, uint64_t key, Volume & outVolume) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file) return false;
+
+	uint32_t magic = 0;
+	uint64_t storedKey = 0;
+	int32_t resolution = 0;
+	Volume loaded;
+	file.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+	file.read(reinterpret_cast<char *>(&storedKey), sizeof(storedKey));
+	file.read(reinterpret_cast<char *>(&resolution), sizeof(resolution));
+	file.read(reinterpret_cast<char *>(&loaded.origin), sizeof(loaded.origin));
+	file.read(reinterpret_cast<char *>(&loaded.size), sizeof(loaded.size));
+	if (!file || magic != kCacheMagic || storedKey != key || resolution < 2 || resolution > 1024) {
+		return false;
+	}
+
+	loaded.resolution = resolution;
+	loaded.distances.resize((size_t)resolution * resolution * resolution);
+	file.read(reinterpret_cast<char *>(loaded.distances.data()), loaded.distances.size() * sizeof(float));
+	if (!file) return false;
+
+	outVolume = std::move(loaded);
+	return true;
+}
+
+//--------------------------------------------------------------
+bool SDFBaker::saveCache(const std::string & path, uint64_t key, const Volume & volume) {
+	if (volume.resolution < 2) return false;
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file) return false;
+
+	int32_t resolution = volume.resolution;
+	file.write(reinterpret_cast<const char *>(&kCacheMagic), sizeof(kCacheMagic));
+	file.write(reinterpret_cast<const char *>(&key), sizeof(key));
+	file.write(reinterpret_cast<const char *>(&resolution), sizeof(resolution));
+	file.write(reinterpret_cast<const char *>(&volume.origin), sizeof(volume.origin));
+	file.write(reinterpret_cast<const char *>(&volume.size), sizeof(volume.size));
+	file.write(reinterpret_cast<const char *>(volume.distances.data()), volume.distances.size() * sizeof(float));
+	return (bool)file;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include "MeshBVH.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Bakes a mesh into a cubic signed distance grid (negative inside). GL-independent.
+//
+// The bake is incremental so it can be spread over several frames:
+//  1. narrow band: exact BVH closest-point distances for voxels within a few
+//     voxels of the surface, a batch of z-slices per step (parallel); the
+//     sign comes from the interpolated normal at the closest point
+//  2. sign: flood fill from the volume border marks the outside, every
+//     unreached voxel is inside
+//  3. fast sweeping: eight Gauss-Seidel sweeps of the eikonal equation fill
+//     in the far field, one sweep direction per step
+// Bounding the BVH queries to the band keeps them cheap; unbounded queries
+// deep inside a model would otherwise have to visit most of the tree.
+class SDFBaker {
+public:
+	struct Settings {
+		int resolution = 128;
+		float padding = 0.1f; // empty border around the model, relative to its size
+		float bandVoxels = 2.0f; // half-width of the exactly computed band
+		int workers = 0; // 0 = all hardware threads
+	};
+
+	// Voxel (x, y, z) is distances[(z * resolution + y) * resolution + x]; its
+	// center sits at origin + (index + 0.5) * size / resolution
+	struct Volume {
+		int resolution = 0;
+		glm::vec3 origin = glm::vec3(0.0f);
+		float size = 0.0f;
+		std::vector<float> distances;
+	};
+
+	// Sets up the volume around the mesh in bvh; normals may be empty. bvh
+	// must stay alive until the bake completes.
+	void begin(const MeshBVH & bvh, const std::vector<glm::vec3> & normals, const Settings & settings);
+
+	// Advances the bake: up to maxSlices band slices, or one later stage
+	void bakeStep(int maxSlices);
+
+	bool isBaking() const { return phase != PHASE_IDLE && phase != PHASE_DONE; }
+	bool isComplete() const { return phase == PHASE_DONE; }
+	float getProgress() const;
+	const Volume & getVolume() const { return volume; }
+
+	// Replace the volume with a finished one (e.g. from the cache)
+	void setVolume(const Volume & baked);
+	void clear();
+
+	static uint64_t computeKey(const std::vector<glm::vec3> & vertices, const std::vector<unsigned int> & indices, int resolution);
+	static bool loadCache(const std::string & path, uint64_t key, Volume & outVolume);
+	static bool saveCache(const std::string & path, uint64_t key, const Volume & volume);
+
+private:
+	enum Phase { PHASE_IDLE, PHASE_BAND, PHASE_SIGN, PHASE_SWEEP, PHASE_DONE };
+
+	const MeshBVH * bvh = nullptr;
+	std::vector<glm::vec3> normals;
+	Settings settings;
+	Volume volume;
+	std::vector<uint8_t> flags; // per voxel: in band / inside
+	Phase phase = PHASE_IDLE;
+	int bakedSlices = 0;
+	int sweepIndex = 0;
+
+	void bakeBand(int maxSlices);
+	void classifySign();
+	void sweep(int direction);
+	void finish();
+};
@@ -1,34 +1,125 @@
+#include "core/BenchRunner.h"
+#include "core/DisplayManager.h"
+#include "core/FrameScheduler.h"
+#include "core/UploadService.h"
 #include "ofAppGLFWWindow.h"
 #include "ofMain.h"
 #include "screens/Screen1App.h"
 #include "screens/Screen2App.h"
 #include "screens/Screen3App.h"
+#include "utils/GlThread.h"
+#include "utils/HotLog.h"
+#include "utils/Trace.h"
 
-int main() {
+int main(int argc, char * argv[]) {
 	ofLogNotice("main") << "Starting simplified multi-window application...";
 
-	// === 1ģʾĻ ===
-	ofGLFWWindowSettings settings1;
-	settings1.setSize(1024, 768);
-	settings1.setPosition(glm::vec2(100, 100));
-	settings1.resizable = true;
-	auto window1 = ofCreateWindow(settings1);
-
-	// === 2ЧĻ ===
-	ofGLFWWindowSettings settings2;
-	settings2.setSize(1024, 768);
-	settings2.setPosition(glm::vec2(1150, 100));
-	settings2.resizable = true;
-	settings2.shareContextWith = window1; // Ĺ
-	auto window2 = ofCreateWindow(settings2);
-
-	// === 3ЧĻ ===
-	ofGLFWWindowSettings settings3;
-	settings3.setSize(1024, 768);
-	settings3.setPosition(glm::vec2(625, 900));
-	settings3.resizable = true;
-	settings3.shareContextWith = window1; // Ĺ
-	auto window3 = ofCreateWindow(settings3);
+	// --trace records from startup and dumps the last --trace-seconds=N
+	// (default 10) when the app exits; 'T' in any window works as well
+	double traceSeconds = 10.0;
+
+	// --bench runs the scripted benchmark in hidden windows, prints JSON and
+	// exits; --bench-frames= / --bench-warmup= / --bench-step= (seconds)
+	// override the script, --bench-script= and --bench-out= pick the files
+	bool bench = false;
+	BenchRunner::Settings benchSettings;
+
+	// --rates=30,60,60 sets the Screen1/2/3 target rates in Hz (0 = uncapped)
+	vector<float> rates = { 30.0f, 60.0f, 60.0f };
+
+	// --single-window shows the three screens side by side in one window
+	// (one context, one swap per frame); --span-displays makes that window
+	// fullscreen across every display
+	bool singleWindow = false;
+	bool spanDisplays = false;
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		string value = arg.substr(arg.find('=') + 1);
+		if (arg == "--trace") {
+			Trace::setEnabled(true);
+		} else if (ofIsStringInString(arg, "--trace-seconds=")) {
+			traceSeconds = std::max(1.0, ofToDouble(value));
+		} else if (arg == "--bench") {
+			bench = true;
+		} else if (ofIsStringInString(arg, "--bench-frames=")) {
+			benchSettings.frames = ofToInt(value);
+		} else if (ofIsStringInString(arg, "--bench-warmup=")) {
+			benchSettings.warmup = ofToInt(value);
+		} else if (ofIsStringInString(arg, "--bench-step=")) {
+			benchSettings.step = ofToDouble(value);
+		} else if (ofIsStringInString(arg, "--bench-script=")) {
+			benchSettings.scriptPath = value;
+		} else if (ofIsStringInString(arg, "--bench-out=")) {
+			benchSettings.outputPath = value;
+		} else if (arg == "--single-window") {
+			singleWindow = true;
+		} else if (arg == "--span-displays") {
+			singleWindow = true;
+			spanDisplays = true;
+		} else if (ofIsStringInString(arg, "--rates=")) {
+			vector<string> parts = ofSplitString(value, ",", true, true);
+			for (size_t r = 0; r < parts.size() && r < rates.size(); r++) {
+				rates[r] = ofToFloat(parts[r]);
+			}
+		}
+	}
+	if (bench) {
+		// Keep stdout for the results
+		ofSetLogLevel(OF_LOG_WARNING);
+	}
+	Trace::setThreadName("main");
+	// Per-frame log calls are drained to the console from here on
+	HotLog::start();
+	// The shared GL context lives here; screen CPU phases run on workers
+	GlThread::markContextThread();
+
+	shared_ptr<ofAppBaseWindow> window1, window2, window3;
+	shared_ptr<DisplayManager> displayManager;
+	if (singleWindow) {
+		ofGLFWWindowSettings hostSettings;
+		hostSettings.setSize(1024 * 3, 768);
+		hostSettings.setPosition(glm::vec2(0, 100));
+		hostSettings.resizable = true;
+		hostSettings.visible = !bench;
+		if (spanDisplays) {
+			hostSettings.windowMode = OF_FULLSCREEN;
+			hostSettings.multiMonitorFullScreen = true;
+		}
+		auto host = ofCreateWindow(hostSettings);
+		host->setWindowTitle("Screen1 | Screen2 | Screen3");
+
+		displayManager = std::make_shared<DisplayManager>(host);
+		window1 = displayManager->addViewport("Screen1");
+		window2 = displayManager->addViewport("Screen2");
+		window3 = displayManager->addViewport("Screen3");
+		ofRunApp(host, displayManager);
+	} else {
+		// === 1ģʾĻ ===
+		ofGLFWWindowSettings settings1;
+		settings1.setSize(1024, 768);
+		settings1.setPosition(glm::vec2(100, 100));
+		settings1.resizable = true;
+		settings1.visible = !bench;
+		window1 = ofCreateWindow(settings1);
+
+		// === 2ЧĻ ===
+		ofGLFWWindowSettings settings2;
+		settings2.setSize(1024, 768);
+		settings2.setPosition(glm::vec2(1150, 100));
+		settings2.resizable = true;
+		settings2.visible = !bench;
+		settings2.shareContextWith = window1; // Ĺ
+		window2 = ofCreateWindow(settings2);
+
+		// === 3ЧĻ ===
+		ofGLFWWindowSettings settings3;
+		settings3.setSize(1024, 768);
+		settings3.setPosition(glm::vec2(625, 900));
+		settings3.resizable = true;
+		settings3.visible = !bench;
+		settings3.shareContextWith = window1; // Ĺ
+		window3 = ofCreateWindow(settings3);
+	}
 
 	// Ӧʵ
 	auto screen1App = std::make_shared<Screen1App>();
@@ -42,6 +133,46 @@ int main() {
 	ofRunApp(window2, screen2App);
 	ofRunApp(window3, screen3App);
 
-	ofRunMainLoop();
+	// Producers before consumers: Screen3 reads what Screen1/2 publish
+	FrameScheduler scheduler;
+	scheduler.addScreen("Screen1", window1)
+		.setRate(bench ? 0.0f : rates[0])
+		.setCpuPhase(screen1App.get())
+		.produces(CHANNEL_SCREEN1_MESH)
+		.produces(CHANNEL_SCREEN1_POSITION);
+	scheduler.addScreen("Screen2", window2)
+		.setRate(bench ? 0.0f : rates[1])
+		.setCpuPhase(screen2App.get())
+		.produces(CHANNEL_SCREEN2_MESH)
+		.produces(CHANNEL_SCREEN2_POSITION);
+	scheduler.addScreen("Screen3", window3)
+		.setRate(bench ? 0.0f : rates[2])
+		.setCpuPhase(screen3App.get())
+		.consumes(CHANNEL_SCREEN1_MESH, [screen3App]() { return screen3App->readsMeshes(); })
+		.consumes(CHANNEL_SCREEN2_MESH, [screen3App]() { return screen3App->readsMeshes(); })
+		.consumes(CHANNEL_SCREEN1_POSITION, [screen3App]() { return screen3App->readsPositionTargets(); })
+		.consumes(CHANNEL_SCREEN2_POSITION, [screen3App]() { return screen3App->readsPositionTargets(); });
+	scheduler.setRenderHidden(bench);
+	if (displayManager) scheduler.setPresentWindow(displayManager->getHost());
+
+	// Screen3's large buffer and texture uploads run on their own context
+	UploadService::get().setup(displayManager ? displayManager->getHost() : window1);
+
+	BenchRunner benchRunner;
+	if (bench) {
+		benchRunner.addScreen("Screen1", window1, screen1App);
+		benchRunner.addScreen("Screen2", window2, screen2App);
+		benchRunner.addScreen("Screen3", window3, screen3App);
+		if (!benchRunner.setup(benchSettings)) return 1;
+	}
+
+	scheduler.run();
+
+	if (Trace::isEnabled()) {
+		string path = ofToDataPath("trace_exit_" + ofGetTimestampString() + ".json", true);
+		if (Trace::dump(path, traceSeconds)) {
+			ofLogNotice("main") << "Trace written to " << path;
+		}
+	}
 	return 0;
 }
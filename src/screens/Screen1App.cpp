@@ -1,4 +1,11 @@
 #include "Screen1App.h"
+#include "utils/GlThread.h"
+#include "utils/HotLog.h"
+#include "utils/PositionTargets.h"
+#include "utils/Trace.h"
+
+// Auto LOD aims for roughly one triangle per this many covered pixels
+static const float kLodPixelsPerTriangle = 2.0f;
 
 Screen1App::Screen1App()
 	: dataManager(DataManager::getInstance()) {
@@ -10,10 +17,10 @@ void Screen1App::setup() {
 
 	setupCamera();
 	setupShaders();
-	setupFBO();
 	setupDefaultParams();
 	setupGui();
 	setupPositionRendering();
+	setupGallery();
 	// Ĭģ
 	loadDefaultModel();
 
@@ -45,11 +52,6 @@ void Screen1App::setupShaders() {
 	}
 }
 
-//--------------------------------------------------------------
-void Screen1App::setupFBO() {
-	fbo.allocate(ofGetWidth(), ofGetHeight(), GL_RGBA);
-}
-
 //--------------------------------------------------------------
 void Screen1App::setupDefaultParams() {
 	// ʼղ
@@ -72,12 +74,25 @@ void Screen1App::setupGui() {
 	guiRotationSpeed.set("Rotation Speed", rotationSpeed, 0.0f, 180.0f);
 	guiModelScale.set("Model Scale", 1.0f, 0.1f, 5.0f);
 	guiLightIntensity.set("Light Intensity", lightingParams.lightIntensity, 0.0f, 3.0f);
+	guiAutoLod.set("Auto LOD", true);
+	guiGalleryMode.set("Gallery Mode", false);
+	guiGalleryCount.set("Gallery Instances", 400, 1, 2000);
+	guiGallerySpacing.set("Gallery Spacing", 2.5f, 1.2f, 6.0f);
+	guiAdaptiveQuality.set("Adaptive Quality", true);
+	guiFrameBudget.set("Frame Budget (ms)", 16.6f, 8.0f, 50.0f);
 
 	// ӵGUI
 	gui.add(guiAutoRotation);
 	gui.add(guiRotationSpeed);
 	gui.add(guiModelScale);
 	gui.add(guiLightIntensity);
+	gui.add(guiAutoLod);
+	gui.add(guiGalleryMode);
+	gui.add(guiGalleryCount);
+	gui.add(guiGallerySpacing);
+	gui.add(guiAdaptiveQuality);
+	gui.add(guiFrameBudget);
+	guiCache.setup(gui, "Screen1");
 }
 
 //--------------------------------------------------------------
@@ -97,9 +112,9 @@ void Screen1App::updateFromGui() {
 }
 
 //--------------------------------------------------------------
-void Screen1App::updateRotation() {
+void Screen1App::updateRotation(float deltaTime) {
 	if (guiAutoRotation) {
-		currentRotationY += rotationSpeed * ofGetLastFrameTime();
+		currentRotationY += rotationSpeed * deltaTime;
 		if (currentRotationY >= 360.0f) {
 			currentRotationY -= 360.0f;
 		}
@@ -107,78 +122,129 @@ void Screen1App::updateRotation() {
 }
 
 //--------------------------------------------------------------
-void Screen1App::update() {
-	elapsedTime = ofGetElapsedTimef();
-	dataManager.setElapsedTime(elapsedTime);
-
-	// ⴰڴС仯
-	static int lastWidth = ofGetWidth();
-	static int lastHeight = ofGetHeight();
+void Screen1App::updateCpu(const CpuFrame & frame) {
+	TRACE_SCOPE("Screen1", "updateCpu");
+	governor.beginCpu();
 
-	if (lastWidth != ofGetWidth() || lastHeight != ofGetHeight()) {
-		handleWindowResize(ofGetWidth(), ofGetHeight());
-		lastWidth = ofGetWidth();
-		lastHeight = ofGetHeight();
-	}
+	elapsedTime = frame.time;
+	dataManager.setElapsedTime(elapsedTime);
 
 	// GUI²
 	updateFromGui();
 
 	// ת
-	updateRotation();
-	renderToPositionTexture();
+	updateRotation(frame.deltaTime);
+	updateLodSelection(frame.height);
 
-	if (isModelLoaded) {
+	if (isModelLoaded && dataManager.isChannelWanted(CHANNEL_SCREEN1_MESH)) {
 		dataManager.setScreen1Mesh(loadedModel);
 		dataManager.setScreen1ModelMatrix(getModelMatrix());
 
-		static int frameCount = 0;
-		if (frameCount++ % 120 == 0) {
-			ofLogNotice("Screen1App") << "Sharing model with " << loadedModel.getNumVertices() << " vertices";
-		}
+		HOT_LOG_NOTICE("Screen1App", 2.0f, "Sharing model with %d vertices", (int)loadedModel.getNumVertices());
 	}
+
+	governor.endCpu();
 }
 
 //--------------------------------------------------------------
-void Screen1App::handleWindowResize(int w, int h) {
-	if (fbo.isAllocated()) {
-		fbo.clear();
+void Screen1App::update() {
+	TRACE_SCOPE("Screen1", "update");
+	GL_THREAD_CHECK();
+	profiler.beginFrame();
+
+	// Adapt quality to the previous frame's timings before any GL work
+	governor.setEnabled(guiAdaptiveQuality);
+	governor.setBudgetMs(guiFrameBudget);
+	if (governor.update(gpuTimer.poll() ? gpuTimer.getLastMs() : -1.0f)) {
+		applyQualityLevel();
 	}
-	fbo.allocate(w, h, GL_RGBA);
+	gpuTimer.begin();
+	governor.beginCpu();
 
-	fbo.begin();
-	ofClear(20);
-	fbo.end();
+	readback.update();
 
-	cam.setAspectRatio((float)w / (float)h);
+	// ⴰڴС仯
+	// The pooled target follows the window every frame; the position
+	// target is reallocated once the size has settled
+	cam.setAspectRatio((float)ofGetWidth() / (float)ofGetHeight());
+	if (resizeDebouncer.update(ofGetWidth(), ofGetHeight())) {
+		handleWindowResize(ofGetWidth(), ofGetHeight());
+	}
+
+	// Needs the camera's viewport, so it is submitted from here rather
+	// than from updateCpu()
+	updateGallery();
+	// Only rendered while a consumer reads it
+	if (dataManager.isChannelWanted(CHANNEL_SCREEN1_POSITION)) {
+		profiler.begin("renderToPositionTexture");
+		renderToPositionTexture();
+		profiler.end("renderToPositionTexture");
+	}
 
-	ofLogNotice("Screen1App") << "Window resized to: " << w << "x" << h;
+	governor.endCpu();
+}
+
+//--------------------------------------------------------------
+void Screen1App::applyQualityLevel() {
+	const FrameGovernor::Level & level = governor.getLevel();
+	if (level.renderScale != renderScale) {
+		renderScale = level.renderScale;
+		handleWindowResize(ofGetWidth(), ofGetHeight());
+	}
+	// The LOD budget follows level.lodScale in updateLodSelection()
+}
+
+//--------------------------------------------------------------
+int Screen1App::getScaledSize(int size) const {
+	return std::max(1, (int)std::round(size * renderScale));
+}
+
+//--------------------------------------------------------------
+void Screen1App::handleWindowResize(int w, int h) {
+	allocatePositionFBO(w, h);
+
+	ofLogNotice("Screen1App") << "Window resized to: " << w << "x" << h << " (render scale " << renderScale << ")";
 }
 
 //--------------------------------------------------------------
 void Screen1App::draw() {
-	renderToFBO();
-	fbo.draw(0, 0);
+	TRACE_SCOPE("Screen1", "draw");
+	GL_THREAD_CHECK();
+	governor.beginCpu();
+
+	uploadGallery();
+	// Returned to the pool at the end of draw(), for the next screen
+	RenderTargetPool::Target target
+		= RenderTargetPool::get().acquire(getScaledSize(ofGetWidth()), getScaledSize(ofGetHeight()));
+	profiler.begin("renderToFBO");
+	renderToFBO(target);
+	profiler.end("renderToFBO");
+	target.draw(0, 0, ofGetWidth(), ofGetHeight());
 
 	if (showGui) {
-		gui.draw();
+		profiler.begin("gui.draw");
+		guiCache.draw();
+		profiler.end("gui.draw");
 	}
 
 	if (!showGui) {
 		renderUI();
 	}
+
+	gpuTimer.end();
+	governor.endCpu();
 }
 
 //--------------------------------------------------------------
-void Screen1App::renderToFBO() {
-	fbo.begin();
+void Screen1App::renderToFBO(RenderTargetPool::Target & target) {
+	target.begin();
 	ofClear(20, 20, 20, 255); // ɫ
 
 	cam.begin();
 	renderModel();
 	cam.end();
 
-	fbo.end();
+	target.end();
 }
 
 //--------------------------------------------------------------
@@ -190,6 +256,22 @@ void Screen1App::renderModel() {
 		return;
 	}
 
+	if (isGalleryActive()) {
+		renderGallery();
+	} else {
+		renderHero();
+	}
+
+	// Դӻ
+	ofPushStyle();
+	ofSetColor(255, 255, 100);
+	ofVec3f lightPos = calculateLightPosition();
+	ofDrawSphere(lightPos, 8.0f);
+	ofPopStyle();
+}
+
+//--------------------------------------------------------------
+void Screen1App::renderHero() {
 	ofPushMatrix();
 
 	// Ӧñ任
@@ -203,38 +285,130 @@ void Screen1App::renderModel() {
 		setShaderUniforms();
 
 		ofSetColor(255);
-		loadedModel.draw();
+		getRenderMesh().draw();
 
 		modelShader.end();
 	} else {
 		// Ⱦ
 		ofSetColor(200, 200, 255);
-		loadedModel.draw();
+		getRenderMesh().draw();
 
 		// ߿Ⱦ
 		ofPushStyle();
 		ofNoFill();
 		ofSetLineWidth(1.0f);
 		ofSetColor(255, 255, 100);
-		loadedModel.drawWireframe();
+		getRenderMesh().drawWireframe();
 		ofPopStyle();
 	}
 
 	ofPopMatrix();
+}
 
-	// Դӻ
-	ofPushStyle();
-	ofSetColor(255, 255, 100);
-	ofVec3f lightPos = calculateLightPosition();
-	ofDrawSphere(lightPos, 8.0f);
-	ofPopStyle();
+//--------------------------------------------------------------
+void Screen1App::setupGallery() {
+	if (!instancedShader.load("shaders/screen1/instanced.vert", "shaders/model/basic.frag")) {
+		ofLogWarning("Screen1App") << "Instanced shader failed to load, gallery mode unavailable";
+	}
+	glGenBuffers(1, &instanceBuffer);
+	glGenTextures(1, &instanceTexture);
+}
+
+//--------------------------------------------------------------
+bool Screen1App::isGalleryActive() const {
+	return guiGalleryMode && isModelLoaded && instancedShader.isLoaded();
+}
+
+//--------------------------------------------------------------
+void Screen1App::updateGallery() {
+	if (!isGalleryActive()) return;
+	// Still running when draw() was skipped (hidden window)
+	if (galleryTask.isValid()) TaskSystem::get().wait(galleryTask);
+
+	InstanceField::Settings settings = instanceField.getSettings();
+	if (instanceField.getCount() != (size_t)guiGalleryCount.get() || settings.spacing != guiGallerySpacing.get()
+		|| instanceField.getModelRadius() != modelRadius) {
+		settings.count = guiGalleryCount;
+		settings.spacing = guiGallerySpacing;
+		instanceField.setup(settings, modelRadius);
+	}
+
+	// Transforms and culling run on the task system while the rest of
+	// update() renders the position pass; draw() joins before uploading
+	glm::mat4 viewProjection = cam.getModelViewProjectionMatrix();
+	float time = elapsedTime;
+	float rotation = currentRotationY;
+	float scale = modelScale.x;
+	galleryTask = TaskSystem::get().submit([this, time, rotation, scale, viewProjection]() {
+		uint64_t start = ofGetElapsedTimeMicros();
+		instanceField.update(time, rotation, scale, viewProjection);
+		instanceUpdateMs = (ofGetElapsedTimeMicros() - start) / 1000.0f;
+	});
+}
+
+//--------------------------------------------------------------
+void Screen1App::uploadGallery() {
+	if (!galleryTask.isValid()) return;
+	GL_THREAD_CHECK();
+	TaskSystem::get().wait(galleryTask);
+	galleryTask = TaskSystem::Handle();
+
+	// Orphan last frame's storage so the upload never waits for the draw using it
+	const auto & data = instanceField.getVisibleData();
+	size_t bytes = data.size() * sizeof(glm::vec4);
+	glBindBuffer(GL_TEXTURE_BUFFER, instanceBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+	if (bytes > 0) {
+		glBufferSubData(GL_TEXTURE_BUFFER, 0, bytes, data.data());
+	}
+	glBindTexture(GL_TEXTURE_BUFFER, instanceTexture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, instanceBuffer);
+
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+//--------------------------------------------------------------
+void Screen1App::renderGallery() {
+	size_t visible = instanceField.getVisibleCount();
+	if (visible == 0) return;
+
+	ofEnableDepthTest();
+	instancedShader.begin();
+	instancedShader.setUniformMatrix4f("viewProjectionMatrix", cam.getModelViewProjectionMatrix());
+	setLightingUniforms(instancedShader);
+
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_BUFFER, instanceTexture);
+	instancedShader.setUniform1i("instanceData", 0);
+
+	// Every visible instance in one glDrawElementsInstanced
+	getRenderMesh().drawInstanced((int)visible);
+
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+	instancedShader.end();
+	ofDisableDepthTest();
+}
+
+//--------------------------------------------------------------
+void Screen1App::cleanupGallery() {
+	// The in-flight update writes into instanceField
+	if (galleryTask.isValid()) TaskSystem::get().wait(galleryTask);
+	if (instanceBuffer != 0) {
+		glDeleteBuffers(1, &instanceBuffer);
+		instanceBuffer = 0;
+	}
+	if (instanceTexture != 0) {
+		glDeleteTextures(1, &instanceTexture);
+		instanceTexture = 0;
+	}
 }
 
 //--------------------------------------------------------------
 void Screen1App::setShaderUniforms() {
 	setBasicUniforms();
 	setMatrixUniforms();
-	setLightingUniforms();
+	setLightingUniforms(modelShader);
 }
 
 //--------------------------------------------------------------
@@ -256,16 +430,16 @@ void Screen1App::setMatrixUniforms() {
 }
 
 //--------------------------------------------------------------
-void Screen1App::setLightingUniforms() {
+void Screen1App::setLightingUniforms(ofShader & shader) {
 	ofVec3f lightPos = calculateLightPosition();
 	ofVec3f camPos = cam.getPosition();
 
-	modelShader.setUniform3f("lightPosition", lightPos.x, lightPos.y, lightPos.z);
-	modelShader.setUniform3f("cameraPosition", camPos.x, camPos.y, camPos.z);
-	modelShader.setUniform3f("lightColor", 1.0f, 1.0f, 1.0f);
-	modelShader.setUniform3f("ambientColor", 0.2f, 0.2f, 0.2f);
-	modelShader.setUniform1f("lightIntensity", lightingParams.lightIntensity);
-	modelShader.setUniform1f("shininess", lightingParams.specularShininess);
+	shader.setUniform3f("lightPosition", lightPos.x, lightPos.y, lightPos.z);
+	shader.setUniform3f("cameraPosition", camPos.x, camPos.y, camPos.z);
+	shader.setUniform3f("lightColor", 1.0f, 1.0f, 1.0f);
+	shader.setUniform3f("ambientColor", 0.2f, 0.2f, 0.2f);
+	shader.setUniform1f("lightIntensity", lightingParams.lightIntensity);
+	shader.setUniform1f("shininess", lightingParams.specularShininess);
 }
 
 //--------------------------------------------------------------
@@ -315,6 +489,13 @@ void Screen1App::loadDefaultModel() {
 		sphere.set(80, 32);
 		loadedModel = sphere.getMesh();
 		isModelLoaded = true;
+		MeshLod sphereLod;
+		sphereLod.mesh = loadedModel;
+		setModelLods({ sphereLod });
+		SubmeshRange sphereRange;
+		sphereRange.name = "sphere";
+		sphereRange.indexCount = loadedModel.getNumIndices();
+		modelSubmeshes.assign(1, sphereRange);
 		currentModelPath = "primitive_sphere";
 		ofLogNotice("Screen1App") << "Default sphere created: " << loadedModel.getNumVertices() << " vertices";
 	}
@@ -330,9 +511,15 @@ void Screen1App::loadModelFromFile(const string & filepath) {
 			loadedModel = tempMesh;
 			isModelLoaded = true;
 			currentModelPath = filepath;
+			modelSubmeshes = modelLoader.getSubmeshes();
+
+			vector<MeshLod> lods;
+			modelLoader.generateLods(loadedModel, lods);
+			setModelLods(lods);
 			ofLogNotice("Screen1App") << "Successfully loaded model: " << filepath;
 			ofLogNotice("Screen1App") << "Vertices: " << loadedModel.getNumVertices();
 			ofLogNotice("Screen1App") << "Indices: " << loadedModel.getNumIndices();
+			ofLogNotice("Screen1App") << "Objects: " << modelSubmeshes.size();
 		} else {
 			ofLogError("Screen1App") << "Model validation failed: " << filepath;
 		}
@@ -349,13 +536,74 @@ bool Screen1App::validateModel(const ofVboMesh & mesh) {
 	}
 
 	if (mesh.getNumVertices() > 100000) {
-		ofLogWarning("Screen1App") << "Large model detected (" << mesh.getNumVertices() << " vertices)";
+		ofLogWarning("Screen1App") << "Large model detected (" << mesh.getNumVertices() << " vertices), rendering through LOD chain";
 		// ֹأֻǾ
 	}
 
 	return true;
 }
 
+//--------------------------------------------------------------
+void Screen1App::setModelLods(const vector<MeshLod> & lods) {
+	modelLods = lods;
+	currentLod = 0;
+
+	modelRadius = 0.0f;
+	if (!modelLods.empty()) {
+		for (const auto & v : modelLods[0].mesh.getVertices()) {
+			modelRadius = std::max(modelRadius, glm::length(v));
+		}
+	}
+
+	// Screen3 picks the LOD that matches its cube grid from here
+	dataManager.setScreen1MeshLods(modelLods);
+
+	// A newer load supersedes one still uploading
+	unsigned int id = ++lodUploadId;
+	auto uploads = std::make_shared<vector<std::shared_ptr<GpuMesh>>>();
+	auto remaining = std::make_shared<size_t>(modelLods.size());
+	for (const auto & lod : modelLods) {
+		uploads->push_back(GpuMesh::create(lod.mesh, [this, id, uploads, remaining]() {
+			if (--*remaining > 0 || id != lodUploadId) return;
+			renderLods = *uploads;
+			ofLogNotice("Screen1App") << "Model uploaded: " << renderLods.size() << " LODs";
+		}));
+	}
+}
+
+//--------------------------------------------------------------
+const GpuMesh & Screen1App::getRenderMesh() const {
+	// Until the first model is resident there is nothing to draw
+	static const GpuMesh empty;
+	if (renderLods.empty()) return empty;
+	return *renderLods[std::max(0, std::min(currentLod, (int)renderLods.size() - 1))];
+}
+
+//--------------------------------------------------------------
+void Screen1App::updateLodSelection(int viewportHeight) {
+	currentLod = 0;
+	if (!guiAutoLod || modelLods.size() <= 1) return;
+
+	// Projected radius of the bounding sphere in pixels
+	float radius = modelRadius * std::max({ modelScale.x, modelScale.y, modelScale.z });
+	if (isGalleryActive()) {
+		// One LOD for the whole field, chosen for a copy at the field's center
+		radius *= instanceField.getSettings().instanceScale;
+	}
+	float distance = std::max(1.0f, glm::distance(cam.getGlobalPosition(), glm::vec3(modelPosition)));
+	float halfFov = ofDegToRad(cam.getFov()) * 0.5f;
+	float projectedRadius = radius / (distance * tanf(halfFov)) * getScaledSize(viewportHeight) * 0.5f;
+	float targetTriangles = PI * projectedRadius * projectedRadius / kLodPixelsPerTriangle * governor.getLevel().lodScale;
+
+	// Coarsest LOD that still has enough triangles for its screen footprint
+	for (int i = (int)modelLods.size() - 1; i > 0; i--) {
+		if (modelLods[i].mesh.getNumIndices() / 3 >= targetTriangles) {
+			currentLod = i;
+			return;
+		}
+	}
+}
+
 //--------------------------------------------------------------
 ofMatrix4x4 Screen1App::getModelMatrix() const {
 	ofMatrix4x4 matrix;
@@ -367,43 +615,52 @@ ofMatrix4x4 Screen1App::getModelMatrix() const {
 
 //--------------------------------------------------------------
 void Screen1App::renderUI() {
-	ofSetColor(255);
-	string info = getDebugInfo();
-	ofDrawBitmapString(info, 10, 20);
-
-	// ڴСʾ
-	ofSetColor(255, 255, 0);
-	string sizeInfo = "Window: " + ofToString(ofGetWidth()) + "x" + ofToString(ofGetHeight())
-		+ " | FBO: " + ofToString(fbo.getWidth()) + "x" + ofToString(fbo.getHeight());
-	ofDrawBitmapString(sizeInfo, 10, ofGetHeight() - 20);
+	updateHud();
+	hud.draw();
 }
 
 //--------------------------------------------------------------
-string Screen1App::getDebugInfo() {
-	string info = "FPS: " + ofToString(ofGetFrameRate(), 0) + "\n";
-	info += "Model: ";
+void Screen1App::updateHud() {
+	hud.begin(10, 20);
+	hud.addLinef("FPS: %.0f", ofGetFrameRate());
 	if (isModelLoaded) {
-		info += "LOADED\n";
-		info += "Vertices: " + ofToString(loadedModel.getNumVertices()) + "\n";
-		info += "File: " + currentModelPath + "\n";
-	} else {
-		info += "NONE\n";
-	}
-	info += "Shader: ";
-	if (modelShader.isLoaded()) {
-		info += "LOADED\n";
+		hud.addLine("Model: LOADED");
+		hud.addLinef("Vertices: %d", (int)loadedModel.getNumVertices());
+		hud.addLinef("LOD: %d/%d (%d tris)", currentLod, (int)modelLods.size() - 1,
+			(int)(getRenderMesh().getNumIndices() / 3));
+		hud.addLinef("Objects: %d (1 draw call)", (int)modelSubmeshes.size());
+		if (isGalleryActive()) {
+			hud.addLinef("Gallery: %d/%d visible, update %.2f ms (1 instanced draw)",
+				(int)instanceField.getVisibleCount(), (int)instanceField.getCount(), instanceUpdateMs);
+		}
+		hud.addLinef("File: %s", currentModelPath.c_str());
 	} else {
-		info += "BASIC\n";
+		hud.addLine("Model: NONE");
 	}
-	info += "Rotation: " + ofToString(currentRotationY, 1) + " deg\n\n";
-
-	info += "Controls:\n";
-	info += "G: Toggle GUI\n";
-	info += "F: Toggle Fullscreen\n";
-	info += "R: Reset Parameters\n";
-	info += "Drag & Drop: Load Model\n";
-
-	return info;
+	hud.addLine(modelShader.isLoaded() ? "Shader: LOADED" : "Shader: BASIC");
+	hud.addLinef("Rotation: %.1f deg", currentRotationY);
+	hud.addText(governor.getStatus());
+	hud.addLine("");
+	hud.addText(profiler.getReport());
+	hud.addLine("");
+	hud.addLine(guiCache.getStatus());
+
+	hud.addLine("Controls:");
+	hud.addLine("G: Toggle GUI");
+	hud.addLine("F: Toggle Fullscreen");
+	hud.addLine("R: Reset Parameters");
+	hud.addLine("P: Capture Position Target");
+	hud.addLine("C: Record Pass Timings (CSV)");
+	hud.addLine("T: Trace (start / dump last 10 s)");
+	hud.addLine("Drag & Drop: Load Model");
+
+	// Window size, at the bottom
+	hud.setColor(ofColor(255, 255, 0));
+	hud.moveTo(10, ofGetHeight() - 20);
+	hud.addLinef("Window: %dx%d | FBO: %dx%d | Pool: %d targets, %d MB", ofGetWidth(), ofGetHeight(),
+		getScaledSize(ofGetWidth()), getScaledSize(ofGetHeight()), RenderTargetPool::get().getTargetCount(),
+		(int)(RenderTargetPool::get().getAllocatedBytes() / (1024 * 1024)));
+	hud.end();
 }
 
 //--------------------------------------------------------------
@@ -424,9 +681,33 @@ void Screen1App::keyPressed(int key) {
 	case 'R':
 		resetAllParameters();
 		break;
+
+	case 'p':
+	case 'P':
+		capturePositionTarget();
+		break;
+
+	case 'c':
+	case 'C':
+		profiler.toggleRecording();
+		break;
+	case 't':
+	case 'T':
+		Trace::toggle(10.0);
+		break;
 	}
 }
 
+//--------------------------------------------------------------
+void Screen1App::capturePositionTarget() {
+	if (positionEncoding == POSITION_DEPTH_ONLY) {
+		ofLogWarning("Screen1App") << "Depth-only encoding has no position color target to capture";
+		return;
+	}
+	string path = "debug_screen1_position_" + ofGetTimestampString() + ".exr";
+	readback.requestSaveFloat(positionFBO.getTexture(0), path);
+}
+
 //--------------------------------------------------------------
 void Screen1App::dragEvent(ofDragInfo dragInfo) {
 	if (dragInfo.files.size() > 0) {
@@ -434,7 +715,7 @@ void Screen1App::dragEvent(ofDragInfo dragInfo) {
 		string extension = ofToLower(ofFilePath::getFileExt(filepath));
 
 		// ļչ
-		if (extension == "obj" || extension == "ply" || extension == "3ds" || extension == "dae" || extension == "fbx") {
+		if (modelLoader.isSupportedFormat(filepath)) {
 			loadModelFromFile(filepath);
 		} else {
 			ofLogWarning("Screen1App") << "Unsupported file format: " << extension;
@@ -455,6 +736,7 @@ void Screen1App::resetAllParameters() {
 	guiRotationSpeed = rotationSpeed;
 	guiModelScale = 1.0f;
 	guiLightIntensity = lightingParams.lightIntensity;
+	guiAutoLod = true;
 
 	ofLogNotice() << "Reset all parameters to default";
 }
@@ -470,139 +752,63 @@ void Screen1App::logSystemInfo() {
 		ofLogNotice("Screen1App") << "Vertices: " << loadedModel.getNumVertices();
 	}
 }
+//--------------------------------------------------------------
 void Screen1App::setupPositionRendering() {
-	// λȾFBO - ʹ32λʽ洢ȷλ
-	ofFboSettings fboSettings;
-	fboSettings.width = ofGetWidth();
-	fboSettings.height = ofGetHeight();
-	fboSettings.internalformat = GL_RGBA32F; // RGBA32Fʽ洢
-	fboSettings.useDepth = true;
-	fboSettings.depthStencilAsTexture = true; // Ϊ
-
-	positionFBO.allocate(fboSettings);
-
-	// ɫļǷ
-	string vertPath = "shaders/screen1/position.vert";
-	string fragPath = "shaders/screen1/position.frag";
+	positionEncoding = dataManager.getPositionEncoding();
+	allocatePositionFBO(ofGetWidth(), ofGetHeight());
 
-	ofLogNotice("Screen1App") << "Checking position shader files:";
-	ofLogNotice("Screen1App") << "Vert exists: " << ofFile::doesFileExist(vertPath);
-	ofLogNotice("Screen1App") << "Frag exists: " << ofFile::doesFileExist(fragPath);
-
-	if (!positionRenderShader.load("shaders/screen1/position")) {
+	if (!positionRenderShader.load("shaders/screen1/position.vert", "shaders/common/positionTarget.frag")) {
 		ofLogError("Screen1App") << "Failed to load position render shader!";
-
-		// ϸĴϢ
-		ofLogError("Screen1App") << "Vertex shader error: " << positionRenderShader.getShaderSource(GL_VERTEX_SHADER);
-		ofLogError("Screen1App") << "Fragment shader error: " << positionRenderShader.getShaderSource(GL_FRAGMENT_SHADER);
 	} else {
 		ofLogNotice("Screen1App") << "Position render shader loaded successfully";
 	}
+}
 
+//--------------------------------------------------------------
+void Screen1App::allocatePositionFBO(int w, int h) {
+	// Read by the Screen3 screen-space fusion in the encoding it asked for
+	PositionTargets::allocate(positionFBO, getScaledSize(w), getScaledSize(h), positionEncoding);
 }
 
+//--------------------------------------------------------------
 void Screen1App::renderToPositionTexture() {
-	if (!isModelLoaded) {
-		ofLogWarning("Screen1App") << "Position render skipped - no model loaded";
-		return;
-	}
+	if (!isModelLoaded || !positionRenderShader.isLoaded()) return;
+	GL_THREAD_CHECK();
 
-	if (!positionRenderShader.isLoaded()) {
-		ofLogWarning("Screen1App") << "Position render skipped - shader not loaded";
-		return;
+	PositionEncoding encoding = dataManager.getPositionEncoding();
+	if (encoding != positionEncoding) {
+		positionEncoding = encoding;
+		allocatePositionFBO(ofGetWidth(), ofGetHeight());
 	}
 
-	ofLogNotice("Screen1App") << "Position render executing...";
-
-	//if (!isModelLoaded || !positionRenderShader.isLoaded()) return;
+	// Same transform as renderModel()
+	glm::mat4 modelMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(modelPosition));
+	modelMatrix = glm::rotate(modelMatrix, glm::radians(currentRotationY), glm::vec3(0.0f, 1.0f, 0.0f));
+	modelMatrix = glm::scale(modelMatrix, glm::vec3(modelScale.x, modelScale.y, modelScale.z));
 
 	positionFBO.begin();
-
+	PositionTargets::beginPass(positionFBO, positionEncoding);
 	ofClear(0, 0, 0, 0);
+	ofEnableDepthTest();
 
-	// ģ
-	static bool debugPrinted = false;
-	if (!debugPrinted) {
-		ofLogNotice("Screen1App") << "Model attributes:";
-		ofLogNotice("Screen1App") << "Has vertices: " << loadedModel.hasVertices();
-		ofLogNotice("Screen1App") << "Has normals: " << loadedModel.hasNormals();
-		ofLogNotice("Screen1App") << "Has texcoords: " << loadedModel.hasTexCoords();
-		ofLogNotice("Screen1App") << "Has colors: " << loadedModel.hasColors();
-		debugPrinted = true;
-	}
-
-	//cam.begin();
-
-	//positionRenderShader.begin();
-
-	//// shaderǷ
-	//GLint currentProgram;
-	//glGetIntegerv(GL_CURRENT_PROGRAM, &currentProgram);
-	//ofLogNotice("Screen1App") << "Active shader program ID: " << currentProgram;
-
-	//// 
-	//ofMatrix4x4 modelMatrix = getModelMatrix();
-	//ofMatrix4x4 viewMatrix = cam.getModelViewMatrix();
-	//ofMatrix4x4 projectionMatrix = cam.getProjectionMatrix();
-
-	//// ȷľϷʽ
-	//ofMatrix4x4 modelViewMatrix = viewMatrix * modelMatrix;
-	//ofMatrix4x4 modelViewProjectionMatrix = projectionMatrix * viewMatrix * modelMatrix;
-
-	//positionRenderShader.setUniformMatrix4f("modelMatrix", modelMatrix);
-	//positionRenderShader.setUniformMatrix4f("modelViewMatrix", modelViewMatrix);
-	//positionRenderShader.setUniformMatrix4f("modelViewProjectionMatrix", modelViewProjectionMatrix);
-
-	////// Ⱦģ
-	//loadedModel.draw();
+	cam.begin();
+	// As rendered, including the FBO flip, for depth reconstruction
+	glm::mat4 viewMatrix = ofGetCurrentViewMatrix();
+	glm::mat4 projectionMatrix = ofGetCurrentMatrix(OF_MATRIX_PROJECTION);
+
+	// Set explicitly: the GL 2.1 renderer does not upload OF's matrices
+	positionRenderShader.begin();
+	positionRenderShader.setUniformMatrix4f("modelMatrix", modelMatrix);
+	positionRenderShader.setUniformMatrix4f("modelViewMatrix", viewMatrix * modelMatrix);
+	positionRenderShader.setUniformMatrix4f("modelViewProjectionMatrix", projectionMatrix * viewMatrix * modelMatrix);
+	positionRenderShader.setUniform1i("positionEncoding", positionEncoding);
+	getRenderMesh().draw();
+	positionRenderShader.end();
 
-	//positionRenderShader.end();
-	//cam.end();
-	ofSetColor(0, 255, 0);
-	ofDrawCircle(100, 100, 50);
+	cam.end();
 
+	ofDisableDepthTest();
 	positionFBO.end();
 
-	// FBOݼ
-	static bool saved = false;
-	if (!saved) {
-		ofPixels pixels;
-		positionFBO.getTexture().readToPixels(pixels);
-		ofSaveImage(pixels, "debug_simple_circle.png");
-		saved = true;
-		ofLogNotice("Screen1App") << "Saved simple circle test";
-	}
-
-	// FBOݵļ
-	//static bool saved = false;
-	//if (!saved) {
-	//	positionFBO.getTexture().readToPixels(pixels);
-	//	ofSaveImage(pixels, "debug_screen1_position.png");
-	//	saved = true;
-	//	ofLogNotice("Screen1App") << "Saved position FBO to debug_screen1_position.png";
-	//}
-
-	//static int frameCount = 0;
-	//if (frameCount++ % 60 == 0) { // ÿ60֡һ
-	//	ofLogNotice("Screen1App") << "Position texture rendered - Model vertices: " << loadedModel.getNumVertices();
-	//}
-
-	//// FBO״̬
-	//ofTexture & fboTex = positionFBO.getTexture();
-	//ofLogNotice("Screen1App") << "FBO texture allocated: " << fboTex.isAllocated();
-	//ofLogNotice("Screen1App") << "FBO texture ID: " << fboTex.getTextureData().textureID;
-	//ofLogNotice("Screen1App") << "FBO texture size: " << fboTex.getWidth() << "x" << fboTex.getHeight();
-
-	//// DataManager
-	//dataManager.setScreen1PositionTexture(
-	//	positionFBO.getTexture(),
-	//	positionFBO.getDepthTexture());
-
-
-	//static bool debugPrinted = false;
-	//if (!debugPrinted) {
-	//	ofLogNotice("Screen1App") << "Position rendering setup - Shader loaded: " << positionRenderShader.isLoaded();
-	//	ofLogNotice("Screen1App") << "Position rendering setup - Model loaded: " << isModelLoaded;
-	//	debugPrinted = true;
-	//}
+	dataManager.setScreen1PositionTarget(PositionTargets::describe(positionFBO, positionEncoding, viewMatrix, projectionMatrix));
 }
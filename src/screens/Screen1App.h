@@ -1,28 +1,46 @@
 #pragma once
 #include "core/DataManager.h"
+#include "core/FrameGovernor.h"
+#include "core/FramePhases.h"
+#include "core/GpuMesh.h"
+#include "core/FrameProfiler.h"
+#include "core/GpuTimer.h"
+#include "core/ReadbackService.h"
+#include "core/RenderTargetPool.h"
+#include "geometry/InstanceField.h"
 #include "geometry/ModelLoader.h"
 #include "ofMain.h"
 #include "ofxGui.h"
 #include "shared/CommonStructs.h"
 #include "shared/GeometryData.h"
+#include "utils/GuiCache.h"
+#include "utils/HudText.h"
+#include "utils/TaskSystem.h"
 
-class Screen1App : public ofBaseApp {
+class Screen1App : public ofBaseApp, public PhasedScreen {
 public:
 	Screen1App();
-	~Screen1App() = default;
+	~Screen1App() { cleanupGallery(); }
 
 	void setup() override;
+	// GUI sync, animation, LOD choice and mesh publishing; no GL
+	void updateCpu(const CpuFrame & frame) override;
+	// GL phase: quality changes, resize, gallery upload and the position pass
 	void update() override;
 	void draw() override;
 	void keyPressed(int key) override;
 	void dragEvent(ofDragInfo dragInfo) override;
 	ofFbo & getPositionFBO() { return positionFBO; }
 
+	// For the benchmark runner: scripted parameter changes and pass timings
+	ofParameterGroup & getParameters() { return gui.getParameter().castGroup(); }
+	FrameProfiler & getProfiler() { return profiler; }
+
 private:
 	// ===  ===
 	ModelLoader modelLoader;
 	ofEasyCam cam;
-	ofFbo fbo;
+	ResizeDebouncer resizeDebouncer;
 	ofShader modelShader;
 	DataManager & dataManager;
 
@@ -31,6 +49,18 @@ private:
 	bool isModelLoaded = false;
 	string currentModelPath = "";
 
+	// LOD chain of loadedModel, modelLods[0] is full detail
+	vector<MeshLod> modelLods;
+	int currentLod = 0;
+	// What is drawn: GPU copies of a LOD chain, uploaded off the render
+	// thread and swapped in all at once, so the previous model stays on
+	// screen until the new one is resident
+	vector<std::shared_ptr<GpuMesh>> renderLods;
+	unsigned int lodUploadId = 0;
+	float modelRadius = 0.0f; // bounding radius in model space
+	// Objects of loadedModel; they share its buffers and draw together
+	vector<SubmeshRange> modelSubmeshes;
+
 	// ===  ===
 	float elapsedTime = 0.0f;
 	float rotationSpeed = 30.0f;
@@ -43,30 +73,57 @@ private:
 
 	// === GUI ===
 	ofxPanel gui;
+	GuiCache guiCache;
+	HudText hud;
 	bool showGui = true;
 
 	ofParameter<bool> guiAutoRotation;
 	ofParameter<float> guiRotationSpeed;
 	ofParameter<float> guiModelScale;
 	ofParameter<float> guiLightIntensity;
+	ofParameter<bool> guiAutoLod;
+	ofParameter<bool> guiGalleryMode;
+	ofParameter<int> guiGalleryCount;
+	ofParameter<float> guiGallerySpacing;
+
+	// Gallery mode: a field of model copies drawn with one instanced call,
+	// per-instance data streamed through a texture buffer every frame
+	InstanceField instanceField;
+	ofShader instancedShader;
+	GLuint instanceBuffer = 0;
+	GLuint instanceTexture = 0;
+	float instanceUpdateMs = 0.0f;
+	// instanceField.update() in flight between update() and draw()
+	TaskSystem::Handle galleryTask;
 
 	// ===  ===
 	void setupCamera();
 	void setupShaders();
-	void setupFBO();
 	void setupDefaultParams();
 	void setupGui();
 	void updateFromGui();
-	void updateRotation();
+	void updateRotation(float deltaTime);
+	// CPU phase; viewportHeight comes from the CpuFrame
+	void updateLodSelection(int viewportHeight);
+	const GpuMesh & getRenderMesh() const;
+	void setModelLods(const vector<MeshLod> & lods);
 	void handleWindowResize(int w, int h);
 
-	void renderToFBO();
+	void renderToFBO(RenderTargetPool::Target & target);
 	void renderModel();
+	void renderHero();
 	void renderUI();
 
+	void setupGallery();
+	void updateGallery();
+	void uploadGallery();
+	void renderGallery();
+	void cleanupGallery();
+	bool isGalleryActive() const;
+
 	void setShaderUniforms();
 	void setBasicUniforms();
-	void setLightingUniforms();
+	void setLightingUniforms(ofShader & shader);
 	void setMatrixUniforms();
 
 	void loadDefaultModel();
@@ -76,7 +133,7 @@ private:
 	ofVec3f calculateLightPosition();
 	void resetAllParameters();
 	void logSystemInfo();
-	string getDebugInfo();
+	void updateHud();
 
 	ofMatrix4x4 getModelMatrix() const;
 	float getRotationAngle() const { return currentRotationY; }
@@ -84,9 +141,25 @@ private:
 	// === λȾ ===
 	ofFbo positionFBO;
 	ofShader positionRenderShader;
+	PositionEncoding positionEncoding = POSITION_VIEW_RGBA16F;
+
+	// Non-blocking GPU readback for debug captures
+	ReadbackService readback;
+	void capturePositionTarget();
 
 	void setupPositionRendering();
+	void allocatePositionFBO(int w, int h);
 	void renderToPositionTexture();
 
-	ofPixels pixels;
+	// === Adaptive quality ===
+	// The governor picks the render scale of the pooled target / positionFBO and the LOD budget
+	FrameGovernor governor { "Screen1" };
+	GpuTimer gpuTimer;
+	FrameProfiler profiler { "Screen1" };
+	float renderScale = 1.0f;
+	ofParameter<bool> guiAdaptiveQuality;
+	ofParameter<float> guiFrameBudget;
+
+	void applyQualityLevel();
+	int getScaledSize(int size) const;
 };
@@ -1,4 +1,8 @@
 #include "Screen2App.h"
+#include "utils/GlThread.h"
+#include "utils/HotLog.h"
+#include "utils/PositionTargets.h"
+#include "utils/Trace.h"
 
 Screen2App::Screen2App()
 	: dataManager(DataManager::getInstance()) {
@@ -10,7 +14,6 @@ void Screen2App::setup() {
 
 	setupCamera();
 	setupShaders();
-	setupFBO();
 	setupDefaultParams();
 	setupMesh();
 	setupGui();
@@ -34,11 +37,6 @@ void Screen2App::setupShaders() {
 	}
 }
 
-//--------------------------------------------------------------
-void Screen2App::setupFBO() {
-	fbo.allocate(ofGetWidth(), ofGetHeight(), GL_RGBA);
-}
-
 //--------------------------------------------------------------
 void Screen2App::setupDefaultParams() {
 	// ʼĬ
@@ -104,6 +102,12 @@ void Screen2App::setupGui() {
 	gui.add(fractureGroup);
 	gui.add(dissipationGroup);
 	gui.add(lightingGroup);
+
+	performanceGroup.setName("Performance");
+	performanceGroup.add(guiAdaptiveQuality.set("Adaptive Quality", true));
+	performanceGroup.add(guiFrameBudget.set("Frame Budget (ms)", 16.6f, 8.0f, 50.0f));
+	gui.add(performanceGroup);
+	guiCache.setup(gui, "Screen2");
 }
 
 //--------------------------------------------------------------
@@ -126,6 +130,7 @@ void Screen2App::updateFromGui() {
 
 	if (needRegenerateMesh) {
 		cubeMesh.updateConfig(meshConfig);
+		cubeMeshRevision++;
 	}
 
 	// ͬ
@@ -153,19 +158,12 @@ void Screen2App::updateFromGui() {
 }
 
 //--------------------------------------------------------------
-void Screen2App::update() {
-	elapsedTime = ofGetElapsedTimef();
-	dataManager.setElapsedTime(elapsedTime);
-
-	// ⴰڴС仯
-	static int lastWidth = ofGetWidth();
-	static int lastHeight = ofGetHeight();
+void Screen2App::updateCpu(const CpuFrame & frame) {
+	TRACE_SCOPE("Screen2", "updateCpu");
+	governor.beginCpu();
 
-	if (lastWidth != ofGetWidth() || lastHeight != ofGetHeight()) {
-		handleWindowResize(ofGetWidth(), ofGetHeight());
-		lastWidth = ofGetWidth();
-		lastHeight = ofGetHeight();
-	}
+	elapsedTime = frame.time;
+	dataManager.setElapsedTime(elapsedTime);
 
 	// cubeSize̬ĵλ
 	float scaleFactor = meshConfig.cubeSize / 200.0f; // 200.0fĬcubeSize
@@ -182,8 +180,6 @@ void Screen2App::update() {
 	// GUI²
 	updateFromGui();
 
-	renderToPositionTexture();
-
 	// === ؼScreen2ĲʵʱDataManager ===
 	dataManager.setCubeMeshConfig(meshConfig);
 	dataManager.setFractureParams(fractureParams);
@@ -191,56 +187,113 @@ void Screen2App::update() {
 	dataManager.setLightingParams(lightingParams);
 	dataManager.setFlowFieldConfig(flowFieldConfig);
 
-	// Share mesh data with DataManager for Screen3
-	dataManager.setScreen2BaseMesh(cubeMesh.getMesh());
+	// Share mesh data with DataManager for Screen3, once per regeneration.
+	// Only the vertex data goes out: this runs on a worker, and a copy of the
+	// ofVboMesh would share its GL buffers
+	if (dataManager.isChannelWanted(CHANNEL_SCREEN2_MESH) && sharedCubeMeshRevision != cubeMeshRevision) {
+		dataManager.setScreen2BaseMesh(cubeMesh.getMesh());
+		sharedCubeMeshRevision = cubeMeshRevision;
 
-	// Add debug output to verify sharing
-	static int frameCount = 0;
-	if (frameCount++ % 120 == 0) { // Every 2 seconds
-		ofLogNotice("Screen2App") << "Sharing mesh with " << cubeMesh.getMesh().getNumVertices() << " vertices";
+		HOT_LOG_NOTICE("Screen2App", 2.0f, "Sharing mesh with %d vertices", (int)cubeMesh.getMesh().getNumVertices());
 	}
+
+	governor.endCpu();
 }
 
 //--------------------------------------------------------------
-void Screen2App::handleWindowResize(int w, int h) {
-	if (fbo.isAllocated()) {
-		fbo.clear();
+void Screen2App::update() {
+	TRACE_SCOPE("Screen2", "update");
+	GL_THREAD_CHECK();
+	profiler.beginFrame();
+
+	// Adapt quality to the previous frame's timings before any GL work
+	governor.setEnabled(guiAdaptiveQuality);
+	governor.setBudgetMs(guiFrameBudget);
+	if (governor.update(gpuTimer.poll() ? gpuTimer.getLastMs() : -1.0f)) {
+		applyQualityLevel();
 	}
-	fbo.allocate(w, h, GL_RGBA);
+	gpuTimer.begin();
+	governor.beginCpu();
 
-	fbo.begin();
-	ofClear(20);
-	fbo.end();
+	// ⴰڴС仯
+	// The pooled target follows the window every frame; the position
+	// target is reallocated once the size has settled
+	cam.setAspectRatio((float)ofGetWidth() / (float)ofGetHeight());
+	if (resizeDebouncer.update(ofGetWidth(), ofGetHeight())) {
+		handleWindowResize(ofGetWidth(), ofGetHeight());
+	}
+
+	if (dataManager.isChannelWanted(CHANNEL_SCREEN2_POSITION)) {
+		profiler.begin("renderToPositionTexture");
+		renderToPositionTexture();
+		profiler.end("renderToPositionTexture");
+	}
+
+	governor.endCpu();
+}
+
+//--------------------------------------------------------------
+void Screen2App::applyQualityLevel() {
+	const FrameGovernor::Level & level = governor.getLevel();
+	if (level.renderScale != renderScale) {
+		renderScale = level.renderScale;
+		handleWindowResize(ofGetWidth(), ofGetHeight());
+	}
+	// Effect quality is read every frame by setEffectUniforms(). The grid
+	// resolution stays on the GUI value: changing it regenerates the cube and
+	// rebuilds Screen3's correspondence, a hitch worse than the one it saves
+}
 
-	cam.setAspectRatio((float)w / (float)h);
+//--------------------------------------------------------------
+int Screen2App::getScaledSize(int size) const {
+	return std::max(1, (int)std::round(size * renderScale));
+}
 
-	ofLogNotice("Screen2App") << "Window resized to: " << w << "x" << h;
+//--------------------------------------------------------------
+void Screen2App::handleWindowResize(int w, int h) {
+	allocatePositionFBO(w, h);
+
+	ofLogNotice("Screen2App") << "Window resized to: " << w << "x" << h << " (render scale " << renderScale << ")";
 }
 
 //--------------------------------------------------------------
 void Screen2App::draw() {
-	renderToFBO();
-	fbo.draw(0, 0);
+	TRACE_SCOPE("Screen2", "draw");
+	GL_THREAD_CHECK();
+	governor.beginCpu();
+
+	// Returned to the pool at the end of draw(), for the next screen
+	RenderTargetPool::Target target
+		= RenderTargetPool::get().acquire(getScaledSize(ofGetWidth()), getScaledSize(ofGetHeight()));
+	profiler.begin("renderToFBO");
+	renderToFBO(target);
+	profiler.end("renderToFBO");
+	target.draw(0, 0, ofGetWidth(), ofGetHeight());
 
 	if (showGui) {
-		gui.draw();
+		profiler.begin("gui.draw");
+		guiCache.draw();
+		profiler.end("gui.draw");
 	}
 
 	if (!showGui) {
 		renderUI();
 	}
+
+	gpuTimer.end();
+	governor.endCpu();
 }
 
 //--------------------------------------------------------------
-void Screen2App::renderToFBO() {
-	fbo.begin();
+void Screen2App::renderToFBO(RenderTargetPool::Target & target) {
+	target.begin();
 	ofClear(20);
 
 	cam.begin();
 	renderGeometry();
 	cam.end();
 
-	fbo.end();
+	target.end();
 }
 
 //--------------------------------------------------------------
@@ -337,6 +390,7 @@ void Screen2App::setEffectUniforms() {
 	fractuteShader.setUniform1f("dissipationSpeed", dissipationParams.dissipationSpeed);
 	fractuteShader.setUniform1f("cloudThreshold", dissipationParams.cloudThreshold);
 	fractuteShader.setUniform1f("edgeSoftness", dissipationParams.edgeSoftness);
+	fractuteShader.setUniform1i("effectQuality", governor.getLevel().effectQuality);
 }
 
 //--------------------------------------------------------------
@@ -353,35 +407,45 @@ ofVec3f Screen2App::calculateLightPosition() {
 
 //--------------------------------------------------------------
 void Screen2App::renderUI() {
-	ofSetColor(255);
-	string info = getDebugInfo();
-	ofDrawBitmapString(info, 10, 20);
+	updateHud();
+	hud.draw();
 }
 
 //--------------------------------------------------------------
-string Screen2App::getDebugInfo() {
-	string info = "FPS: " + ofToString(ofGetFrameRate(), 0) + "\n";
-	info += "Vertices: " + ofToString(cubeMesh.getVertexCount()) + "\n";
-	info += "Shader: " + string(fractuteShader.isLoaded() ? "LOADED" : "FAILED") + "\n\n";
-
-	info += "=== CURRENT EFFECTS ===\n";
-	info += "Dissipation: " + string(dissipationParams.enableDissipation ? "ON" : "OFF");
+void Screen2App::updateHud() {
+	hud.begin(10, 20);
+	hud.addLinef("FPS: %.0f", ofGetFrameRate());
+	hud.addLinef("Vertices: %d", cubeMesh.getVertexCount());
+	hud.addLine(fractuteShader.isLoaded() ? "Shader: LOADED" : "Shader: FAILED");
+	hud.addLine("");
+
+	hud.addLine("=== CURRENT EFFECTS ===");
 	if (dissipationParams.enableDissipation) {
-		info += " (" + ofToString(dissipationParams.dissipationAmount, 2) + ")";
+		hud.addLinef("Dissipation: ON (%.2f)", dissipationParams.dissipationAmount);
+	} else {
+		hud.addLine("Dissipation: OFF");
 	}
-	info += "\n";
-
-	info += "Fracture: " + string(fractureParams.enableFracture ? "ON" : "OFF");
 	if (fractureParams.enableFracture) {
-		info += " (" + ofToString(fractureParams.fractureAmount, 2) + ")";
+		hud.addLinef("Fracture: ON (%.2f)", fractureParams.fractureAmount);
+	} else {
+		hud.addLine("Fracture: OFF");
 	}
-	info += "\n\n";
-
-	info += "Controls:\n";
-	info += "G: Toggle GUI\n";
-	info += "R: Reset Parameters\n";
-
-	return info;
+	hud.addLinef("Grid: %d | FBO: %dx%d", meshConfig.gridResolution, getScaledSize(ofGetWidth()),
+		getScaledSize(ofGetHeight()));
+	hud.addLinef("Render targets: %d, %d MB", RenderTargetPool::get().getTargetCount(),
+		(int)(RenderTargetPool::get().getAllocatedBytes() / (1024 * 1024)));
+	hud.addText(governor.getStatus());
+	hud.addLine("");
+	hud.addText(profiler.getReport());
+	hud.addLine("");
+	hud.addLine(guiCache.getStatus());
+
+	hud.addLine("Controls:");
+	hud.addLine("G: Toggle GUI");
+	hud.addLine("R: Reset Parameters");
+	hud.addLine("C: Record Pass Timings (CSV)");
+	hud.addLine("T: Trace (start / dump last 10 s)");
+	hud.end();
 }
 
 //--------------------------------------------------------------
@@ -397,6 +461,15 @@ void Screen2App::keyPressed(int key) {
 	case 'R':
 		resetAllParameters();
 		break;
+
+	case 'c':
+	case 'C':
+		profiler.toggleRecording();
+		break;
+	case 't':
+	case 'T':
+		Trace::toggle(10.0);
+		break;
 	}
 }
 
@@ -446,41 +519,51 @@ void Screen2App::logSystemInfo() {
 	cubeMesh.logMeshInfo();
 }
 void Screen2App::setupPositionRendering() {
-	// λȾFBO
-	ofFboSettings fboSettings;
-	fboSettings.width = ofGetWidth();
-	fboSettings.height = ofGetHeight();
-	fboSettings.internalformat = GL_RGBA32F; // 32λ㾫
-	fboSettings.useDepth = true;
-	fboSettings.depthStencilAsTexture = true;
-
-	positionFBO.allocate(fboSettings);
-
-	// λȾshaderüα߼
-	if (!positionRenderShader.load("shaders/screen2/position")) {
+	positionEncoding = dataManager.getPositionEncoding();
+	allocatePositionFBO(ofGetWidth(), ofGetHeight());
+
+	if (!positionRenderShader.load("shaders/screen2/position.vert", "shaders/common/positionTarget.frag")) {
 		ofLogError("Screen2App") << "Failed to load position render shader!";
 	} else {
 		ofLogNotice("Screen2App") << "Position render shader loaded successfully";
 	}
 }
 
+//--------------------------------------------------------------
+void Screen2App::allocatePositionFBO(int w, int h) {
+	// Read by the Screen3 screen-space fusion in the encoding it asked for
+	PositionTargets::allocate(positionFBO, getScaledSize(w), getScaledSize(h), positionEncoding);
+}
+
+//--------------------------------------------------------------
 void Screen2App::renderToPositionTexture() {
 	if (!positionRenderShader.isLoaded()) return;
+	GL_THREAD_CHECK();
+
+	PositionEncoding encoding = dataManager.getPositionEncoding();
+	if (encoding != positionEncoding) {
+		positionEncoding = encoding;
+		allocatePositionFBO(ofGetWidth(), ofGetHeight());
+	}
 
 	positionFBO.begin();
+	PositionTargets::beginPass(positionFBO, positionEncoding);
 	ofClear(0, 0, 0, 0); // ͸
+	ofEnableDepthTest();
 
 	cam.begin();
+	// As rendered, including the FBO flip, for depth reconstruction
+	glm::mat4 viewMatrix = ofGetCurrentViewMatrix();
+	glm::mat4 projectionMatrix = ofGetCurrentMatrix(OF_MATRIX_PROJECTION);
 	positionRenderShader.begin();
+	positionRenderShader.setUniform1i("positionEncoding", positionEncoding);
 
 	// û
-	ofMatrix4x4 modelMatrix; // λ
-	ofMatrix4x4 modelViewMatrix = cam.getModelViewMatrix();
-	ofMatrix4x4 modelViewProjectionMatrix = cam.getModelViewProjectionMatrix();
-
-	positionRenderShader.setUniformMatrix4f("modelMatrix", modelMatrix);
-	positionRenderShader.setUniformMatrix4f("modelViewMatrix", modelViewMatrix);
-	positionRenderShader.setUniformMatrix4f("modelViewProjectionMatrix", modelViewProjectionMatrix);
+	// Set explicitly, since the GL 2.1 renderer does not upload OF's matrices;
+	// taken from OF's stack so the raster has the same flip as the recorded ones
+	positionRenderShader.setUniformMatrix4f("modelMatrix", glm::mat4(1.0f));
+	positionRenderShader.setUniformMatrix4f("modelViewMatrix", viewMatrix);
+	positionRenderShader.setUniformMatrix4f("modelViewProjectionMatrix", projectionMatrix * viewMatrix);
 
 	// üαβ
 	positionRenderShader.setUniform1f("time", elapsedTime);
@@ -519,5 +602,8 @@ void Screen2App::renderToPositionTexture() {
 
 	positionRenderShader.end();
 	cam.end();
+	ofDisableDepthTest();
 	positionFBO.end();
+
+	dataManager.setScreen2PositionTarget(PositionTargets::describe(positionFBO, positionEncoding, viewMatrix, projectionMatrix));
 }
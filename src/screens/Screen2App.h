@@ -1,27 +1,44 @@
 #pragma once
 #include "core/DataManager.h"
+#include "core/FrameGovernor.h"
+#include "core/FramePhases.h"
+#include "core/FrameProfiler.h"
+#include "core/GpuTimer.h"
+#include "core/RenderTargetPool.h"
 #include "geometry/CubeMesh.h"
 #include "ofMain.h"
 #include "ofxGui.h"
 #include "shared/CommonStructs.h"
 #include "shared/GeometryData.h"
+#include "utils/GuiCache.h"
+#include "utils/HudText.h"
 
-class Screen2App : public ofBaseApp {
+class Screen2App : public ofBaseApp, public PhasedScreen {
 public:
 	Screen2App();
 	~Screen2App() = default;
 
 	void setup() override;
+	// GUI sync, cube regeneration and parameter / mesh publishing; no GL
+	void updateCpu(const CpuFrame & frame) override;
+	// GL phase: quality changes, resize and the position pass
 	void update() override;
 	void draw() override;
 	void keyPressed(int key) override;
 	ofFbo & getPositionFBO() { return positionFBO; }
 
+	// For the benchmark runner: scripted parameter changes and pass timings
+	ofParameterGroup & getParameters() { return gui.getParameter().castGroup(); }
+	FrameProfiler & getProfiler() { return profiler; }
+
 private:
 	// ===  ===
 	CubeMesh cubeMesh;
+	// Bumped on every regeneration; the mesh is shared once per revision
+	unsigned int cubeMeshRevision = 1;
+	unsigned int sharedCubeMeshRevision = 0;
 	ofEasyCam cam;
-	ofFbo fbo;
+	ResizeDebouncer resizeDebouncer;
 	ofShader fractuteShader;
 	DataManager & dataManager;
 
@@ -37,6 +54,8 @@ private:
 
 	// === GUI ===
 	ofxPanel gui;
+	GuiCache guiCache;
+	HudText hud;
 	bool showGui = true;
 
 	// GUI
@@ -83,7 +102,6 @@ private:
 	// === ʼ ===
 	void setupCamera();
 	void setupShaders();
-	void setupFBO();
 	void setupDefaultParams();
 	void setupMesh();
 	void setupGui();
@@ -93,7 +111,7 @@ private:
 	void handleWindowResize(int w, int h);
 
 	// === Ⱦ ===
-	void renderToFBO();
+	void renderToFBO(RenderTargetPool::Target & target);
 	void renderGeometry();
 	void renderUI();
 
@@ -108,12 +126,28 @@ private:
 	ofVec3f calculateLightPosition();
 	void resetAllParameters();
 	void logSystemInfo();
-	string getDebugInfo();
+	void updateHud();
 
 	// === λȾ ===
 	ofFbo positionFBO;
 	ofShader positionRenderShader;
+	PositionEncoding positionEncoding = POSITION_VIEW_RGBA16F;
 
 	void setupPositionRendering();
+	void allocatePositionFBO(int w, int h);
 	void renderToPositionTexture();
+
+	// === Adaptive quality ===
+	// The governor picks the render scale of the pooled target / positionFBO
+	// and the dissipation shader variant
+	FrameGovernor governor { "Screen2" };
+	GpuTimer gpuTimer;
+	FrameProfiler profiler { "Screen2" };
+	float renderScale = 1.0f;
+	ofParameterGroup performanceGroup;
+	ofParameter<bool> guiAdaptiveQuality;
+	ofParameter<float> guiFrameBudget;
+
+	void applyQualityLevel();
+	int getScaledSize(int size) const;
 };
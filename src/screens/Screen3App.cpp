@@ -1,4 +1,14 @@
 #include "Screen3App.h"
+#include "core/AppClock.h"
+#include "core/RenderTargetPool.h"
+#include "core/UploadService.h"
+#include "utils/GlThread.h"
+#include "utils/PositionTargets.h"
+#include "utils/Trace.h"
+
+// SDF volume resolution and how many z-slices of it are baked per frame
+static const int kSdfResolution = 128;
+static const int kSdfSlicesPerFrame = 4;
 
 Screen3App::Screen3App()
 	: dataManager(DataManager::getInstance())
@@ -9,13 +19,19 @@ Screen3App::Screen3App()
 	, screen1PositionTexture(0) {
 }
 
+//--------------------------------------------------------------
+Screen3App::~Screen3App() {
+	// The correspondence task writes into this
+	if (correspondenceTask.isValid()) TaskSystem::get().wait(correspondenceTask);
+	cleanupTBO();
+}
+
 //--------------------------------------------------------------
 void Screen3App::setup() {
 	ofLogNotice("Screen3App") << "Initializing TBO-based mesh fusion...";
 
 	setupCamera();
 	setupShader();
-	setupFBO();
 	setupGui();
 	setupTBO();
 
@@ -39,14 +55,22 @@ void Screen3App::setupShader() {
 	} else {
 		ofLogNotice("Screen3App") << "Fusion shader loaded successfully";
 	}
-}
 
-//--------------------------------------------------------------
-void Screen3App::setupFBO() {
-	finalFBO.allocate(ofGetWidth(), ofGetHeight(), GL_RGBA);
-	finalFBO.begin();
-	ofClear(20, 20, 20, 255);
-	finalFBO.end();
+	if (!screenSpaceShader.load("shaders/screen3/screenSpaceMix")
+		|| !depthUpsampleShader.load("shaders/screen3/screenSpaceMix.vert", "shaders/screen3/depthUpsample.frag")) {
+		ofLogError("Screen3App") << "Failed to load screen-space fusion shaders!";
+	}
+
+	// Clip-space quad; screenSpaceMix.vert passes positions straight through
+	fullscreenQuad.setMode(OF_PRIMITIVE_TRIANGLE_FAN);
+	fullscreenQuad.addVertex(glm::vec3(-1.0f, -1.0f, 0.0f));
+	fullscreenQuad.addTexCoord(glm::vec2(0.0f, 0.0f));
+	fullscreenQuad.addVertex(glm::vec3(1.0f, -1.0f, 0.0f));
+	fullscreenQuad.addTexCoord(glm::vec2(1.0f, 0.0f));
+	fullscreenQuad.addVertex(glm::vec3(1.0f, 1.0f, 0.0f));
+	fullscreenQuad.addTexCoord(glm::vec2(1.0f, 1.0f));
+	fullscreenQuad.addVertex(glm::vec3(-1.0f, 1.0f, 0.0f));
+	fullscreenQuad.addTexCoord(glm::vec2(0.0f, 1.0f));
 }
 
 //--------------------------------------------------------------
@@ -57,24 +81,71 @@ void Screen3App::setupGui() {
 	mixRatio.set("Mix Ratio (Screen2->Screen1)", 0.5f, 0.0f, 1.0f);
 	enableFusion.set("Enable Fusion", true);
 	showDebugInfo.set("Show Debug Info", false);
+	matchCubeLod.set("Match Cube LOD", true);
+	useCorrespondence.set("Use Correspondence Map", true);
+	correspondenceMode.set("Map Mode (0=closest 1=ray)", FusionCorrespondence::RAY_FROM_CENTER, 0, 1);
+	fusionMode.set("Fusion Mode (0=vertex 1=SDF 2=screen)", FUSION_VERTEX, FUSION_VERTEX, FUSION_SCREEN_SPACE);
+	sdfSteps.set("SDF Projection Steps", 4, 1, 16);
+	screenSpaceScale.set("Screen-Space Resolution", 0.5f, 0.25f, 1.0f);
+	positionEncoding.set("Position Encoding (0=world32F 1=view16F 2=depth)", POSITION_VIEW_RGBA16F, POSITION_WORLD_RGBA32F, POSITION_DEPTH_ONLY);
 
 	gui.add(mixRatio);
 	gui.add(enableFusion);
 	gui.add(showDebugInfo);
+	gui.add(matchCubeLod);
+	gui.add(useCorrespondence);
+	gui.add(correspondenceMode);
+	gui.add(fusionMode);
+	gui.add(sdfSteps);
+	gui.add(screenSpaceScale);
+	gui.add(positionEncoding);
+	guiCache.setup(gui, "Screen3");
 }
 
 //--------------------------------------------------------------
 void Screen3App::setupTBO() {
-	// Initialize TBO objects
-	glGenBuffers(1, &screen1PositionTBO);
+	// Buffer textures only; the buffers behind them and the SDF texture come
+	// from UploadService
 	glGenTextures(1, &screen1PositionTexture);
+	glGenTextures(2, correspondenceTextures);
 
-	ofLogNotice("Screen3App") << "TBO objects created: Buffer=" << screen1PositionTBO
-							  << " Texture=" << screen1PositionTexture;
+	ofLogNotice("Screen3App") << "TBO objects created: Texture=" << screen1PositionTexture;
+}
+
+//--------------------------------------------------------------
+void Screen3App::updateCpu(const CpuFrame & frame) {
+	TRACE_SCOPE("Screen3", "updateCpu");
+
+	// Screen1/Screen2 pick this up before their next position pass
+	dataManager.setPositionEncoding((PositionEncoding)positionEncoding.get());
+
+	// Screen-space fusion only reads the other screens' position targets
+	if (fusionMode == FUSION_SCREEN_SPACE) return;
+
+	// Update driving mesh from Screen2
+	updateDrivingMesh();
+
+	if (useCorrespondence && hasDrivingMesh && dataManager.hasScreen1MeshData()) {
+		updateCorrespondence();
+	}
+
+	if (fusionMode == FUSION_SDF && dataManager.hasScreen1MeshData()) {
+		updateSdfVolume();
+	}
+
+	// Update Screen1 position data in TBO (only needed without the map or SDF)
+	if (dataManager.hasScreen1MeshData() && !(useCorrespondence && correspondenceReady) && !isSdfFusionActive()) {
+		updateScreen1TBO();
+	}
 }
 
 //--------------------------------------------------------------
 void Screen3App::update() {
+	TRACE_SCOPE("Screen3", "update");
+	GL_THREAD_CHECK();
+	profiler.beginFrame();
+	readback.update();
+
 	// Handle window resize
 	static int lastWidth = ofGetWidth();
 	static int lastHeight = ofGetHeight();
@@ -84,20 +155,332 @@ void Screen3App::update() {
 		lastHeight = ofGetHeight();
 	}
 
-	// Update driving mesh from Screen2
-	updateDrivingMesh();
+	// Whatever updateCpu() built this tick
+	if (drivingMeshVboRevision != drivingMeshRevision) {
+		drivingMeshVbo = ofVboMesh(drivingMesh);
+		drivingMeshVboRevision = drivingMeshRevision;
+	}
+	if (correspondenceUploadPending) uploadCorrespondence();
+	if (sdfUploadPending) uploadSdfVolume();
+	if (tboUploadPending) uploadScreen1TBO();
+}
 
-	// Update Screen1 position data in TBO
-	if (dataManager.hasScreen1MeshData()) {
-		updateScreen1TBO();
+//--------------------------------------------------------------
+void Screen3App::updateCorrespondence() {
+	// One build at a time; the current map stays in use until it is done
+	if (correspondenceTask.isValid()) {
+		if (!correspondenceTask.isDone()) return;
+		finishCorrespondence();
+	}
+
+	CubeMeshConfig cubeConfig = dataManager.getCubeMeshConfig();
+	unsigned int revision = dataManager.getScreen1ModelRevision();
+	int mode = correspondenceMode.get();
+
+	if (hasCorrespondence && revision == correspondenceRevision
+		&& cubeConfig.gridResolution == correspondenceGrid && cubeConfig.cubeSize == correspondenceCubeSize
+		&& mode == correspondenceBuiltMode && drivingMesh.getNumVertices() == correspondenceVertexCount) {
+		return;
+	}
+
+	// Remember what this build was for even if it fails, so it is not retried every frame
+	correspondenceRevision = revision;
+	correspondenceGrid = cubeConfig.gridResolution;
+	correspondenceCubeSize = cubeConfig.cubeSize;
+	correspondenceBuiltMode = mode;
+	correspondenceVertexCount = drivingMesh.getNumVertices();
+	hasCorrespondence = true;
+
+	// Everything the task reads is its own copy, or a BVH nothing rebuilds in place
+	vector<glm::vec3> cubeVertices = drivingMesh.getVertices();
+	std::shared_ptr<const MeshBVH> bvh = screen1BvhRevision == revision ? screen1Bvh : nullptr;
+	FusionCorrespondence::Mode mapMode = (FusionCorrespondence::Mode)mode;
+
+	correspondenceTask = TaskSystem::get().submitBackground([this, revision, bvh, mapMode, cubeVertices = std::move(cubeVertices)]() {
+		uint64_t startTime = ofGetElapsedTimeMicros();
+		CorrespondenceBuild & result = correspondenceBuild;
+		result = CorrespondenceBuild();
+		result.revision = revision;
+		ofMesh model = dataManager.getScreen1Mesh();
+		result.modelTriangles = model.getNumIndices() / 3;
+
+		// The cache is keyed on the model geometry and the cube layout
+		uint64_t key = FusionCorrespondence::computeKey(model.getVertices(), model.getIndices(), cubeVertices, mapMode);
+		string cacheDir = ofToDataPath("cache", true);
+		string cachePath = ofFilePath::join(cacheDir, "fusion_" + ofToHex(key) + ".bin");
+
+		result.fromCache = FusionCorrespondence::loadCache(cachePath, key, cubeVertices.size(), result.positions, result.normals);
+		if (!result.fromCache) {
+			std::shared_ptr<const MeshBVH> modelBvh = bvh;
+			if (!modelBvh) {
+				auto built = std::make_shared<MeshBVH>();
+				built->build(model.getVertices(), model.getIndices());
+				modelBvh = result.bvh = built;
+			}
+
+			FusionCorrespondence::Settings settings;
+			settings.mode = mapMode;
+			FusionCorrespondence::build(*modelBvh, model.getNormals(), cubeVertices, settings, result.positions, result.normals);
+
+			ofDirectory::createDirectory(cacheDir, false, true);
+			if (!FusionCorrespondence::saveCache(cachePath, key, result.positions, result.normals)) {
+				ofLogWarning("Screen3App") << "Could not write correspondence cache: " << cachePath;
+			}
+		}
+		result.buildMs = (ofGetElapsedTimeMicros() - startTime) / 1000.0f;
+	});
+}
+
+//--------------------------------------------------------------
+void Screen3App::finishCorrespondence() {
+	correspondenceTask = TaskSystem::Handle();
+	CorrespondenceBuild & result = correspondenceBuild;
+
+	// Saves the SDF bake a BVH build of its own
+	if (result.bvh && screen1BvhRevision != result.revision) {
+		screen1Bvh = std::move(result.bvh);
+		screen1BvhRevision = result.revision;
+	}
+	result.bvh.reset();
+
+	correspondenceFromCache = result.fromCache;
+	correspondenceBuildMs = result.buildMs;
+	pendingCorrespondence[0] = std::move(result.positions);
+	pendingCorrespondence[1] = std::move(result.normals);
+	correspondenceUploadPending = true;
+
+	ofLogNotice("Screen3App") << "Correspondence map " << (correspondenceFromCache ? "loaded from cache" : "built")
+							  << " in " << correspondenceBuildMs << " ms: " << pendingCorrespondence[0].size()
+							  << " cube vertices -> " << result.modelTriangles << " model triangles";
+}
+
+//--------------------------------------------------------------
+void Screen3App::uploadCorrespondence() {
+	GL_THREAD_CHECK();
+	correspondenceUploadPending = false;
+
+	// A newer build supersedes any halves of an older one still in flight
+	unsigned int id = ++correspondenceUploadId;
+	for (int i = 0; i < 2; i++) {
+		if (incomingCorrespondence[i]) glDeleteBuffers(1, &incomingCorrespondence[i]);
+		incomingCorrespondence[i] = 0;
+	}
+
+	const char * names[2] = { "correspondencePositions", "correspondenceNormals" };
+	for (int i = 0; i < 2; i++) {
+		UploadService::get().uploadBuffer(names[i], std::move(pendingCorrespondence[i]), [this, id, i](GLuint buffer) {
+			if (id != correspondenceUploadId) {
+				glDeleteBuffers(1, &buffer);
+				return;
+			}
+			incomingCorrespondence[i] = buffer;
+			if (incomingCorrespondence[0] && incomingCorrespondence[1]) swapInCorrespondence();
+		});
+		pendingCorrespondence[i].clear();
+	}
+}
+
+//--------------------------------------------------------------
+void Screen3App::swapInCorrespondence() {
+	// Both halves at once, so positions and normals always match
+	for (int i = 0; i < 2; i++) {
+		if (correspondenceBuffers[i]) glDeleteBuffers(1, &correspondenceBuffers[i]);
+		correspondenceBuffers[i] = incomingCorrespondence[i];
+		incomingCorrespondence[i] = 0;
+
+		glBindTexture(GL_TEXTURE_BUFFER, correspondenceTextures[i]);
+		glTexBuffer(GL_TEXTURE_BUFFER, GL_RGB32F, correspondenceBuffers[i]);
+	}
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+	correspondenceReady = true;
+}
+
+//--------------------------------------------------------------
+void Screen3App::updateScreen1Bvh(const ofMesh & model, unsigned int revision) {
+	// Shared by the correspondence map and the SDF bake
+	if (screen1Bvh && screen1BvhRevision == revision) return;
+
+	// A new one rather than a rebuild, since a correspondence task may be reading the old one
+	uint64_t startTime = ofGetElapsedTimeMicros();
+	auto bvh = std::make_shared<MeshBVH>();
+	bvh->build(model.getVertices(), model.getIndices());
+	screen1Bvh = bvh;
+	screen1BvhRevision = revision;
+	ofLogNotice("Screen3App") << "Model BVH built in " << (ofGetElapsedTimeMicros() - startTime) / 1000.0f << " ms";
+}
+
+//--------------------------------------------------------------
+void Screen3App::updateSdfVolume() {
+	unsigned int revision = dataManager.getScreen1ModelRevision();
+
+	if (sdfStarted && revision == sdfRevision) {
+		if (!sdfBaker.isBaking()) return;
+
+		// Spread the bake over frames instead of stalling one
+		uint64_t startTime = ofGetElapsedTimeMicros();
+		sdfBaker.bakeStep(kSdfSlicesPerFrame);
+		sdfBakeMs += (ofGetElapsedTimeMicros() - startTime) / 1000.0f;
+
+		if (sdfBaker.isComplete()) {
+			string cacheDir = ofToDataPath("cache", true);
+			string cachePath = ofFilePath::join(cacheDir, "sdf_" + ofToHex(sdfKey) + ".bin");
+			ofDirectory::createDirectory(cacheDir, false, true);
+			if (!SDFBaker::saveCache(cachePath, sdfKey, sdfBaker.getVolume())) {
+				ofLogWarning("Screen3App") << "Could not write SDF cache: " << cachePath;
+			}
+
+			sdfUploadPending = true;
+			ofLogNotice("Screen3App") << "SDF volume baked in " << sdfBakeMs << " ms (" << kSdfResolution << "^3)";
+		}
+		return;
 	}
+
+	// New model: restart from the cache or from scratch
+	sdfStarted = true;
+	sdfRevision = revision;
+	sdfBakeMs = 0.0f;
+	hasSdfTexture = false;
+	sdfUploadPending = false;
+
+	ofMesh model = dataManager.getScreen1Mesh();
+	sdfKey = SDFBaker::computeKey(model.getVertices(), model.getIndices(), kSdfResolution);
+	string cachePath = ofFilePath::join(ofToDataPath("cache", true), "sdf_" + ofToHex(sdfKey) + ".bin");
+
+	SDFBaker::Volume volume;
+	sdfFromCache = SDFBaker::loadCache(cachePath, sdfKey, volume);
+	if (sdfFromCache) {
+		sdfBaker.setVolume(volume);
+		sdfUploadPending = true;
+		ofLogNotice("Screen3App") << "SDF volume loaded from cache: " << cachePath;
+		return;
+	}
+
+	updateScreen1Bvh(model, revision);
+
+	SDFBaker::Settings settings;
+	settings.resolution = kSdfResolution;
+	sdfBvh = screen1Bvh;
+	sdfBaker.begin(*sdfBvh, model.getNormals(), settings);
+}
+
+//--------------------------------------------------------------
+void Screen3App::uploadSdfVolume() {
+	GL_THREAD_CHECK();
+	sdfUploadPending = false;
+	const SDFBaker::Volume & volume = sdfBaker.getVolume();
+	if (volume.resolution == 0) return;
+
+	// Half floats are plenty for distances and halve the texture size; the
+	// driver converts from the float data. The baker keeps its volume, so
+	// the upload gets a copy
+	unsigned int revision = sdfRevision;
+	UploadService::get().uploadTexture3D("sdfVolume", volume.distances, volume.resolution, volume.resolution,
+		volume.resolution, GL_R16F, [this, revision](GLuint texture) {
+			if (revision != sdfRevision) {
+				// The model changed while this was uploading
+				glDeleteTextures(1, &texture);
+				return;
+			}
+			if (sdfTexture) glDeleteTextures(1, &sdfTexture);
+			sdfTexture = texture;
+			hasSdfTexture = true;
+		});
+}
+
+//--------------------------------------------------------------
+bool Screen3App::isSdfFusionActive() const {
+	return fusionMode.get() == FUSION_SDF && hasSdfTexture;
+}
+
+//--------------------------------------------------------------
+void Screen3App::renderScreenSpaceFusion() {
+	int w = std::max(1, (int)std::round(ofGetWidth() * screenSpaceScale.get()));
+	int h = std::max(1, (int)std::round(ofGetHeight() * screenSpaceScale.get()));
+	if (!screenSpaceFBO.isAllocated() || (int)screenSpaceFBO.getWidth() != w || (int)screenSpaceFBO.getHeight() != h) {
+		// Float alpha carries the fused depth for the upsample
+		ofFboSettings settings;
+		settings.width = w;
+		settings.height = h;
+		settings.internalformat = GL_RGBA32F;
+		settings.textureTarget = GL_TEXTURE_2D;
+		settings.minFilter = GL_NEAREST;
+		settings.maxFilter = GL_NEAREST;
+		screenSpaceFBO.allocate(settings);
+	}
+
+	LightingParams lighting = dataManager.getLightingParams();
+	glm::vec3 camPos = cam.getGlobalPosition();
+	glm::vec3 lightPos = camPos + glm::vec3(200.0f, 300.0f, 0.0f);
+
+	screenSpaceFBO.begin();
+	ofClear(0, 0, 0, 255);
+	ofDisableDepthTest();
+
+	screenSpaceShader.begin();
+	setPositionTargetUniforms(screenSpaceShader);
+	screenSpaceShader.setUniform2f("resolution", (float)w, (float)h);
+	screenSpaceShader.setUniform1f("time", AppClock::getElapsedTimef());
+	screenSpaceShader.setUniform3f("lightPosition", lightPos.x, lightPos.y, lightPos.z);
+	screenSpaceShader.setUniform3f("cameraPosition", camPos.x, camPos.y, camPos.z);
+	screenSpaceShader.setUniform3f("lightColor", lighting.lightColor.x, lighting.lightColor.y, lighting.lightColor.z);
+	screenSpaceShader.setUniform3f("ambientColor", lighting.ambientColor.x, lighting.ambientColor.y, lighting.ambientColor.z);
+	screenSpaceShader.setUniform1f("lightIntensity", lighting.lightIntensity);
+	screenSpaceShader.setUniform1f("shininess", lighting.specularShininess);
+	screenSpaceShader.setUniform1i("showScreen1Debug", 0);
+	screenSpaceShader.setUniform1i("showScreen2Debug", 0);
+	fullscreenQuad.draw();
+	screenSpaceShader.end();
+
+	screenSpaceFBO.end();
+}
+
+//--------------------------------------------------------------
+void Screen3App::drawScreenSpaceUpsample() {
+	ofDisableDepthTest();
+	depthUpsampleShader.begin();
+	depthUpsampleShader.setUniformTexture("lowResTex", screenSpaceFBO.getTexture(), 0);
+	depthUpsampleShader.setUniform2f("lowResolution", screenSpaceFBO.getWidth(), screenSpaceFBO.getHeight());
+	depthUpsampleShader.setUniform1f("depthSharpness", 2000.0f);
+	setPositionTargetUniforms(depthUpsampleShader);
+	fullscreenQuad.draw();
+	depthUpsampleShader.end();
+}
+
+//--------------------------------------------------------------
+void Screen3App::setPositionTargetUniforms(ofShader & shader) {
+	// Texture units 1-3 for Screen1, 4-6 for Screen2; 0 is left to the caller
+	bool hasScreen1 = dataManager.hasScreen1PositionData();
+	bool hasScreen2 = dataManager.hasScreen2PositionData();
+	PositionTarget targets[2] = { dataManager.getScreen1PositionTarget(), dataManager.getScreen2PositionTarget() };
+	const char * prefixes[2] = { "screen1", "screen2" };
+
+	for (int i = 0; i < 2; i++) {
+		const PositionTarget & target = targets[i];
+		string prefix = prefixes[i];
+		int unit = 1 + i * 3;
+		if (target.position.isAllocated()) shader.setUniformTexture(prefix + "PositionTex", target.position, unit);
+		if (target.normal.isAllocated()) shader.setUniformTexture(prefix + "NormalTex", target.normal, unit + 1);
+		if (target.depth.isAllocated()) shader.setUniformTexture(prefix + "DepthTex", target.depth, unit + 2);
+		shader.setUniform1i(prefix + "Encoding", target.encoding);
+		shader.setUniformMatrix4f(prefix + "InverseView", target.inverseView);
+		shader.setUniformMatrix4f(prefix + "InverseViewProjection", target.inverseViewProjection);
+	}
+
+	shader.setUniform1f("mixRatio", mixRatio.get());
+	shader.setUniform1i("enableModel", hasScreen1 ? 1 : 0);
+	shader.setUniform1i("enableGeometry", hasScreen2 ? 1 : 0);
 }
 
 //--------------------------------------------------------------
 void Screen3App::updateDrivingMesh() {
 	// Use Screen2's mesh as the driving mesh
 	if (dataManager.hasScreen2MeshData()) {
-		drivingMesh = dataManager.getScreen2BaseMesh();
+		// Screen2 republishes only when it regenerates the cube
+		unsigned int revision = dataManager.getScreen2MeshRevision();
+		if (revision != drivingMeshRevision) {
+			drivingMesh = dataManager.getScreen2BaseMesh();
+			drivingMeshRevision = revision;
+		}
 		hasDrivingMesh = true;
 
 		static bool loggedOnce = false;
@@ -115,15 +498,25 @@ void Screen3App::updateDrivingMesh() {
 void Screen3App::updateScreen1TBO() {
 	if (!dataManager.hasScreen1MeshData()) return;
 
-	ofVboMesh screen1Mesh = dataManager.getScreen1Mesh();
-
-	// Get vertices as glm::vec3 (OF's current type)
-	auto glmVertices = screen1Mesh.getVertices();
-
-	if (glmVertices.empty()) return;
-
-	// Convert to float array for OpenGL
-	vector<float> vertexData;
+	// Vertices are fetched by gl_VertexID of the driving mesh, so the LOD whose
+	// vertex count is closest to the cube's gives the most even coverage
+	bool matchLod = matchCubeLod && hasDrivingMesh;
+	int targetVertices = (int)drivingMesh.getNumVertices();
+
+	// The model is static between loads; only a new model or LOD is copied
+	// and uploaded
+	size_t vertexCount = matchLod ? dataManager.getScreen1VertexCountFor(targetVertices) : dataManager.getScreen1VertexCount();
+	if (vertexCount == 0) return;
+	uint64_t key = ((uint64_t)dataManager.getScreen1ModelRevision() << 32) | vertexCount;
+	if (key == tboSourceKey) return;
+	tboSourceKey = key;
+
+	ofMesh screen1Mesh = matchLod ? dataManager.getScreen1MeshForVertexCount(targetVertices) : dataManager.getScreen1Mesh();
+	const auto & glmVertices = screen1Mesh.getVertices();
+
+	// Convert to float array for OpenGL; uploaded by uploadScreen1TBO()
+	vector<float> & vertexData = pendingTboData;
+	vertexData.clear();
 	vertexData.reserve(glmVertices.size() * 3);
 
 	for (const auto & vertex : glmVertices) {
@@ -131,32 +524,61 @@ void Screen3App::updateScreen1TBO() {
 		vertexData.push_back(vertex.y);
 		vertexData.push_back(vertex.z);
 	}
+	tboUploadPending = true;
+}
 
-	// Upload to TBO
-	glBindBuffer(GL_TEXTURE_BUFFER, screen1PositionTBO);
-	glBufferData(GL_TEXTURE_BUFFER, vertexData.size() * sizeof(float),
-		vertexData.data(), GL_DYNAMIC_DRAW);
-
-	// Bind texture to buffer
-	glBindTexture(GL_TEXTURE_BUFFER, screen1PositionTexture);
-	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGB32F, screen1PositionTBO);
-
-	glBindBuffer(GL_TEXTURE_BUFFER, 0);
-	glBindTexture(GL_TEXTURE_BUFFER, 0);
-
-	if (!tboInitialized) {
-		ofLogNotice("Screen3App") << "TBO initialized with " << glmVertices.size() << " vertices";
-		tboInitialized = true;
-	}
+//--------------------------------------------------------------
+void Screen3App::uploadScreen1TBO() {
+	GL_THREAD_CHECK();
+	tboUploadPending = false;
+
+	// Upload to a new buffer and point the texture at it once it is on the GPU
+	size_t vertexCount = pendingTboData.size() / 3;
+	UploadService::get().uploadBuffer("screen1TBO", std::move(pendingTboData), [this, vertexCount](GLuint buffer) {
+		glBindTexture(GL_TEXTURE_BUFFER, screen1PositionTexture);
+		glTexBuffer(GL_TEXTURE_BUFFER, GL_RGB32F, buffer);
+		glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+		if (screen1PositionTBO) glDeleteBuffers(1, &screen1PositionTBO);
+		screen1PositionTBO = buffer;
+		tboVertexCount = vertexCount;
+
+		if (!tboInitialized) {
+			ofLogNotice("Screen3App") << "TBO initialized with " << tboVertexCount << " vertices";
+			tboInitialized = true;
+		}
+	});
+	pendingTboData.clear();
 }
 
 //--------------------------------------------------------------
 void Screen3App::draw() {
-	finalFBO.begin();
+	TRACE_SCOPE("Screen3", "draw");
+	GL_THREAD_CHECK();
+	// Cost depends on the pixel count only, not on either mesh
+	bool hasPositionTargets = dataManager.hasScreen1PositionData() || dataManager.hasScreen2PositionData();
+	bool screenSpace = fusionMode == FUSION_SCREEN_SPACE && enableFusion && hasPositionTargets
+		&& screenSpaceShader.isLoaded() && depthUpsampleShader.isLoaded();
+	if (screenSpace) {
+		profiler.begin("renderScreenSpaceFusion");
+		renderScreenSpaceFusion();
+		profiler.end("renderScreenSpaceFusion");
+	}
+
+	// Returned to the pool at the end of draw(), for the next screen
+	RenderTargetPool::Target target = RenderTargetPool::get().acquire(ofGetWidth(), ofGetHeight());
+	target.begin();
 	ofClear(20, 20, 20, 255);
 
-	if (enableFusion && hasDrivingMesh && tboInitialized && fusionShader.isLoaded()) {
+	if (screenSpace) {
+		profiler.begin("drawScreenSpaceUpsample");
+		drawScreenSpaceUpsample();
+		profiler.end("drawScreenSpaceUpsample");
+	} else if (fusionMode != FUSION_SCREEN_SPACE && enableFusion && hasDrivingMesh
+		&& (tboInitialized || correspondenceReady || hasSdfTexture) && fusionShader.isLoaded()) {
+		profiler.begin("renderFusion");
 		renderFusion();
+		profiler.end("renderFusion");
 	} else {
 		// Show status
 		ofSetColor(255, 100, 100);
@@ -165,16 +587,28 @@ void Screen3App::draw() {
 		status += "Driving Mesh: " + string(hasDrivingMesh ? "OK" : "MISSING") + "\n";
 		status += "TBO: " + string(tboInitialized ? "OK" : "MISSING") + "\n";
 		status += "Shader: " + string(fusionShader.isLoaded() ? "OK" : "MISSING") + "\n";
+		if (fusionMode == FUSION_SCREEN_SPACE) {
+			status += "Position Targets: " + string(hasPositionTargets ? "OK" : "MISSING") + "\n";
+		}
 		ofDrawBitmapString(status, 20, 30);
 	}
 
-	finalFBO.end();
+	target.end();
+
+	if (captureRequested) {
+		captureRequested = false;
+		ofDirectory::createDirectory("captures", true, true);
+		readback.requestSave(target.getTexture(), "captures/screen3_" + ofGetTimestampString() + ".png",
+			target.getNativeRegion());
+	}
 
 	// Draw final result
-	finalFBO.draw(0, 0);
+	target.draw(0, 0, ofGetWidth(), ofGetHeight());
 
 	if (showGui) {
-		gui.draw();
+		profiler.begin("gui.draw");
+		guiCache.draw();
+		profiler.end("gui.draw");
 	}
 
 	if (showDebugInfo) {
@@ -193,9 +627,31 @@ void Screen3App::renderFusion() {
 	glBindTexture(GL_TEXTURE_BUFFER, screen1PositionTexture);
 	fusionShader.setUniform1i("screen1PositionsTBO", 0);
 
+	// Correspondence map, indexed directly by gl_VertexID
+	bool correspondenceActive = useCorrespondence && correspondenceReady;
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_BUFFER, correspondenceTextures[0]);
+	glActiveTexture(GL_TEXTURE2);
+	glBindTexture(GL_TEXTURE_BUFFER, correspondenceTextures[1]);
+	glActiveTexture(GL_TEXTURE0);
+	fusionShader.setUniform1i("correspondencePositionsTBO", 1);
+	fusionShader.setUniform1i("correspondenceNormalsTBO", 2);
+	fusionShader.setUniform1i("useCorrespondence", correspondenceActive ? 1 : 0);
+
+	// SDF volume; falls back to the vertex paths until the bake is done
+	const SDFBaker::Volume & sdfVolume = sdfBaker.getVolume();
+	glActiveTexture(GL_TEXTURE3);
+	glBindTexture(GL_TEXTURE_3D, sdfTexture);
+	glActiveTexture(GL_TEXTURE0);
+	fusionShader.setUniform1i("modelSDF", 3);
+	fusionShader.setUniform1i("fusionMode", isSdfFusionActive() ? 1 : 0);
+	fusionShader.setUniform3f("sdfOrigin", sdfVolume.origin.x, sdfVolume.origin.y, sdfVolume.origin.z);
+	fusionShader.setUniform1f("sdfSize", std::max(sdfVolume.size, 1e-4f));
+	fusionShader.setUniform1i("sdfSteps", sdfSteps.get());
+
 	// Basic parameters
 	fusionShader.setUniform1f("mixRatio", mixRatio.get());
-	fusionShader.setUniform1f("time", ofGetElapsedTimef());
+	fusionShader.setUniform1f("time", AppClock::getElapsedTimef());
 
 	// Matrices
 	fusionShader.setUniformMatrix4f("modelViewProjectionMatrix", cam.getModelViewProjectionMatrix());
@@ -248,41 +704,80 @@ void Screen3App::renderFusion() {
 	ofNoFill();
 	ofSetLineWidth(1.5f);
 
-	drivingMesh.drawWireframe(); // Change from draw() to drawWireframe()
+	drivingMeshVbo.drawWireframe(); // Change from draw() to drawWireframe()
 
 	ofPopStyle();
 	fusionShader.end();
 
-	glBindTexture(GL_TEXTURE_BUFFER, 0);
+	glActiveTexture(GL_TEXTURE3);
+	glBindTexture(GL_TEXTURE_3D, 0);
+	for (int unit = 2; unit >= 0; unit--) {
+		glActiveTexture(GL_TEXTURE0 + unit);
+		glBindTexture(GL_TEXTURE_BUFFER, 0);
+	}
 	cam.end();
 }
 
 //--------------------------------------------------------------
 void Screen3App::renderUI() {
-	ofSetColor(255);
-	ofDrawBitmapString(getDebugInfo(), 10, 20);
+	updateHud();
+	hud.draw();
 }
 
 //--------------------------------------------------------------
-string Screen3App::getDebugInfo() {
-	string info = "=== MESH FUSION DEBUG ===\n";
-	info += "FPS: " + ofToString(ofGetFrameRate(), 0) + "\n";
+void Screen3App::updateHud() {
+	hud.begin(10, 20);
+	hud.addLine("=== MESH FUSION DEBUG ===");
+	hud.addLinef("FPS: %.0f", ofGetFrameRate());
 
 	if (hasDrivingMesh) {
-		info += "Driving Mesh (Screen2): " + ofToString(drivingMesh.getNumVertices()) + " vertices\n";
+		hud.addLinef("Driving Mesh (Screen2): %d vertices", (int)drivingMesh.getNumVertices());
 	}
 
 	if (dataManager.hasScreen1MeshData()) {
-		ofVboMesh screen1 = dataManager.getScreen1Mesh();
-		info += "Screen1 Mesh: " + ofToString(screen1.getNumVertices()) + " vertices\n";
+		hud.addLinef("Screen1 Mesh: %d vertices", (int)dataManager.getScreen1Mesh().getNumVertices());
+		hud.addLinef("Screen1 TBO: %d vertices%s", (int)tboVertexCount,
+			matchCubeLod && dataManager.hasScreen1MeshLods() ? " (LOD matched)" : "");
 	}
 
-	info += "Mix Ratio: " + ofToString(mixRatio.get() * 100, 0) + "%\n";
-	info += "\nControls:\n";
-	info += "G: Toggle GUI\n";
-	info += "D: Toggle Debug Info\n";
+	if (hasCorrespondence) {
+		hud.addLinef("Correspondence: %d targets, %.1f ms%s%s", (int)correspondenceVertexCount, correspondenceBuildMs,
+			correspondenceFromCache ? " (cached)" : "", useCorrespondence ? "" : " [off]");
+	}
 
-	return info;
+	if (fusionMode == FUSION_SCREEN_SPACE) {
+		hud.addLinef("Screen-space: %.0fx%.0f (%.0f%%), depth-aware upsample", screenSpaceFBO.getWidth(),
+			screenSpaceFBO.getHeight(), screenSpaceScale.get() * 100.0f);
+		PositionEncoding encoding = (PositionEncoding)positionEncoding.get();
+		hud.addLinef("Position targets: %s, %d B/px color + depth", PositionTargets::getName(encoding).c_str(),
+			PositionTargets::getColorBytesPerPixel(encoding));
+	}
+
+	if (fusionMode == FUSION_SDF) {
+		if (sdfBaker.isBaking()) {
+			hud.addLinef("SDF: baking %.0f%% (vertex fallback)", sdfBaker.getProgress() * 100.0f);
+		} else if (hasSdfTexture && sdfFromCache) {
+			hud.addLinef("SDF: %d^3 R16F, cached", kSdfResolution);
+		} else if (hasSdfTexture) {
+			hud.addLinef("SDF: %d^3 R16F, %.0f ms bake", kSdfResolution, sdfBakeMs);
+		}
+	}
+
+	hud.addLinef("Mix Ratio: %.0f%%", mixRatio.get() * 100);
+	if (readback.getPendingCount() > 0 || readback.getDroppedCount() > 0) {
+		hud.addLinef("Readbacks: %d pending, %d dropped", readback.getPendingCount(), readback.getDroppedCount());
+	}
+	hud.addLine("");
+	hud.addText(profiler.getReport());
+	hud.addLine("");
+	hud.addLine(guiCache.getStatus());
+	hud.addLine("Controls:");
+	hud.addLine("G: Toggle GUI");
+	hud.addLine("D: Toggle Debug Info");
+	hud.addLine("S: Save Frame");
+	hud.addLine("C: Record Pass Timings (CSV)");
+	hud.addLine("T: Trace (start / dump last 10 s)");
+	hud.end();
 }
 
 //--------------------------------------------------------------
@@ -296,15 +791,29 @@ void Screen3App::keyPressed(int key) {
 	case 'D':
 		showDebugInfo = !showDebugInfo;
 		break;
+	case 's':
+	case 'S':
+		captureFrame();
+		break;
+	case 'c':
+	case 'C':
+		profiler.toggleRecording();
+		break;
+	case 't':
+	case 'T':
+		Trace::toggle(10.0);
+		break;
 	}
 }
 
+//--------------------------------------------------------------
+void Screen3App::captureFrame() {
+	// The frame only exists in a pooled target during draw()
+	captureRequested = true;
+}
+
 //--------------------------------------------------------------
 void Screen3App::handleWindowResize(int w, int h) {
-	if (finalFBO.isAllocated()) {
-		finalFBO.clear();
-	}
-	finalFBO.allocate(w, h, GL_RGBA);
 	cam.setAspectRatio((float)w / (float)h);
 }
 
@@ -318,6 +827,21 @@ void Screen3App::cleanupTBO() {
 		glDeleteTextures(1, &screen1PositionTexture);
 		screen1PositionTexture = 0;
 	}
+	// glDelete* ignores zero names
+	glDeleteBuffers(2, correspondenceBuffers);
+	glDeleteBuffers(2, incomingCorrespondence);
+	correspondenceBuffers[0] = correspondenceBuffers[1] = 0;
+	incomingCorrespondence[0] = incomingCorrespondence[1] = 0;
+	correspondenceReady = false;
+	if (correspondenceTextures[0] != 0) {
+		glDeleteTextures(2, correspondenceTextures);
+		correspondenceTextures[0] = correspondenceTextures[1] = 0;
+	}
+	if (sdfTexture != 0) {
+		glDeleteTextures(1, &sdfTexture);
+		sdfTexture = 0;
+	}
+	hasSdfTexture = false;
 }
 
 //--------------------------------------------------------------
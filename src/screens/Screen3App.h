@@ -1,14 +1,25 @@
 #pragma once
 
 #include "DataManager.h"
+#include "core/FramePhases.h"
+#include "core/FrameProfiler.h"
+#include "core/ReadbackService.h"
+#include "geometry/FusionCorrespondence.h"
+#include "geometry/SDFBaker.h"
 #include "ofMain.h"
 #include "ofxGui.h"
+#include "utils/GuiCache.h"
+#include "utils/HudText.h"
+#include "utils/TaskSystem.h"
 
-class Screen3App : public ofBaseApp {
+class Screen3App : public ofBaseApp, public PhasedScreen {
 public:
 	Screen3App();
-	~Screen3App() { cleanupTBO(); }
+	~Screen3App();
 	void setup();
+	// Driving mesh, correspondence map, SDF bake and TBO data; no GL
+	void updateCpu(const CpuFrame & frame) override;
+	// GL phase: resize and the uploads updateCpu() left pending
 	void update();
 	void draw();
 	void keyPressed(int key);
@@ -19,40 +30,152 @@ public:
 	void mouseReleased(int x, int y, int button) { }
 	void windowResized(int w, int h) { handleWindowResize(w, h); }
 
+	// For the benchmark runner: scripted parameter changes and pass timings
+	ofParameterGroup & getParameters() { return gui.getParameter().castGroup(); }
+	FrameProfiler & getProfiler() { return profiler; }
+
+	// What the current fusion mode reads, for FrameScheduler
+	bool readsPositionTargets() const { return enableFusion && fusionMode == FUSION_SCREEN_SPACE; }
+	bool readsMeshes() const { return fusionMode != FUSION_SCREEN_SPACE; }
+
 private:
+	enum FusionMode {
+		FUSION_VERTEX = 0, // cube vertices morph towards model vertices / correspondence targets
+		FUSION_SDF = 1, // cube vertices are projected onto the model's SDF
+		FUSION_SCREEN_SPACE = 2 // per-pixel mix of the Screen1/Screen2 position targets
+	};
+
 	// Core components
 	DataManager & dataManager;
 	ofEasyCam cam;
 	ofShader fusionShader;
-	ofFbo finalFBO;
+
+	// Screen-space fusion: composed at a fraction of the window size, then
+	// upsampled with the full-resolution depth as guide
+	ofShader screenSpaceShader;
+	ofShader depthUpsampleShader;
+	ofFbo screenSpaceFBO;
+	ofMesh fullscreenQuad;
+
+	// Non-blocking frame capture
+	ReadbackService readback;
+	FrameProfiler profiler { "Screen3" };
 
 	// TBO for mesh fusion
 	GLuint screen1PositionTBO;
 	GLuint screen1PositionTexture; // The texture object for TBO
 	bool tboInitialized;
+	size_t tboVertexCount = 0;
+	vector<float> pendingTboData;
+	bool tboUploadPending = false;
+	uint64_t tboSourceKey = 0; // model revision and vertex count of the uploaded data
+
+	// Precomputed cube-vertex -> model-surface targets (positions, normals),
+	// rebuilt only when the model, the cube or the mapping mode changes. The
+	// BVH is shared, so a build in flight keeps the one it started with
+	std::shared_ptr<const MeshBVH> screen1Bvh;
+	unsigned int screen1BvhRevision = 0;
+	GLuint correspondenceBuffers[2] = { 0, 0 };
+	GLuint correspondenceTextures[2] = { 0, 0 };
+	bool hasCorrespondence = false;
+	unsigned int correspondenceRevision = 0;
+	int correspondenceGrid = 0;
+	float correspondenceCubeSize = 0.0f;
+	int correspondenceBuiltMode = -1;
+	size_t correspondenceVertexCount = 0;
+	float correspondenceBuildMs = 0.0f;
+	bool correspondenceFromCache = false;
+	// Hashing, the cache lookup and a missing map's BVH and build run as a
+	// task; its result is taken over on the first tick after it finishes
+	struct CorrespondenceBuild {
+		unsigned int revision = 0;
+		std::shared_ptr<const MeshBVH> bvh; // set if the task had to build one
+		vector<glm::vec3> positions;
+		vector<glm::vec3> normals;
+		size_t modelTriangles = 0;
+		bool fromCache = false;
+		float buildMs = 0.0f;
+	};
+	TaskSystem::Handle correspondenceTask;
+	CorrespondenceBuild correspondenceBuild;
+	vector<glm::vec3> pendingCorrespondence[2]; // positions, normals
+	bool correspondenceUploadPending = false;
+	// Set once both buffers of a build are on the GPU; until then the
+	// previous map (or the TBO path) stays in use
+	bool correspondenceReady = false;
+	unsigned int correspondenceUploadId = 0;
+	GLuint incomingCorrespondence[2] = { 0, 0 };
 
-	// Driving mesh (we'll use Screen2's mesh as driver)
-	ofVboMesh drivingMesh;
+	// Signed distance volume of the model for SDF fusion, baked a few slices
+	// per frame and uploaded as a 3D texture once complete
+	SDFBaker sdfBaker;
+	std::shared_ptr<const MeshBVH> sdfBvh; // what sdfBaker was begun with
+	GLuint sdfTexture = 0;
+	bool hasSdfTexture = false;
+	bool sdfStarted = false;
+	unsigned int sdfRevision = 0;
+	uint64_t sdfKey = 0;
+	float sdfBakeMs = 0.0f;
+	bool sdfFromCache = false;
+	bool sdfUploadPending = false;
+
+	// Driving mesh (we'll use Screen2's mesh as driver). drivingMesh is the
+	// CPU copy the CPU phase works with; drivingMeshVbo is rebuilt from it in
+	// update(), so its GL buffers are only ever created and freed there
+	ofMesh drivingMesh;
+	ofVboMesh drivingMeshVbo;
+	unsigned int drivingMeshRevision = 0;
+	unsigned int drivingMeshVboRevision = 0;
 	bool hasDrivingMesh;
 
 	// GUI controls
 	ofxPanel gui;
+	GuiCache guiCache;
+	HudText hud;
 	ofParameter<float> mixRatio;
 	ofParameter<bool> enableFusion;
 	ofParameter<bool> showDebugInfo;
+	ofParameter<bool> matchCubeLod;
+	ofParameter<bool> useCorrespondence;
+	ofParameter<int> correspondenceMode;
+	ofParameter<int> fusionMode;
+	ofParameter<int> sdfSteps;
+	ofParameter<float> screenSpaceScale;
+	ofParameter<int> positionEncoding;
 	bool showGui;
 
 	// Setup functions
 	void setupCamera();
 	void setupShader();
-	void setupFBO();
 	void setupGui();
 
 	// TBO management
 	void setupTBO();
 	void updateScreen1TBO();
+	void uploadScreen1TBO();
 	void cleanupTBO();
 
+	// Correspondence map
+	void updateCorrespondence();
+	void finishCorrespondence();
+	void uploadCorrespondence();
+	void swapInCorrespondence();
+	void updateScreen1Bvh(const ofMesh & model, unsigned int revision);
+
+	// SDF volume
+	void updateSdfVolume();
+	void uploadSdfVolume();
+	bool isSdfFusionActive() const;
+
+	// Screen-space fusion
+	void renderScreenSpaceFusion();
+	void drawScreenSpaceUpsample();
+	void setPositionTargetUniforms(ofShader & shader);
+
+	// Queues an asynchronous save of the next drawn frame to captures/
+	void captureFrame();
+	bool captureRequested = false;
+
 	// Mesh management
 	void updateDrivingMesh();
 
@@ -61,7 +184,7 @@ private:
 	void renderUI();
 
 	// Utility
-	string getDebugInfo();
+	void updateHud();
 	void handleWindowResize(int w, int h);
 	void logSystemInfo();
 };
@@ -72,3 +72,31 @@ struct LightingParams {
 	float manualLightAngle = 0.0f;
 	LightingMode lightingMode = WARM_LIGHT;
 };
+
+// Layout of the Screen1/Screen2 position targets read by the Screen3
+// screen-space fusion. Must match shaders/common/positionEncoding.glsl.
+enum PositionEncoding {
+	POSITION_WORLD_RGBA32F = 0, // world position + coverage, 16 B/px
+	POSITION_VIEW_RGBA16F = 1, // view position + coverage (8 B/px) and RG16 octahedral view normal (4 B/px)
+	POSITION_DEPTH_ONLY = 2 // no color target, world position rebuilt from depth
+};
+
+// One screen's published position target and what is needed to decode it
+struct PositionTarget {
+	PositionEncoding encoding = POSITION_WORLD_RGBA32F;
+	ofTexture position; // unallocated for POSITION_DEPTH_ONLY
+	ofTexture normal; // POSITION_VIEW_RGBA16F only
+	ofTexture depth;
+	glm::mat4 inverseView = glm::mat4(1.0f); // view -> world
+	glm::mat4 inverseViewProjection = glm::mat4(1.0f); // NDC -> world, as rendered (incl. FBO flip)
+};
+
+// Data a screen publishes through DataManager for the others; FrameScheduler
+// marks each one wanted or not from what the consumers currently read
+enum DataChannel {
+	CHANNEL_SCREEN1_MESH = 0, // model mesh + model matrix
+	CHANNEL_SCREEN1_POSITION, // Screen1 position target
+	CHANNEL_SCREEN2_MESH, // cube base mesh
+	CHANNEL_SCREEN2_POSITION, // Screen2 position target
+	CHANNEL_COUNT
+};
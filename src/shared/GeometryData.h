@@ -4,6 +4,7 @@
 struct CubeMeshConfig {
 	int gridResolution = 100;
 	float cubeSize = 200.0f;
+	bool optimizeVertexOrder = true;       // reorder for the post-transform cache and fetch locality
 
 	float noiseScale = 0.05f;              // Perlin
 	float noiseStrength = 20.0f;           // ǿ
@@ -44,3 +45,18 @@ struct FlowFieldConfig {
 
 	int centerCount = 8; // ĵ
 };
+
+// One object of a multi-object model merged into a shared vertex/index
+// buffer: its triangles are indices [indexOffset, indexOffset + indexCount)
+struct SubmeshRange {
+	string name;
+	unsigned int indexOffset = 0;
+	unsigned int indexCount = 0;
+};
+
+// Level of detail of a loaded model
+struct MeshLod {
+	ofVboMesh mesh;
+	float ratio = 1.0f; // fraction of the full-detail triangle count
+	float maxError = 0.0f; // largest quadric error accepted while simplifying
+};
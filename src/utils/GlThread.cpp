@@ -0,0 +1,38 @@
+#include "GlThread.h"
+#include "ofMain.h"
+#include <atomic>
+#include <cassert>
+#include <thread>
+
+namespace {
+std::atomic<std::thread::id> contextThread;
+thread_local int cpuPhaseDepth = 0;
+}
+
+//--------------------------------------------------------------
+void GlThread::markContextThread() {
+	contextThread = std::this_thread::get_id();
+}
+
+//--------------------------------------------------------------
+bool GlThread::isContextThread() {
+	return cpuPhaseDepth == 0 && contextThread.load() == std::this_thread::get_id();
+}
+
+//--------------------------------------------------------------
+void GlThread::check(const char * function) {
+	if (isContextThread()) return;
+	ofLogError("GlThread") << function << "() touches GL outside the GL phase"
+						   << (cpuPhaseDepth > 0 ? " (called from a CPU phase)" : "");
+	assert(false && "GL call outside the context thread");
+}
+
+//--------------------------------------------------------------
+GlThread::CpuPhase::CpuPhase() {
+	cpuPhaseDepth++;
+}
+
+//--------------------------------------------------------------
+GlThread::CpuPhase::~CpuPhase() {
+	cpuPhaseDepth--;
+}
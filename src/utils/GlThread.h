@@ -0,0 +1,28 @@
+#pragma once
+
+// Guards the split of a screen's update into a CPU phase, which runs on
+// TaskSystem workers with no GL context, and a GL phase on the context
+// thread. main() marks the context thread, and FrameScheduler wraps every
+// CPU phase in a CpuPhase scope (the main thread may run one while it helps
+// the pool). GL_THREAD_CHECK() at the top of a GL-touching function logs an
+// error, and asserts in debug builds, when it is reached from anywhere else.
+namespace GlThread {
+
+void markContextThread();
+
+// True on the context thread outside any CPU phase
+bool isContextThread();
+
+void check(const char * function);
+
+class CpuPhase {
+public:
+	CpuPhase();
+	~CpuPhase();
+	CpuPhase(const CpuPhase &) = delete;
+	CpuPhase & operator=(const CpuPhase &) = delete;
+};
+
+}
+
+#define GL_THREAD_CHECK() GlThread::check(__func__)
@@ -0,0 +1,110 @@
+#include "GuiCache.h"
+
+//--------------------------------------------------------------
+void GuiCache::setup(ofxPanel & panel, const string & name) {
+	this->panel = &panel;
+	this->name = name;
+	dirty = true;
+
+	// Group events carry the changes of every nested parameter
+	listeners.unsubscribeAll();
+	listeners.push(panel.getParameter().castGroup().parameterChangedE().newListener(this, &GuiCache::parameterChanged));
+	listeners.push(ofEvents().mouseMoved.newListener(this, &GuiCache::mouseEvent));
+	listeners.push(ofEvents().mouseDragged.newListener(this, &GuiCache::mouseEvent));
+	listeners.push(ofEvents().mousePressed.newListener(this, &GuiCache::mouseEvent));
+	listeners.push(ofEvents().mouseReleased.newListener(this, &GuiCache::mouseEvent));
+	listeners.push(ofEvents().mouseScrolled.newListener(this, &GuiCache::mouseEvent));
+
+	panelDrawCalls = countDrawCalls(panel) + 2; // the panel's load and save icons
+	ofLogNotice("GuiCache") << name << ": panel takes ~" << panelDrawCalls
+							<< " draw calls, cached frames take 1";
+}
+
+//--------------------------------------------------------------
+void GuiCache::draw() {
+	if (!panel) return;
+	frames++;
+
+	// Whole pixels, so the texture maps 1:1 onto the framebuffer
+	ofRectangle shape = panel->getShape();
+	ofRectangle area(std::floor(shape.x), std::floor(shape.y), 0, 0);
+	area.width = std::ceil(shape.getRight()) - area.x + 1;
+	area.height = std::ceil(shape.getBottom()) - area.y + 1;
+
+	if (!target.isAllocated() || (int)target.getWidth() != (int)area.width
+		|| (int)target.getHeight() != (int)area.height) {
+		target.allocate((int)area.width, (int)area.height, GL_RGBA);
+		dirty = true;
+	}
+
+	if (dirty.exchange(false)) {
+		render(area);
+		redraws++;
+	}
+
+	// The target holds premultiplied colour
+	ofPushStyle();
+	ofEnableAlphaBlending();
+	glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+	ofSetColor(255);
+	target.draw(area.x, area.y);
+	ofPopStyle();
+}
+
+//--------------------------------------------------------------
+void GuiCache::render(const ofRectangle & area) {
+	target.begin();
+	ofClear(0, 0, 0, 0);
+	ofPushStyle();
+	ofPushMatrix();
+
+	// ofxGui keeps an alpha blend mode that is already set, so this
+	// premultiplies: composited once over the frame, translucent pixels end
+	// up as if the panel had been drawn there directly
+	ofEnableAlphaBlending();
+	glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+	ofTranslate(-area.x, -area.y);
+	panel->draw();
+
+	ofPopMatrix();
+	ofPopStyle();
+	target.end();
+}
+
+//--------------------------------------------------------------
+void GuiCache::parameterChanged(ofAbstractParameter & parameter) {
+	dirty = true;
+}
+
+//--------------------------------------------------------------
+void GuiCache::mouseEvent(ofMouseEventArgs & mouse) {
+	// Hover, a click or a drag that started on the panel, and leaving it
+	bool over = panel && panel->getShape().inside(mouse.x, mouse.y);
+	if (over || mouseOver || mousePressed) dirty = true;
+
+	mouseOver = over;
+	if (mouse.type == ofMouseEventArgs::Pressed) mousePressed = over;
+	if (mouse.type == ofMouseEventArgs::Released) mousePressed = false;
+}
+
+//--------------------------------------------------------------
+string GuiCache::getStatus() const {
+	return "GUI cache: " + ofToString(redraws) + " redraws in " + ofToString(frames) + " frames, ~"
+		+ ofToString(panelDrawCalls - 1) + " draw calls saved per cached frame";
+}
+
+//--------------------------------------------------------------
+int GuiCache::countDrawCalls(ofxBaseGui & control) {
+	// Per ofxGui's render(): groups draw border, header and title; toggles
+	// background, check, cross and label; sliders background, bar and text
+	auto group = dynamic_cast<ofxGuiGroup *>(&control);
+	if (group) {
+		int count = 3;
+		for (int i = 0; i < group->getNumControls(); i++) {
+			count += countDrawCalls(*group->getControl(i));
+		}
+		return count;
+	}
+	if (dynamic_cast<ofxToggle *>(&control)) return 4;
+	return 3;
+}
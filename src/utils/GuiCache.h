@@ -0,0 +1,42 @@
+#pragma once
+#include "ofMain.h"
+#include "ofxGui.h"
+#include <atomic>
+
+// Draws an ofxPanel from an offscreen texture. ofxGui redraws every
+// control each frame (background, value bar and text per slider, about
+// three draw calls each) even though the panel rarely changes; the cache
+// renders it into the texture only after a parameter changed or the mouse
+// moved over or interacted with the panel, and otherwise composites the
+// texture with one quad.
+//
+// setup() after the panel is complete, from the app's setup() so the
+// mouse listeners attach to the app's window.
+class GuiCache {
+public:
+	void setup(ofxPanel & panel, const string & name);
+	// Replaces panel.draw()
+	void draw();
+	void invalidate() { dirty = true; }
+
+	// ofxGui draw calls per panel draw, estimated from its controls
+	int getPanelDrawCalls() const { return panelDrawCalls; }
+	string getStatus() const;
+
+private:
+	ofxPanel * panel = nullptr;
+	string name;
+	ofFbo target;
+	std::atomic<bool> dirty { true };
+	bool mouseOver = false;
+	bool mousePressed = false;
+	int panelDrawCalls = 0;
+	uint64_t frames = 0;
+	uint64_t redraws = 0;
+	ofEventListeners listeners;
+
+	void render(const ofRectangle & area);
+	void parameterChanged(ofAbstractParameter & parameter);
+	void mouseEvent(ofMouseEventArgs & mouse);
+	static int countDrawCalls(ofxBaseGui & control);
+};
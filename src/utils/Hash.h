@@ -0,0 +1,15 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// 64-bit FNV-1a, used to key on-disk caches by content.
+const uint64_t kHashSeed = 14695981039346656037ULL;
+
+inline uint64_t hashBytes(uint64_t hash, const void * data, size_t size) {
+	const unsigned char * bytes = static_cast<const unsigned char *>(data);
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
@@ -0,0 +1,164 @@
+#include "HotLog.h"
+#include "Trace.h"
+#include "ofMain.h"
+#include <chrono>
+#include <cstdarg>
+#include <thread>
+
+namespace {
+
+const size_t kCapacity = 1024; // power of two
+const size_t kMaxMessage = 240;
+
+struct Entry {
+	uint64_t timeMicros;
+	int level;
+	const char * module;
+	uint32_t suppressed;
+	char message[kMaxMessage];
+};
+
+// Bounded multi-producer ring (Vyukov): a cell's sequence says whether it
+// is free for the producer at that position or full for the consumer
+struct Cell {
+	std::atomic<size_t> sequence;
+	Entry entry;
+};
+
+Cell cells[kCapacity];
+std::atomic<size_t> writePosition { 0 };
+size_t readPosition = 0; // drain thread only
+std::atomic<uint64_t> droppedCount { 0 };
+std::atomic<bool> running { false };
+std::thread drainThread;
+
+struct CellInit {
+	CellInit() {
+		for (size_t i = 0; i < kCapacity; i++) cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+} cellInit;
+
+Cell * claim() {
+	size_t position = writePosition.load(std::memory_order_relaxed);
+	while (true) {
+		Cell & cell = cells[position & (kCapacity - 1)];
+		size_t sequence = cell.sequence.load(std::memory_order_acquire);
+		intptr_t diff = (intptr_t)sequence - (intptr_t)position;
+		if (diff == 0) {
+			if (writePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) return &cell;
+		} else if (diff < 0) {
+			return nullptr; // full
+		} else {
+			position = writePosition.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+void drain() {
+	static uint64_t reportedDropped = 0;
+	while (true) {
+		Cell & cell = cells[readPosition & (kCapacity - 1)];
+		if (cell.sequence.load(std::memory_order_acquire) != readPosition + 1) break;
+
+		// Through the module loggers, so ofSetLogLevel(module, ...) applies
+		const Entry & entry = cell.entry;
+		string line = "[" + ofToString(entry.timeMicros / 1000.0, 1) + " ms] " + entry.message;
+		if (entry.suppressed > 0) line += " (" + ofToString(entry.suppressed) + " suppressed)";
+		switch (entry.level) {
+		case OF_LOG_VERBOSE: ofLogVerbose(entry.module) << line; break;
+		case OF_LOG_NOTICE: ofLogNotice(entry.module) << line; break;
+		case OF_LOG_WARNING: ofLogWarning(entry.module) << line; break;
+		default: ofLogError(entry.module) << line; break;
+		}
+
+		cell.sequence.store(readPosition + kCapacity, std::memory_order_release);
+		readPosition++;
+	}
+
+	uint64_t dropped = droppedCount.load(std::memory_order_relaxed);
+	if (dropped != reportedDropped) {
+		ofLogWarning("HotLog") << dropped - reportedDropped << " messages dropped, ring full";
+		reportedDropped = dropped;
+	}
+}
+
+void drainLoop() {
+	Trace::setThreadName("log");
+	while (running.load(std::memory_order_acquire)) {
+		drain();
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	drain();
+}
+
+}
+
+//--------------------------------------------------------------
+HotLog::Site::Site(const char * module, float intervalSeconds)
+	: module(module)
+	, intervalMicros((uint64_t)(std::max(0.0f, intervalSeconds) * 1e6f)) {
+}
+
+//--------------------------------------------------------------
+bool HotLog::Site::allow() {
+	if (intervalMicros == 0) return true;
+
+	uint64_t now = ofGetElapsedTimeMicros();
+	uint64_t next = nextMicros.load(std::memory_order_relaxed);
+	// Losing the exchange means another thread just logged from here
+	if (now < next || !nextMicros.compare_exchange_strong(next, now + intervalMicros, std::memory_order_relaxed)) {
+		suppressed.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	return true;
+}
+
+//--------------------------------------------------------------
+void HotLog::write(int level, Site & site, const char * format, ...) {
+	Cell * cell = claim();
+	if (!cell) {
+		droppedCount.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	Entry & entry = cell->entry;
+	// No ofGetFrameNum(): it reads the main loop's current window, which
+	// workers must not touch
+	entry.timeMicros = ofGetElapsedTimeMicros();
+	entry.level = level;
+	entry.module = site.module;
+	entry.suppressed = site.suppressed.exchange(0, std::memory_order_relaxed);
+
+	va_list args;
+	va_start(args, format);
+	if (vsnprintf(entry.message, kMaxMessage, format, args) < 0) entry.message[0] = '\0';
+	va_end(args);
+
+	// Publishes the entry to the drain thread
+	size_t position = cell->sequence.load(std::memory_order_relaxed);
+	cell->sequence.store(position + 1, std::memory_order_release);
+}
+
+//--------------------------------------------------------------
+void HotLog::start() {
+	if (running.exchange(true)) return;
+	drainThread = std::thread(drainLoop);
+	// Whichever way main() returns, flush and join before the thread object
+	// is destroyed
+	static bool stopRegistered = false;
+	if (!stopRegistered) {
+		std::atexit(HotLog::stop);
+		stopRegistered = true;
+	}
+}
+
+//--------------------------------------------------------------
+void HotLog::stop() {
+	if (!running.exchange(false)) return;
+	drainThread.join();
+}
+
+//--------------------------------------------------------------
+uint64_t HotLog::getDroppedCount() {
+	return droppedCount.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Logging for code that runs every frame. A HOT_LOG_* call formats its
+// message with snprintf into a slot of a fixed, lock-free ring buffer, and
+// a background thread drains the ring into ofLog. The calling thread never
+// takes a lock or allocates; if the ring is full the message is dropped
+// and counted instead.
+//
+// Each call site has its own rate limit: at most one message per interval
+// seconds gets through (0 means every call), and the next one that does
+// reports how many were suppressed in between.
+//
+// Levels below HOT_LOG_LEVEL (0 verbose, 1 notice, 2 warning, 3 error;
+// notice by default) compile to nothing, arguments included.
+//
+//	HOT_LOG_WARNING("ReadbackService", 1.0f, "All %d slots in flight", count);
+//
+// Module and format must be string literals.
+namespace HotLog {
+
+struct Site {
+	Site(const char * module, float intervalSeconds);
+	// True if this call may log; otherwise counts it as suppressed
+	bool allow();
+
+	const char * module;
+	uint64_t intervalMicros;
+	std::atomic<uint64_t> nextMicros { 0 };
+	std::atomic<uint32_t> suppressed { 0 };
+};
+
+void write(int level, Site & site, const char * format, ...);
+
+// Starts the drain thread; messages written before it starts wait in the ring
+void start();
+// Drains what is left and stops the thread; also runs at exit
+void stop();
+// Messages lost to a full ring since start
+uint64_t getDroppedCount();
+
+}
+
+#ifndef HOT_LOG_LEVEL
+	#define HOT_LOG_LEVEL 1
+#endif
+
+#define HOT_LOG_AT(level, module, intervalSeconds, ...) \
+	do { \
+		static HotLog::Site hotLogSite(module, intervalSeconds); \
+		if (hotLogSite.allow()) HotLog::write(level, hotLogSite, __VA_ARGS__); \
+	} while (0)
+
+#if HOT_LOG_LEVEL <= 0
+	#define HOT_LOG_VERBOSE(module, intervalSeconds, ...) HOT_LOG_AT(0, module, intervalSeconds, __VA_ARGS__)
+#else
+	#define HOT_LOG_VERBOSE(module, intervalSeconds, ...) ((void)0)
+#endif
+#if HOT_LOG_LEVEL <= 1
+	#define HOT_LOG_NOTICE(module, intervalSeconds, ...) HOT_LOG_AT(1, module, intervalSeconds, __VA_ARGS__)
+#else
+	#define HOT_LOG_NOTICE(module, intervalSeconds, ...) ((void)0)
+#endif
+#if HOT_LOG_LEVEL <= 2
+	#define HOT_LOG_WARNING(module, intervalSeconds, ...) HOT_LOG_AT(2, module, intervalSeconds, __VA_ARGS__)
+#else
+	#define HOT_LOG_WARNING(module, intervalSeconds, ...) ((void)0)
+#endif
+#if HOT_LOG_LEVEL <= 3
+	#define HOT_LOG_ERROR(module, intervalSeconds, ...) HOT_LOG_AT(3, module, intervalSeconds, __VA_ARGS__)
+#else
+	#define HOT_LOG_ERROR(module, intervalSeconds, ...) ((void)0)
+#endif
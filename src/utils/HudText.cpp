@@ -0,0 +1,113 @@
+#include "HudText.h"
+#include <cstdarg>
+
+// ofBitmapFont advances 8 * 1.7 px per line on a truncated integer cursor,
+// which comes to 13 px from the second line on
+static const float kLineHeight = 13.0f;
+
+//--------------------------------------------------------------
+ofBitmapFont & HudText::getFont() {
+	// One atlas for every overlay
+	static ofBitmapFont font;
+	return font;
+}
+
+//--------------------------------------------------------------
+void HudText::begin(float x, float y) {
+	lineCount = 0;
+	linesChanged = false;
+	rebuiltLines = 0;
+	cursor = glm::vec2(x, y);
+	currentColor = ofFloatColor(1.0f);
+}
+
+//--------------------------------------------------------------
+void HudText::moveTo(float x, float y) {
+	cursor = glm::vec2(x, y);
+}
+
+//--------------------------------------------------------------
+void HudText::addLine(const char * text, size_t length) {
+	if (lineCount == lines.size()) lines.emplace_back();
+	Line & line = lines[lineCount++];
+
+	bool same = line.text.size() == length && memcmp(line.text.data(), text, length) == 0
+		&& line.position == cursor && line.color == currentColor;
+	if (!same) {
+		// assign() reuses the line's capacity
+		line.text.assign(text, length);
+		line.position = cursor;
+		line.color = currentColor;
+		rebuild(line);
+		linesChanged = true;
+		rebuiltLines++;
+	}
+
+	cursor.y += ofIsVFlipped() ? kLineHeight : -kLineHeight;
+}
+
+//--------------------------------------------------------------
+void HudText::addLinef(const char * format, ...) {
+	va_list args;
+	va_start(args, format);
+	int length = vsnprintf(formatBuffer, sizeof(formatBuffer), format, args);
+	va_end(args);
+	if (length < 0) return;
+	addLine(formatBuffer, std::min((size_t)length, sizeof(formatBuffer) - 1));
+}
+
+//--------------------------------------------------------------
+void HudText::addText(const char * text) {
+	while (*text) {
+		const char * end = strchr(text, '\n');
+		if (!end) end = text + strlen(text);
+		addLine(text, end - text);
+		text = *end ? end + 1 : end;
+	}
+}
+
+//--------------------------------------------------------------
+void HudText::rebuild(Line & line) {
+	ofMesh glyphs = getFont().getMesh(line.text, (int)line.position.x, (int)line.position.y,
+		OF_BITMAPMODE_MODEL, ofIsVFlipped());
+	line.vertices.assign(glyphs.getVertices().begin(), glyphs.getVertices().end());
+	line.texCoords.assign(glyphs.getTexCoords().begin(), glyphs.getTexCoords().end());
+}
+
+//--------------------------------------------------------------
+void HudText::end() {
+	if (lineCount != previousLineCount) linesChanged = true;
+	previousLineCount = lineCount;
+	if (!linesChanged) return;
+
+	// clear() keeps the capacity, so the batch stops allocating once it
+	// has seen its longest overlay
+	auto & vertices = batch.getVertices();
+	auto & texCoords = batch.getTexCoords();
+	auto & colors = batch.getColors();
+	vertices.clear();
+	texCoords.clear();
+	colors.clear();
+	for (size_t i = 0; i < lineCount; i++) {
+		const Line & line = lines[i];
+		vertices.insert(vertices.end(), line.vertices.begin(), line.vertices.end());
+		texCoords.insert(texCoords.end(), line.texCoords.begin(), line.texCoords.end());
+		colors.insert(colors.end(), line.vertices.size(), line.color);
+	}
+	batch.setMode(OF_PRIMITIVE_TRIANGLES);
+}
+
+//--------------------------------------------------------------
+void HudText::draw() {
+	if (batch.getNumVertices() == 0) return;
+
+	// Vertex colours tint the glyphs. The windows use OF's default GL 2.1
+	// renderer, which samples the luminance-alpha atlas as is
+	ofPushStyle();
+	ofEnableAlphaBlending();
+	ofSetColor(255);
+	getFont().getTexture().bind();
+	batch.draw();
+	getFont().getTexture().unbind();
+	ofPopStyle();
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "ofMain.h"
+
+// Debug overlay text drawn with one call per frame. Lines are laid out from
+// the bitmap font's glyph atlas, the one ofDrawBitmapString() uses, and
+// kept from frame to frame: a line's glyph quads are rebuilt only when its
+// text, position or colour changed, and the batch is re-assembled only when
+// some line did. addLinef() formats into a fixed buffer, so steady-state
+// frames build the overlay without heap allocation.
+//
+//	hud.begin(10, 20);
+//	hud.addLinef("FPS: %.0f", ofGetFrameRate());
+//	hud.addText(profiler.getReport());
+//	hud.end();
+//	hud.draw();
+class HudText {
+public:
+	// Starts the frame's lines at (x, y), in white
+	void begin(float x, float y);
+	void moveTo(float x, float y);
+	void setColor(const ofColor & color) { currentColor = color; }
+
+	void addLine(const char * text) { addLine(text, strlen(text)); }
+	void addLine(const string & text) { addLine(text.data(), text.size()); }
+	void addLine(const char * text, size_t length);
+	// printf-style; longer lines are cut at kMaxLineLength
+	void addLinef(const char * format, ...);
+	// One line per '\n'-separated part; a trailing '\n' adds no empty line
+	void addText(const char * text);
+	void addText(const string & text) { addText(text.c_str()); }
+
+	void end();
+	void draw();
+
+	// Lines whose glyphs were rebuilt by the last end()
+	int getRebuiltLineCount() const { return rebuiltLines; }
+
+	static const int kMaxLineLength = 255;
+
+private:
+	struct Line {
+		string text;
+		glm::vec2 position;
+		ofFloatColor color;
+		vector<glm::vec3> vertices;
+		vector<glm::vec2> texCoords;
+	};
+
+	vector<Line> lines;
+	size_t lineCount = 0;
+	size_t previousLineCount = 0;
+	bool linesChanged = false;
+	int rebuiltLines = 0;
+	glm::vec2 cursor;
+	ofFloatColor currentColor;
+	ofVboMesh batch;
+	char formatBuffer[kMaxLineLength + 1];
+
+	void rebuild(Line & line);
+	static ofBitmapFont & getFont();
+};
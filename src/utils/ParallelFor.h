@@ -0,0 +1,76 @@
+#pragma once
+#include "TaskSystem.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// Resolve a requested worker count: 0 means "use every hardware thread".
+inline int resolveWorkerCount(int requested) {
+	if (requested > 0) return requested;
+	unsigned int hw = std::thread::hardware_concurrency();
+	return hw > 0 ? (int)hw : 1;
+}
+
+// Split [0, count) into contiguous chunks and run fn(begin, end, chunkIndex)
+// for each chunk on the shared TaskSystem. The calling thread processes the
+// first chunk itself and helps with the rest, so a single-chunk call never
+// leaves the thread and nested calls from inside a chunk are safe. Returns
+// the number of chunks used; callers that keep per-chunk accumulators size
+// them with getChunkCount().
+inline int getChunkCount(size_t count, int workers, size_t minChunkSize) {
+	if (count == 0) return 0;
+	size_t maxChunks = std::max<size_t>(1, count / std::max<size_t>(1, minChunkSize));
+	return (int)std::min<size_t>((size_t)std::max(1, workers), maxChunks);
+}
+
+inline int parallelForChunks(size_t count, int workers, size_t minChunkSize,
+	const std::function<void(size_t, size_t, int)> & fn) {
+	int chunks = getChunkCount(count, workers, minChunkSize);
+	if (chunks <= 1) {
+		if (count > 0) fn(0, count, 0);
+		return chunks;
+	}
+
+	auto runChunk = [&fn](size_t begin, size_t end, int chunk) {
+		TRACE_SCOPE("ParallelFor", "chunk");
+		fn(begin, end, chunk);
+	};
+
+	TaskSystem::get().parallelFor(count, chunks, runChunk);
+	return chunks;
+}
+
+// Sort chunks in parallel, then merge neighbouring runs pairwise; every merge
+// round also runs its merges in parallel.
+template <typename T, typename Compare>
+void parallelSort(std::vector<T> & data, int workers, size_t minChunkSize, Compare comp) {
+	int chunks = getChunkCount(data.size(), workers, minChunkSize);
+	if (chunks <= 1) {
+		std::sort(data.begin(), data.end(), comp);
+		return;
+	}
+
+	size_t chunkSize = (data.size() + chunks - 1) / chunks;
+	parallelForChunks(chunks, chunks, 1, [&](size_t begin, size_t end, int) {
+		for (size_t c = begin; c < end; c++) {
+			size_t lo = std::min(data.size(), c * chunkSize);
+			size_t hi = std::min(data.size(), lo + chunkSize);
+			std::sort(data.begin() + lo, data.begin() + hi, comp);
+		}
+	});
+
+	for (size_t width = chunkSize; width < data.size(); width *= 2) {
+		size_t merges = (data.size() + 2 * width - 1) / (2 * width);
+		parallelForChunks(merges, workers, 1, [&](size_t begin, size_t end, int) {
+			for (size_t m = begin; m < end; m++) {
+				size_t lo = m * 2 * width;
+				size_t mid = std::min(data.size(), lo + width);
+				size_t hi = std::min(data.size(), lo + 2 * width);
+				std::inplace_merge(data.begin() + lo, data.begin() + mid, data.begin() + hi, comp);
+			}
+		});
+	}
+}
@@ -0,0 +1,71 @@
+#include "PositionTargets.h"
+#include "GlThread.h"
+
+//--------------------------------------------------------------
+void PositionTargets::allocate(ofFbo & fbo, int w, int h, PositionEncoding encoding) {
+	GL_THREAD_CHECK();
+	ofFboSettings settings;
+	settings.width = w;
+	settings.height = h;
+	settings.textureTarget = GL_TEXTURE_2D;
+	settings.useDepth = true;
+	settings.depthStencilAsTexture = true;
+
+	switch (encoding) {
+	case POSITION_WORLD_RGBA32F:
+		settings.colorFormats = { GL_RGBA32F };
+		break;
+	case POSITION_VIEW_RGBA16F:
+		// RGB16F is not guaranteed to be color-renderable, so alpha carries coverage
+		settings.colorFormats = { GL_RGBA16F, GL_RG16 };
+		break;
+	case POSITION_DEPTH_ONLY:
+		settings.numColorbuffers = 0;
+		break;
+	}
+
+	fbo.allocate(settings);
+}
+
+//--------------------------------------------------------------
+void PositionTargets::beginPass(ofFbo & fbo, PositionEncoding encoding) {
+	if (encoding == POSITION_VIEW_RGBA16F) {
+		fbo.activateAllDrawBuffers();
+	}
+}
+
+//--------------------------------------------------------------
+PositionTarget PositionTargets::describe(ofFbo & fbo, PositionEncoding encoding, const glm::mat4 & view, const glm::mat4 & projection) {
+	PositionTarget target;
+	target.encoding = encoding;
+	if (encoding != POSITION_DEPTH_ONLY) {
+		target.position = fbo.getTexture(0);
+	}
+	if (encoding == POSITION_VIEW_RGBA16F) {
+		target.normal = fbo.getTexture(1);
+	}
+	target.depth = fbo.getDepthTexture();
+	target.inverseView = glm::inverse(view);
+	target.inverseViewProjection = glm::inverse(projection * view);
+	return target;
+}
+
+//--------------------------------------------------------------
+int PositionTargets::getColorBytesPerPixel(PositionEncoding encoding) {
+	switch (encoding) {
+	case POSITION_WORLD_RGBA32F: return 16;
+	case POSITION_VIEW_RGBA16F: return 8 + 4;
+	case POSITION_DEPTH_ONLY: return 0;
+	}
+	return 0;
+}
+
+//--------------------------------------------------------------
+string PositionTargets::getName(PositionEncoding encoding) {
+	switch (encoding) {
+	case POSITION_WORLD_RGBA32F: return "world RGBA32F";
+	case POSITION_VIEW_RGBA16F: return "view RGBA16F + oct RG16";
+	case POSITION_DEPTH_ONLY: return "depth only";
+	}
+	return "unknown";
+}
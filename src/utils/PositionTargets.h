@@ -0,0 +1,24 @@
+#pragma once
+#include "ofMain.h"
+#include "shared/CommonStructs.h"
+
+// Allocation and bookkeeping for the Screen1/Screen2 position targets, so
+// both producers use the same layout for every PositionEncoding.
+namespace PositionTargets {
+
+// (Re)allocates fbo for encoding: attachment 0 = position, 1 = normal
+// (view encoding only), depth always as a GL_TEXTURE_2D texture
+void allocate(ofFbo & fbo, int w, int h, PositionEncoding encoding);
+
+// Call between fbo.begin() and drawing; enables both attachments when needed
+void beginPass(ofFbo & fbo, PositionEncoding encoding);
+
+// Snapshot of fbo for DataManager; view / projection are the matrices the
+// pass was rendered with (ofGetCurrentViewMatrix / OF_MATRIX_PROJECTION)
+PositionTarget describe(ofFbo & fbo, PositionEncoding encoding, const glm::mat4 & view, const glm::mat4 & projection);
+
+// Color bytes written (and read back by Screen3) per pixel, depth excluded
+int getColorBytesPerPixel(PositionEncoding encoding);
+string getName(PositionEncoding encoding);
+
+}
@@ -0,0 +1,286 @@
+#include "TaskSystem.h"
+#include "Trace.h"
+#include <algorithm>
+#include <string>
+
+struct TaskSystem::Handle::State {
+	Task task;
+	// Unfinished dependencies, plus one held by submit() while wiring up
+	std::atomic<int> pending { 1 };
+	std::atomic<bool> done { false };
+	bool background = false;
+	std::mutex mutex;
+	std::vector<std::shared_ptr<State>> dependents;
+};
+
+namespace {
+// The pool and worker index running on this thread, if any
+thread_local TaskSystem * currentSystem = nullptr;
+thread_local int currentWorker = -1;
+}
+
+//--------------------------------------------------------------
+bool TaskSystem::Handle::isDone() const {
+	return !state || state->done.load();
+}
+
+//--------------------------------------------------------------
+TaskSystem & TaskSystem::get() {
+	static TaskSystem instance;
+	return instance;
+}
+
+//--------------------------------------------------------------
+TaskSystem::TaskSystem(int workerCount) {
+	if (workerCount <= 0) {
+		workerCount = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+	}
+	for (int i = 0; i < workerCount; i++) {
+		workers.push_back(std::make_unique<Worker>());
+	}
+	// Start only once every deque exists, since workers steal from all of them
+	for (int i = 0; i < workerCount; i++) {
+		workers[i]->thread = std::thread(&TaskSystem::workerLoop, this, i);
+	}
+}
+
+//--------------------------------------------------------------
+TaskSystem::~TaskSystem() {
+	stopping = true;
+	wake(true);
+	for (auto & worker : workers) {
+		if (worker->thread.joinable()) worker->thread.join();
+	}
+}
+
+//--------------------------------------------------------------
+TaskSystem::Handle TaskSystem::submit(Task task, const std::vector<Handle> & dependencies) {
+	return submit(std::move(task), dependencies, false);
+}
+
+//--------------------------------------------------------------
+TaskSystem::Handle TaskSystem::submitBackground(Task task) {
+	return submit(std::move(task), {}, true);
+}
+
+//--------------------------------------------------------------
+TaskSystem::Handle TaskSystem::submit(Task task, const std::vector<Handle> & dependencies, bool background) {
+	auto state = std::make_shared<Handle::State>();
+	state->task = std::move(task);
+	state->background = background;
+
+	for (const auto & dependency : dependencies) {
+		if (!dependency.state) continue;
+		std::lock_guard<std::mutex> lock(dependency.state->mutex);
+		if (dependency.state->done) continue;
+		state->pending++;
+		dependency.state->dependents.push_back(state);
+	}
+	release(state);
+	return Handle(state);
+}
+
+//--------------------------------------------------------------
+void TaskSystem::release(const std::shared_ptr<Handle::State> & state) {
+	if (state->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		schedule(state);
+	}
+}
+
+//--------------------------------------------------------------
+int TaskSystem::getCurrentWorker() const {
+	return currentSystem == this ? currentWorker : -1;
+}
+
+//--------------------------------------------------------------
+void TaskSystem::schedule(std::shared_ptr<Handle::State> state) {
+	if (state->background) {
+		{
+			std::lock_guard<std::mutex> lock(backgroundMutex);
+			backgroundQueue.push_back(std::move(state));
+		}
+		backgroundCount++;
+		// All, since a waiter that cannot take it might get the only notification
+		wake(true);
+		return;
+	}
+
+	int index = getCurrentWorker();
+	if (index >= 0) {
+		Worker & worker = *workers[index];
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		worker.queue.push_back(std::move(state));
+	} else {
+		std::lock_guard<std::mutex> lock(sharedMutex);
+		sharedQueue.push_back(std::move(state));
+	}
+	queuedCount++;
+	wake(false);
+}
+
+//--------------------------------------------------------------
+void TaskSystem::wake(bool all) {
+	if (!all && sleepingCount.load() == 0) return;
+	// Taking the lock orders this against a sleeper's last check
+	{ std::lock_guard<std::mutex> lock(sleepMutex); }
+	if (all) {
+		wakeCondition.notify_all();
+	} else {
+		wakeCondition.notify_one();
+	}
+}
+
+//--------------------------------------------------------------
+std::shared_ptr<TaskSystem::Handle::State> TaskSystem::take() {
+	if (queuedCount.load(std::memory_order_relaxed) == 0) return nullptr;
+
+	// Own work newest first, then shared work, then steal oldest first
+	int index = getCurrentWorker();
+	if (index >= 0) {
+		Worker & worker = *workers[index];
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		if (!worker.queue.empty()) {
+			auto state = std::move(worker.queue.back());
+			worker.queue.pop_back();
+			return state;
+		}
+	}
+	{
+		std::lock_guard<std::mutex> lock(sharedMutex);
+		if (!sharedQueue.empty()) {
+			auto state = std::move(sharedQueue.front());
+			sharedQueue.pop_front();
+			return state;
+		}
+	}
+	size_t count = workers.size();
+	size_t start = index >= 0 ? index + 1 : 0;
+	for (size_t i = 0; i < count; i++) {
+		Worker & victim = *workers[(start + i) % count];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.queue.empty()) {
+			auto state = std::move(victim.queue.front());
+			victim.queue.pop_front();
+			return state;
+		}
+	}
+	return nullptr;
+}
+
+//--------------------------------------------------------------
+std::shared_ptr<TaskSystem::Handle::State> TaskSystem::takeBackground() {
+	if (backgroundCount.load(std::memory_order_relaxed) == 0) return nullptr;
+
+	std::lock_guard<std::mutex> lock(backgroundMutex);
+	if (backgroundQueue.empty()) return nullptr;
+	auto state = std::move(backgroundQueue.front());
+	backgroundQueue.pop_front();
+	return state;
+}
+
+//--------------------------------------------------------------
+bool TaskSystem::runOne(bool allowBackground) {
+	// Background jobs only once there is no frame work left
+	if (auto state = take()) {
+		queuedCount--;
+		execute(state);
+		return true;
+	}
+	if (!allowBackground) return false;
+	auto state = takeBackground();
+	if (!state) return false;
+	backgroundCount--;
+	execute(state);
+	return true;
+}
+
+//--------------------------------------------------------------
+void TaskSystem::execute(const std::shared_ptr<Handle::State> & state) {
+	state->task();
+	state->task = nullptr;
+
+	std::vector<std::shared_ptr<Handle::State>> dependents;
+	{
+		std::lock_guard<std::mutex> lock(state->mutex);
+		state->done.store(true);
+		dependents.swap(state->dependents);
+	}
+	for (const auto & dependent : dependents) {
+		release(dependent);
+	}
+	// Someone may be waiting on exactly this task
+	if (sleepingCount.load() > 0) wake(true);
+}
+
+//--------------------------------------------------------------
+void TaskSystem::workerLoop(int index) {
+	currentSystem = this;
+	currentWorker = index;
+	Trace::setThreadName("Task worker " + std::to_string(index));
+
+	while (!stopping) {
+		if (runOne(true)) continue;
+
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		sleepingCount++;
+		wakeCondition.wait(lock, [this]() { return stopping || queuedCount.load() > 0 || backgroundCount.load() > 0; });
+		sleepingCount--;
+	}
+}
+
+//--------------------------------------------------------------
+void TaskSystem::wait(const Handle & handle) {
+	// Helps with frame work only; a background job picked up here could hold
+	// the render thread for as long as the job takes
+	while (!handle.isDone()) {
+		if (runOne(false)) continue;
+
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		sleepingCount++;
+		wakeCondition.wait(lock, [this, &handle]() { return handle.isDone() || queuedCount.load() > 0; });
+		sleepingCount--;
+	}
+}
+
+//--------------------------------------------------------------
+void TaskSystem::waitAll(const std::vector<Handle> & handles) {
+	for (const auto & handle : handles) {
+		wait(handle);
+	}
+}
+
+//--------------------------------------------------------------
+void TaskSystem::parallelFor(size_t count, int chunks, const std::function<void(size_t, size_t, int)> & fn) {
+	if (count == 0) return;
+	chunks = std::max(1, std::min<int>(chunks, (int)count));
+	size_t chunkSize = (count + chunks - 1) / chunks;
+
+	std::vector<Handle> handles;
+	handles.reserve(chunks - 1);
+	// Queued in reverse so the newest-first own queue hands out chunk 1 next
+	for (int c = chunks - 1; c >= 1; c--) {
+		size_t begin = std::min(count, c * chunkSize);
+		size_t end = std::min(count, begin + chunkSize);
+		handles.push_back(submit([&fn, begin, end, c]() { fn(begin, end, c); }));
+	}
+	fn(0, std::min(count, chunkSize), 0);
+	waitAll(handles);
+}
+
+//--------------------------------------------------------------
+void TaskSystem::postToMain(Task task) {
+	std::lock_guard<std::mutex> lock(mainMutex);
+	mainQueue.push_back(std::move(task));
+}
+
+//--------------------------------------------------------------
+void TaskSystem::runMainThreadTasks() {
+	std::vector<Task> tasks;
+	{
+		std::lock_guard<std::mutex> lock(mainMutex);
+		tasks.swap(mainQueue);
+	}
+	for (auto & task : tasks) {
+		task();
+	}
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool shared by the whole app. One worker per
+// hardware thread minus one (the submitting thread helps while it waits).
+// Each worker owns a deque: it pushes and pops its own work at the back
+// (LIFO, cache-warm) and idle workers steal from the front of the others.
+// Work submitted from non-worker threads goes through a shared queue.
+//
+// - submit() schedules a task once all of its dependencies have finished,
+//   so task graphs are built by passing the handles of earlier tasks
+// - wait() never just blocks: it runs queued tasks until the awaited one is
+//   done, which makes nested waits (a task waiting on its children) safe
+// - submitBackground() is for long jobs off the frame's critical path (disk
+//   I/O, image encoding, cache builds). They have a queue of their own that
+//   only idle workers take from, so wait() never runs one on the thread
+//   that is waiting for frame work
+// - postToMain() queues GL-affine continuations; runMainThreadTasks() runs
+//   them on the main thread (FrameScheduler does so once per tick)
+class TaskSystem {
+public:
+	using Task = std::function<void()>;
+
+	class Handle {
+	public:
+		Handle() = default;
+		bool isValid() const { return state != nullptr; }
+		bool isDone() const;
+
+	private:
+		friend class TaskSystem;
+		struct State;
+		explicit Handle(std::shared_ptr<State> state)
+			: state(std::move(state)) { }
+		std::shared_ptr<State> state;
+	};
+
+	static TaskSystem & get();
+
+	explicit TaskSystem(int workerCount = 0); // 0 = hardware threads - 1
+	~TaskSystem();
+	TaskSystem(const TaskSystem &) = delete;
+	TaskSystem & operator=(const TaskSystem &) = delete;
+
+	Handle submit(Task task, const std::vector<Handle> & dependencies = {});
+	Handle submitBackground(Task task);
+	void wait(const Handle & handle);
+	void waitAll(const std::vector<Handle> & handles);
+
+	// Runs fn(begin, end, chunk) for `chunks` contiguous slices of [0, count);
+	// the calling thread takes slice 0 and then helps with the rest
+	void parallelFor(size_t count, int chunks, const std::function<void(size_t, size_t, int)> & fn);
+
+	void postToMain(Task task);
+	void runMainThreadTasks();
+
+	int getWorkerCount() const { return (int)workers.size(); }
+
+private:
+	struct Worker {
+		std::deque<std::shared_ptr<Handle::State>> queue;
+		std::mutex mutex;
+		std::thread thread;
+	};
+
+	std::vector<std::unique_ptr<Worker>> workers;
+	std::deque<std::shared_ptr<Handle::State>> sharedQueue;
+	std::mutex sharedMutex;
+	std::deque<std::shared_ptr<Handle::State>> backgroundQueue;
+	std::mutex backgroundMutex;
+
+	// Idle workers and waiters sleep here until work is queued or finishes
+	std::mutex sleepMutex;
+	std::condition_variable wakeCondition;
+	std::atomic<int> queuedCount { 0 };
+	std::atomic<int> backgroundCount { 0 };
+	std::atomic<int> sleepingCount { 0 };
+	std::atomic<bool> stopping { false };
+
+	std::vector<Task> mainQueue;
+	std::mutex mainMutex;
+
+	int getCurrentWorker() const;
+	void schedule(std::shared_ptr<Handle::State> state);
+	void release(const std::shared_ptr<Handle::State> & state);
+	Handle submit(Task task, const std::vector<Handle> & dependencies, bool background);
+	bool runOne(bool allowBackground);
+	std::shared_ptr<Handle::State> take();
+	std::shared_ptr<Handle::State> takeBackground();
+	void execute(const std::shared_ptr<Handle::State> & state);
+	void workerLoop(int index);
+	void wake(bool all);
+};
@@ -0,0 +1,179 @@
+#include "Trace.h"
+#include "ofMain.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+// 64k events (2 MB) per thread, a few seconds of dense tracing
+const uint64_t kEventsPerThread = 1 << 16;
+// Dumps skip the oldest slots, which a busy writer may be overwriting
+const uint64_t kDumpMargin = kEventsPerThread / 8;
+
+struct Event {
+	const char * category;
+	const char * name;
+	uint64_t startUs;
+	uint64_t durationUs;
+	uint32_t threadId;
+};
+
+struct ThreadBuffer {
+	std::vector<Event> events = std::vector<Event>(kEventsPerThread);
+	std::atomic<uint64_t> written { 0 };
+	uint32_t threadId = 0;
+	bool inUse = false;
+};
+
+// Buffers outlive their threads: a finished thread's events stay dumpable
+// and its buffer (and track id) is handed to the next new thread, so
+// short-lived workers (ParallelFor) neither grow memory nor the number of
+// tracks in the timeline.
+struct Registry {
+	std::mutex mutex;
+	std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+	std::map<uint32_t, std::string> threadNames;
+	uint32_t nextThreadId = 1;
+};
+
+Registry & getRegistry() {
+	static Registry * registry = new Registry(); // never destroyed; threads may trace during exit
+	return *registry;
+}
+
+struct LocalBuffer {
+	std::shared_ptr<ThreadBuffer> buffer;
+
+	~LocalBuffer() {
+		if (!buffer) return;
+		std::lock_guard<std::mutex> lock(getRegistry().mutex);
+		buffer->inUse = false;
+	}
+
+	ThreadBuffer & get() {
+		if (buffer) return *buffer;
+
+		Registry & registry = getRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		for (auto & candidate : registry.buffers) {
+			if (!candidate->inUse) {
+				buffer = candidate;
+				break;
+			}
+		}
+		if (!buffer) {
+			buffer = std::make_shared<ThreadBuffer>();
+			buffer->threadId = registry.nextThreadId++;
+			registry.buffers.push_back(buffer);
+		}
+		buffer->inUse = true;
+		return *buffer;
+	}
+};
+
+thread_local LocalBuffer localBuffer;
+
+void writeEscaped(std::ofstream & out, const char * text) {
+	for (const char * c = text; *c; c++) {
+		if (*c == '"' || *c == '\\') out << '\\';
+		out << *c;
+	}
+}
+
+}
+
+std::atomic<bool> Trace::enabledFlag { false };
+
+//--------------------------------------------------------------
+void Trace::setEnabled(bool enabled) {
+	enabledFlag.store(enabled, std::memory_order_relaxed);
+}
+
+//--------------------------------------------------------------
+uint64_t Trace::nowMicros() {
+	using namespace std::chrono;
+	return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+//--------------------------------------------------------------
+void Trace::record(const char * category, const char * name, uint64_t startUs, uint64_t endUs) {
+	ThreadBuffer & buffer = localBuffer.get();
+	// Only this thread writes the buffer, so a relaxed read of our own counter is enough
+	uint64_t index = buffer.written.load(std::memory_order_relaxed);
+	buffer.events[index % kEventsPerThread] = { category, name, startUs, endUs - startUs, buffer.threadId };
+	buffer.written.store(index + 1, std::memory_order_release);
+}
+
+//--------------------------------------------------------------
+void Trace::setThreadName(const std::string & name) {
+	uint32_t threadId = localBuffer.get().threadId;
+	std::lock_guard<std::mutex> lock(getRegistry().mutex);
+	getRegistry().threadNames[threadId] = name;
+}
+
+//--------------------------------------------------------------
+bool Trace::dump(const std::string & path, double seconds) {
+	uint64_t now = nowMicros();
+	uint64_t cutoff = now - std::min<uint64_t>(now, (uint64_t)(seconds * 1000000.0));
+
+	std::vector<Event> events;
+	std::map<uint32_t, std::string> threadNames;
+	{
+		Registry & registry = getRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		threadNames = registry.threadNames;
+		for (const auto & buffer : registry.buffers) {
+			uint64_t written = buffer->written.load(std::memory_order_acquire);
+			uint64_t count = std::min(written, kEventsPerThread - kDumpMargin);
+			for (uint64_t i = written - count; i < written; i++) {
+				const Event & event = buffer->events[i % kEventsPerThread];
+				if (event.startUs + event.durationUs >= cutoff) events.push_back(event);
+			}
+		}
+	}
+
+	std::ofstream out(path);
+	if (!out.is_open()) return false;
+
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	bool first = true;
+	for (const auto & entry : threadNames) {
+		out << (first ? "" : ",\n") << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << entry.first
+			<< ",\"args\":{\"name\":\"";
+		writeEscaped(out, entry.second.c_str());
+		out << "\"}}";
+		first = false;
+	}
+	for (const auto & event : events) {
+		out << (first ? "" : ",\n") << "{\"ph\":\"X\",\"pid\":1,\"tid\":" << event.threadId
+			<< ",\"ts\":" << event.startUs << ",\"dur\":" << event.durationUs << ",\"cat\":\"";
+		writeEscaped(out, event.category);
+		out << "\",\"name\":\"";
+		writeEscaped(out, event.name);
+		out << "\"}";
+		first = false;
+	}
+	out << "\n]}\n";
+	return out.good();
+}
+
+//--------------------------------------------------------------
+void Trace::toggle(double seconds) {
+	if (!isEnabled()) {
+		setEnabled(true);
+		ofLogNotice("Trace") << "Recording; press again to dump the last " << seconds << " s";
+		return;
+	}
+
+	string path = ofToDataPath("trace_" + ofGetTimestampString() + ".json", true);
+	if (dump(path, seconds)) {
+		ofLogNotice("Trace") << "Wrote " << path;
+	} else {
+		ofLogError("Trace") << "Could not write " << path;
+	}
+}
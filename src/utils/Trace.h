@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Scoped CPU trace markers, dumped as Chrome trace JSON (chrome://tracing,
+// ui.perfetto.dev). Each thread writes complete events into its own ring
+// buffer, so recording an event needs no lock, only one atomic store.
+// While recording is off, a TRACE_SCOPE costs one relaxed atomic load.
+// Define TRACE_DISABLED to compile the markers out entirely.
+//
+// Category and name must be string literals (or otherwise outlive the
+// trace); only the pointers are stored.
+namespace Trace {
+
+extern std::atomic<bool> enabledFlag;
+
+inline bool isEnabled() {
+	return enabledFlag.load(std::memory_order_relaxed);
+}
+void setEnabled(bool enabled);
+
+// Microseconds on a steady clock
+uint64_t nowMicros();
+void record(const char * category, const char * name, uint64_t startUs, uint64_t endUs);
+
+// Label for the calling thread in the dump
+void setThreadName(const std::string & name);
+
+// Writes every event that ended within the last `seconds` to path
+bool dump(const std::string & path, double seconds);
+
+// Hotkey helper: starts recording, or if already recording dumps the last
+// `seconds` to data/trace_<timestamp>.json
+void toggle(double seconds);
+
+class Scope {
+public:
+	Scope(const char * category, const char * name)
+		: category(category)
+		, name(name)
+		, active(isEnabled()) {
+		if (active) start = nowMicros();
+	}
+	~Scope() {
+		if (active) record(category, name, start, nowMicros());
+	}
+	Scope(const Scope &) = delete;
+	Scope & operator=(const Scope &) = delete;
+
+private:
+	const char * category;
+	const char * name;
+	bool active;
+	uint64_t start = 0;
+};
+
+}
+
+#ifndef TRACE_DISABLED
+	#define TRACE_CONCAT_INNER(a, b) a##b
+	#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+	#define TRACE_SCOPE(category, name) Trace::Scope TRACE_CONCAT(traceScope, __LINE__)(category, name)
+#else
+	#define TRACE_SCOPE(category, name) ((void)0)
+#endif